@@ -0,0 +1,159 @@
+/**
+ * @file BitMask.h
+ * @brief Header for the BitMask class template.
+ *
+ * A fixed-width set of bits (one bit per grid square) that can be built and
+ * combined at compile time.
+ */
+
+#ifndef BITMASK_H_
+#define BITMASK_H_
+
+#include <cstdint>
+
+/**
+ * @class BitMask
+ * @brief 'Words' 64-bit words worth of bits, numbered from 0.
+ *
+ * Bit i lives in word i / 64. Grids use the row-major square index
+ * (GridPosition::toIndex) as the bit number, so a 10x10 board fits in a
+ * BitMask<2>. Everything is constexpr so masks can be put into compile-time
+ * tables.
+ */
+template <int Words> class BitMask {
+private:
+  uint64_t words[Words]; ///< The bits, lowest bit of words[0] is bit 0
+
+public:
+  static constexpr int WORDS = Words;     ///< Number of 64-bit words
+  static constexpr int BITS = Words * 64; ///< Number of bits
+
+  /**
+   * @brief Create an empty mask (all bits cleared).
+   */
+  constexpr BitMask() : words() {}
+
+  /**
+   * @brief Is bit 'index' set?
+   */
+  constexpr bool test(int index) const {
+    return (words[index >> 6] >> (index & 63)) & 1;
+  }
+
+  /**
+   * @brief Set bit 'index'.
+   */
+  constexpr void set(int index) {
+    words[index >> 6] |= uint64_t(1) << (index & 63);
+  }
+
+  /**
+   * @brief Clear bit 'index'.
+   */
+  constexpr void reset(int index) {
+    words[index >> 6] &= ~(uint64_t(1) << (index & 63));
+  }
+
+  /**
+   * @brief Read one whole 64-bit word.
+   */
+  constexpr uint64_t word(int wordIdx) const { return words[wordIdx]; }
+
+  /**
+   * @brief Overwrite one whole 64-bit word.
+   */
+  constexpr void setWord(int wordIdx, uint64_t value) {
+    words[wordIdx] = value;
+  }
+
+  /**
+   * @brief Is at least one bit set?
+   */
+  constexpr bool any() const {
+    uint64_t combined = 0;
+    for (int wordIdx = 0; wordIdx < Words; wordIdx++) {
+      combined |= words[wordIdx];
+    }
+    return combined != 0;
+  }
+
+  /**
+   * @brief Is every bit cleared?
+   */
+  constexpr bool none() const { return !any(); }
+
+  /**
+   * @brief Do the two masks share at least one set bit?
+   */
+  constexpr bool intersects(const BitMask &other) const {
+    uint64_t combined = 0;
+    for (int wordIdx = 0; wordIdx < Words; wordIdx++) {
+      combined |= words[wordIdx] & other.words[wordIdx];
+    }
+    return combined != 0;
+  }
+
+  /**
+   * @brief How many bits are set?
+   */
+  constexpr int count() const {
+    int total = 0;
+    for (int wordIdx = 0; wordIdx < Words; wordIdx++) {
+      total += __builtin_popcountll(words[wordIdx]);
+    }
+    return total;
+  }
+
+  constexpr BitMask &operator|=(const BitMask &other) {
+    for (int wordIdx = 0; wordIdx < Words; wordIdx++) {
+      words[wordIdx] |= other.words[wordIdx];
+    }
+    return *this;
+  }
+
+  constexpr BitMask &operator&=(const BitMask &other) {
+    for (int wordIdx = 0; wordIdx < Words; wordIdx++) {
+      words[wordIdx] &= other.words[wordIdx];
+    }
+    return *this;
+  }
+
+  constexpr BitMask operator|(const BitMask &other) const {
+    BitMask result = *this;
+    result |= other;
+    return result;
+  }
+
+  constexpr BitMask operator&(const BitMask &other) const {
+    BitMask result = *this;
+    result &= other;
+    return result;
+  }
+
+  /**
+   * @brief Flip every bit (including unused bits past the board's last
+   * square, so mask the result with the board before counting).
+   */
+  constexpr BitMask operator~() const {
+    BitMask result;
+    for (int wordIdx = 0; wordIdx < Words; wordIdx++) {
+      result.words[wordIdx] = ~words[wordIdx];
+    }
+    return result;
+  }
+
+  constexpr bool operator==(const BitMask &other) const {
+    for (int wordIdx = 0; wordIdx < Words; wordIdx++) {
+      if (words[wordIdx] != other.words[wordIdx]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  constexpr bool operator!=(const BitMask &other) const {
+    return !(*this == other);
+  }
+};
+
+#endif /* BITMASK_H_ */
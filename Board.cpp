@@ -9,11 +9,25 @@
 #include "Board.h"
 
 /**
- * Creates a board of a certain size.
+ * Creates a board of a certain size. The grids are built in the
+ * initializer list so their containers get the resource right away
+ * (assigning a grid later would keep the default one).
  */
-Board::Board(int rows, int columns) {
-  this->ownGrid = OwnGrid(rows, columns);
-  this->opponentGrid = OpponentGrid(rows, columns);
+Board::Board(int rows, int columns, std::pmr::memory_resource *resource)
+    : ownGrid(rows, columns, resource),
+      opponentGrid(rows, columns, resource) {}
+
+Board::Board(int rows, int columns, const std::map<int, int> &fleet,
+             std::pmr::memory_resource *resource)
+    : ownGrid(rows, columns, fleet, resource),
+      opponentGrid(rows, columns, resource) {}
+
+/**
+ * Both grids clear themselves but keep their memory.
+ */
+void Board::reset() {
+  ownGrid.reset();
+  opponentGrid.reset();
 }
 
 /**
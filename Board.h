@@ -29,8 +29,29 @@ public:
    * @brief Create a new game board.
    * @param rows Height of the board.
    * @param columns Width of the board.
+   * @param resource Where both grids get their memory (e.g. a GameArena).
    */
-  Board(int rows, int columns);
+  Board(int rows, int columns,
+        std::pmr::memory_resource *resource =
+            std::pmr::get_default_resource());
+
+  /**
+   * @brief Create a board whose own grid has its own fleet inventory.
+   * @param fleet How many ships of each length may be placed.
+   * @param resource Where both grids get their memory.
+   */
+  Board(int rows, int columns, const std::map<int, int> &fleet,
+        std::pmr::memory_resource *resource =
+            std::pmr::get_default_resource());
+
+  /**
+   * @brief Start a new game on this board: no ships, no shots, full
+   * inventory.
+   *
+   * Unlike building a new Board, this keeps the memory both grids already
+   * have, so the next game doesn't allocate anything.
+   */
+  void reset();
 
   /**
    * @brief Get height of the game area.
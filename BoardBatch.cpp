@@ -0,0 +1,716 @@
+/**
+ * @file BoardBatch.cpp
+ * @brief Implementation of the BoardBatch class.
+ *
+ * Every kernel does the same thing; the SIMD ones just do it for 2 or 4
+ * boards per step. They are compiled for their instruction set with a
+ * target attribute, so the rest of the program still runs on any x86 CPU,
+ * and bestKernel() asks the CPU at runtime which ones it can use. On other
+ * CPUs only the scalar kernel exists.
+ *
+ * For one shot at square 'cell' the own grid works like this:
+ *   bit       = 1 << cell (in the low or the high word, none if off grid)
+ *   isShip    = occupied & bit
+ *   shot     |= bit
+ *   sunk      = some ship has 'bit' and no square left outside 'shot'
+ *   impact    = isShip ? (sunk ? SUNKEN : HIT) : NONE
+ */
+
+#include "BoardBatch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BOARDBATCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/**
+ * Turns a packed target into its bit in the low or the high mask word. A
+ * shot off the grid gets no bit at all, so the kernels treat it as a miss
+ * without any special case. Shots land in random places, so this is all
+ * done without branches.
+ */
+inline void cellBits(unsigned cell, unsigned cellCount, uint64_t &low,
+                     uint64_t &high) {
+  uint64_t bit = uint64_t(cell < cellCount) << (cell & 63);
+  uint64_t highWord = uint64_t(0) - uint64_t((cell >> 6) & 1);
+  low = bit & ~highWord;
+  high = bit & highWord;
+}
+
+} // namespace
+
+BoardBatch::BoardBatch(int size, int rows, int columns) {
+  if (size < 0 || !CompactBoard::fits(rows, columns)) {
+    size = 0;
+    rows = 0;
+    columns = 0;
+  }
+  this->size = size;
+  this->rows = rows;
+  this->columns = columns;
+  this->kernel = bestKernel();
+
+  occupiedLo.assign(size, 0);
+  occupiedHi.assign(size, 0);
+  shotLo.assign(size, 0);
+  shotHi.assign(size, 0);
+  std::size_t groups = (std::size_t(size) + GROUP - 1) / GROUP;
+  shipLo.assign(groups * MAX_SHIPS * GROUP, 0);
+  shipHi.assign(groups * MAX_SHIPS * GROUP, 0);
+  shipCount.assign(size, 0);
+
+  trackerShotLo.assign(size, 0);
+  trackerShotHi.assign(size, 0);
+  trackerHitLo.assign(size, 0);
+  trackerHitHi.assign(size, 0);
+  trackerSunkLo.assign(size, 0);
+  trackerSunkHi.assign(size, 0);
+  sunkenBows.assign(std::size_t(MAX_SHIPS) * size, GridPosition());
+  sunkenSterns.assign(std::size_t(MAX_SHIPS) * size, GridPosition());
+  sunkenCount.assign(size, 0);
+
+  cells.assign(size, OFF_GRID);
+  sunkBoards.assign(size, 0);
+  sinkCount = 0;
+}
+
+int BoardBatch::getSize() const { return size; }
+
+int BoardBatch::getRows() const { return rows; }
+
+int BoardBatch::getColumns() const { return columns; }
+
+BoardBatch::Kernel BoardBatch::bestKernel() {
+  if (isSupported(AVX2)) {
+    return AVX2;
+  }
+  if (isSupported(SSE2)) {
+    return SSE2;
+  }
+  return SCALAR;
+}
+
+bool BoardBatch::isSupported(Kernel kernel) {
+#ifdef BOARDBATCH_X86
+  if (kernel == AVX2) {
+    return __builtin_cpu_supports("avx2");
+  }
+  if (kernel == SSE2) {
+    return __builtin_cpu_supports("sse2");
+  }
+#endif
+  return kernel == SCALAR;
+}
+
+const char *BoardBatch::kernelName(Kernel kernel) {
+  if (kernel == AVX2) {
+    return "avx2";
+  }
+  if (kernel == SSE2) {
+    return "sse2";
+  }
+  return "scalar";
+}
+
+BoardBatch::Kernel BoardBatch::getKernel() const { return kernel; }
+
+bool BoardBatch::setKernel(Kernel kernel) {
+  if (!isSupported(kernel)) {
+    return false;
+  }
+  this->kernel = kernel;
+  return true;
+}
+
+/**
+ * Copies the position in through CompactBoard's getters, turning each ship
+ * into a mask.
+ */
+bool BoardBatch::load(int boardIdx, const CompactBoard &board) {
+  if (boardIdx < 0 || boardIdx >= size || board.getRows() != rows ||
+      board.getColumns() != columns) {
+    return false;
+  }
+
+  occupiedLo[boardIdx] = 0;
+  occupiedHi[boardIdx] = 0;
+  shotLo[boardIdx] = 0;
+  shotHi[boardIdx] = 0;
+  trackerShotLo[boardIdx] = 0;
+  trackerShotHi[boardIdx] = 0;
+  trackerHitLo[boardIdx] = 0;
+  trackerHitHi[boardIdx] = 0;
+  trackerSunkLo[boardIdx] = 0;
+  trackerSunkHi[boardIdx] = 0;
+
+  for (int shipIdx = 0; shipIdx < MAX_SHIPS; shipIdx++) {
+    uint64_t maskLo = 0;
+    uint64_t maskHi = 0;
+    if (shipIdx < board.getShipCount()) {
+      GridArea area = board.getShip(shipIdx).occupiedCells();
+      for (GridArea::Iterator posIt = area.begin(); posIt != area.end();
+           ++posIt) {
+        int idx = (*posIt).toIndex(columns);
+        if (idx < 64) {
+          maskLo |= uint64_t(1) << idx;
+        } else {
+          maskHi |= uint64_t(1) << (idx - 64);
+        }
+      }
+    }
+    shipLo[shipSlot(shipIdx, boardIdx)] = maskLo;
+    shipHi[shipSlot(shipIdx, boardIdx)] = maskHi;
+    occupiedLo[boardIdx] |= maskLo;
+    occupiedHi[boardIdx] |= maskHi;
+  }
+  shipCount[boardIdx] = uint8_t(board.getShipCount());
+
+  for (int idx = 0; idx < rows * columns; idx++) {
+    GridPosition position = GridPosition::fromIndex(idx, columns);
+    uint64_t low = (idx < 64) ? uint64_t(1) << idx : 0;
+    uint64_t high = (idx < 64) ? 0 : uint64_t(1) << (idx - 64);
+    OpponentGrid::CellState state = board.getCellState(position);
+
+    if (board.isShotAt(position)) {
+      shotLo[boardIdx] |= low;
+      shotHi[boardIdx] |= high;
+    }
+    if (state != OpponentGrid::UNKNOWN) {
+      trackerShotLo[boardIdx] |= low;
+      trackerShotHi[boardIdx] |= high;
+    }
+    if (state == OpponentGrid::HIT || state == OpponentGrid::SUNK) {
+      trackerHitLo[boardIdx] |= low;
+      trackerHitHi[boardIdx] |= high;
+    }
+    if (state == OpponentGrid::SUNK) {
+      trackerSunkLo[boardIdx] |= low;
+      trackerSunkHi[boardIdx] |= high;
+    }
+  }
+
+  sunkenCount[boardIdx] = uint8_t(board.getSunkenShipCount());
+  for (int shipIdx = 0; shipIdx < board.getSunkenShipCount(); shipIdx++) {
+    Ship ship = board.getSunkenShip(shipIdx);
+    sunkenBows[std::size_t(shipIdx) * size + boardIdx] = ship.getBow();
+    sunkenSterns[std::size_t(shipIdx) * size + boardIdx] = ship.getStern();
+  }
+  return true;
+}
+
+bool BoardBatch::load(int boardIdx, Board &board) {
+  CompactBoard compact;
+  return compact.load(board) && load(boardIdx, compact);
+}
+
+/**
+ * Without branches as well: 'onGrid - 1' is 0 for a square on the grid and
+ * all ones (OFF_GRID) for anything else.
+ */
+uint16_t BoardBatch::toCell(const GridPosition &position) const {
+  int rowIdx = position.getRow() - 'A';
+  int colIdx = position.getColumn() - 1;
+  int onGrid = (unsigned(rowIdx) < unsigned(rows)) &
+               (unsigned(colIdx) < unsigned(columns));
+  return uint16_t((rowIdx * columns + colIdx) | (onGrid - 1));
+}
+
+void BoardBatch::packShots(Span<const Shot> shots, std::size_t count) {
+  for (std::size_t boardIdx = 0; boardIdx < count; boardIdx++) {
+    cells[boardIdx] = toCell(shots[boardIdx].getTargetPosition());
+  }
+}
+
+std::size_t BoardBatch::takeBlows(Span<const Shot> shots,
+                                  Span<Shot::Impact> impacts) {
+  std::size_t count = size;
+  count = (shots.size() < count) ? shots.size() : count;
+  packShots(shots, count);
+  return takeBlows(Span<const uint16_t>(cells.data(), count), impacts);
+}
+
+/**
+ * The SIMD kernels read and write the impacts as 32-bit numbers, so they
+ * only run if that is how the compiler stores the enum (it always is on
+ * the usual compilers).
+ */
+std::size_t BoardBatch::takeBlows(Span<const uint16_t> targets,
+                                  Span<Shot::Impact> impacts) {
+  std::size_t count = size;
+  count = (targets.size() < count) ? targets.size() : count;
+  count = (impacts.size() < count) ? impacts.size() : count;
+
+  std::size_t done = 0;
+  if (sizeof(Shot::Impact) == sizeof(int32_t)) {
+    if (kernel == AVX2) {
+      done = takeBlowsAvx2(targets.data(), impacts.data(), 0, count);
+    } else if (kernel == SSE2) {
+      done = takeBlowsSse2(targets.data(), impacts.data(), 0, count);
+    }
+  }
+  takeBlowsScalar(targets.data(), impacts.data(), done, count);
+  return count;
+}
+
+std::size_t BoardBatch::shotResults(Span<const Shot> shots,
+                                    Span<const Shot::Impact> impacts) {
+  std::size_t count = size;
+  count = (shots.size() < count) ? shots.size() : count;
+  packShots(shots, count);
+  return shotResults(Span<const uint16_t>(cells.data(), count), impacts);
+}
+
+std::size_t BoardBatch::shotResults(Span<const uint16_t> targets,
+                                    Span<const Shot::Impact> impacts) {
+  std::size_t count = size;
+  count = (targets.size() < count) ? targets.size() : count;
+  count = (impacts.size() < count) ? impacts.size() : count;
+
+  sinkCount = 0;
+  std::size_t done = 0;
+  if (sizeof(Shot::Impact) == sizeof(int32_t)) {
+    if (kernel == AVX2) {
+      done = shotResultsAvx2(targets.data(), impacts.data(), 0, count);
+    } else if (kernel == SSE2) {
+      done = shotResultsSse2(targets.data(), impacts.data(), 0, count);
+    }
+  }
+  shotResultsScalar(targets.data(), impacts.data(), done, count);
+
+  // Sinks are rare (ten per game), so finding the ship's ends stays scalar
+  for (std::size_t sinkIdx = 0; sinkIdx < sinkCount; sinkIdx++) {
+    int boardIdx = sunkBoards[sinkIdx];
+    int cell = targets[boardIdx];
+    if (cell < rows * columns) {
+      recordSunkenShip(boardIdx, cell);
+    }
+  }
+  return count;
+}
+
+std::size_t BoardBatch::takeBlowsScalar(const uint16_t *targets,
+                                        Shot::Impact *impacts,
+                                        std::size_t from, std::size_t to) {
+  unsigned cellCount = unsigned(rows * columns);
+  for (std::size_t boardIdx = from; boardIdx < to; boardIdx++) {
+    uint64_t low;
+    uint64_t high;
+    cellBits(targets[boardIdx], cellCount, low, high);
+    uint64_t newShotLo = shotLo[boardIdx] | low;
+    uint64_t newShotHi = shotHi[boardIdx] | high;
+    shotLo[boardIdx] = newShotLo;
+    shotHi[boardIdx] = newShotHi;
+
+    bool isShip = ((occupiedLo[boardIdx] & low) |
+                   (occupiedHi[boardIdx] & high)) != 0;
+    bool sunk = false;
+    for (int shipIdx = 0; isShip && shipIdx < MAX_SHIPS; shipIdx++) {
+      uint64_t maskLo = shipLo[shipSlot(shipIdx, boardIdx)];
+      uint64_t maskHi = shipHi[shipSlot(shipIdx, boardIdx)];
+      bool onShip = ((maskLo & low) | (maskHi & high)) != 0;
+      bool allHit = ((maskLo & ~newShotLo) | (maskHi & ~newShotHi)) == 0;
+      sunk = sunk || (onShip && allHit);
+    }
+    impacts[boardIdx] = isShip ? (sunk ? Shot::SUNKEN : Shot::HIT)
+                               : Shot::NONE;
+  }
+  return to;
+}
+
+std::size_t BoardBatch::shotResultsScalar(const uint16_t *targets,
+                                          const Shot::Impact *impacts,
+                                          std::size_t from, std::size_t to) {
+  unsigned cellCount = unsigned(rows * columns);
+  for (std::size_t boardIdx = from; boardIdx < to; boardIdx++) {
+    uint64_t low;
+    uint64_t high;
+    cellBits(targets[boardIdx], cellCount, low, high);
+    uint64_t hit = (impacts[boardIdx] != Shot::NONE) ? ~uint64_t(0) : 0;
+    uint64_t sunk = (impacts[boardIdx] == Shot::SUNKEN) ? ~uint64_t(0) : 0;
+
+    trackerShotLo[boardIdx] |= low;
+    trackerShotHi[boardIdx] |= high;
+    trackerHitLo[boardIdx] = (trackerHitLo[boardIdx] & ~low) | (low & hit);
+    trackerHitHi[boardIdx] = (trackerHitHi[boardIdx] & ~high) | (high & hit);
+    trackerSunkLo[boardIdx] = (trackerSunkLo[boardIdx] & ~low) | (low & sunk);
+    trackerSunkHi[boardIdx] =
+        (trackerSunkHi[boardIdx] & ~high) | (high & sunk);
+
+    // Note the board down, but only move on if it really was a sink
+    sunkBoards[sinkCount] = int(boardIdx);
+    sinkCount += sunk & 1;
+  }
+  return to;
+}
+
+#ifdef BOARDBATCH_X86
+
+namespace {
+
+/**
+ * SSE2 has no 64-bit compare, so compare the 32-bit halves and require both
+ * halves of a lane to match.
+ */
+__attribute__((target("sse2"))) inline __m128i isZero64(__m128i value) {
+  __m128i halves = _mm_cmpeq_epi32(value, _mm_setzero_si128());
+  return _mm_and_si128(halves, _mm_shuffle_epi32(halves, 0xB1));
+}
+
+/**
+ * cellBits() for 2 boards. SSE2 can't shift each lane by its own amount, so
+ * the bits are made one board at a time, but they stay in registers.
+ */
+__attribute__((target("sse2"))) inline void
+cellBitsSse2(const uint16_t *targets, unsigned cellCount, __m128i &low,
+             __m128i &high) {
+  uint64_t low0, high0, low1, high1;
+  cellBits(targets[0], cellCount, low0, high0);
+  cellBits(targets[1], cellCount, low1, high1);
+  low = _mm_set_epi64x((long long)low1, (long long)low0);
+  high = _mm_set_epi64x((long long)high1, (long long)high0);
+}
+
+/**
+ * cellBits() for 4 boards. A shift by 64 or more gives 0, so 'cell' only
+ * lands in the low word and 'cell - 64' (which wraps around for small
+ * cells) only in the high word.
+ */
+__attribute__((target("avx2"))) inline void
+cellBitsAvx2(const uint16_t *targets, __m256i cellCount, __m256i &low,
+             __m256i &high) {
+  const __m256i one = _mm256_set1_epi64x(1);
+  __m256i cell =
+      _mm256_cvtepu16_epi64(_mm_loadl_epi64((const __m128i *)targets));
+  __m256i onGrid = _mm256_cmpgt_epi64(cellCount, cell);
+  low = _mm256_and_si256(_mm256_sllv_epi64(one, cell), onGrid);
+  high = _mm256_and_si256(
+      _mm256_sllv_epi64(one, _mm256_sub_epi64(cell, _mm256_set1_epi64x(64))),
+      onGrid);
+}
+
+/**
+ * For 2 boards: set the shot's bit in 'words' where 'select' is all ones,
+ * clear it where 'select' is zero.
+ */
+__attribute__((target("sse2"))) inline void
+updateBitSse2(uint64_t *words, __m128i bit, __m128i select) {
+  __m128i old = _mm_loadu_si128((const __m128i *)words);
+  __m128i updated = _mm_or_si128(_mm_andnot_si128(bit, old),
+                                 _mm_and_si128(bit, select));
+  _mm_storeu_si128((__m128i *)words, updated);
+}
+
+/**
+ * The same for 4 boards.
+ */
+__attribute__((target("avx2"))) inline void
+updateBitAvx2(uint64_t *words, __m256i bit, __m256i select) {
+  __m256i old = _mm256_loadu_si256((const __m256i *)words);
+  __m256i updated = _mm256_or_si256(_mm256_andnot_si256(bit, old),
+                                    _mm256_and_si256(bit, select));
+  _mm256_storeu_si256((__m256i *)words, updated);
+}
+
+} // namespace
+
+__attribute__((target("sse2"))) std::size_t
+BoardBatch::takeBlowsSse2(const uint16_t *targets, Shot::Impact *impacts,
+                          std::size_t from, std::size_t to) {
+  const __m128i one = _mm_set1_epi64x(1);
+  unsigned cellCount = unsigned(rows * columns);
+  std::size_t boardIdx = from;
+  for (; boardIdx + 2 <= to; boardIdx += 2) {
+    __m128i low;
+    __m128i high;
+    cellBitsSse2(&targets[boardIdx], cellCount, low, high);
+    __m128i newShotLo = _mm_or_si128(
+        _mm_loadu_si128((const __m128i *)&shotLo[boardIdx]), low);
+    __m128i newShotHi = _mm_or_si128(
+        _mm_loadu_si128((const __m128i *)&shotHi[boardIdx]), high);
+    _mm_storeu_si128((__m128i *)&shotLo[boardIdx], newShotLo);
+    _mm_storeu_si128((__m128i *)&shotHi[boardIdx], newShotHi);
+
+    __m128i isShip = _mm_or_si128(
+        _mm_and_si128(
+            _mm_loadu_si128((const __m128i *)&occupiedLo[boardIdx]), low),
+        _mm_and_si128(
+            _mm_loadu_si128((const __m128i *)&occupiedHi[boardIdx]), high));
+
+    // Most shots miss on both boards of the pair: then no ship can sink
+    __m128i noShip = _mm_cmpeq_epi32(isShip, _mm_setzero_si128());
+    bool allMiss = _mm_movemask_epi8(noShip) == 0xFFFF;
+    __m128i sunk = _mm_setzero_si128();
+    for (int shipIdx = 0; !allMiss && shipIdx < MAX_SHIPS; shipIdx++) {
+      std::size_t slot = shipSlot(shipIdx, boardIdx);
+      __m128i maskLo = _mm_loadu_si128((const __m128i *)&shipLo[slot]);
+      __m128i maskHi = _mm_loadu_si128((const __m128i *)&shipHi[slot]);
+      __m128i onShip = _mm_or_si128(_mm_and_si128(maskLo, low),
+                                    _mm_and_si128(maskHi, high));
+      __m128i untouched = _mm_or_si128(_mm_andnot_si128(newShotLo, maskLo),
+                                       _mm_andnot_si128(newShotHi, maskHi));
+      sunk = _mm_or_si128(
+          sunk, _mm_andnot_si128(isZero64(onShip), isZero64(untouched)));
+    }
+
+    // NONE = 0, HIT = 1, SUNKEN = 2, moved into the two low 32-bit lanes
+    __m128i shipBit = _mm_andnot_si128(isZero64(isShip), one);
+    __m128i impact = _mm_add_epi64(shipBit, _mm_and_si128(sunk, one));
+    _mm_storel_epi64((__m128i *)&impacts[boardIdx],
+                     _mm_shuffle_epi32(impact, 0x08));
+  }
+  return boardIdx;
+}
+
+__attribute__((target("sse2"))) std::size_t
+BoardBatch::shotResultsSse2(const uint16_t *targets,
+                            const Shot::Impact *impacts, std::size_t from,
+                            std::size_t to) {
+  const __m128i ones = _mm_set1_epi64x(-1);
+  const __m128i sunken = _mm_set1_epi32(Shot::SUNKEN);
+  unsigned cellCount = unsigned(rows * columns);
+  std::size_t boardIdx = from;
+  for (; boardIdx + 2 <= to; boardIdx += 2) {
+    __m128i low;
+    __m128i high;
+    cellBitsSse2(&targets[boardIdx], cellCount, low, high);
+
+    // Both impacts, each copied into both halves of its 64-bit lane
+    __m128i impact = _mm_shuffle_epi32(
+        _mm_loadl_epi64((const __m128i *)&impacts[boardIdx]), 0x50);
+    __m128i hit = _mm_xor_si128(
+        _mm_cmpeq_epi32(impact, _mm_setzero_si128()), ones);
+    __m128i sunk = _mm_cmpeq_epi32(impact, sunken);
+
+    updateBitSse2(&trackerShotLo[boardIdx], low, ones);
+    updateBitSse2(&trackerShotHi[boardIdx], high, ones);
+    updateBitSse2(&trackerHitLo[boardIdx], low, hit);
+    updateBitSse2(&trackerHitHi[boardIdx], high, hit);
+    updateBitSse2(&trackerSunkLo[boardIdx], low, sunk);
+    updateBitSse2(&trackerSunkHi[boardIdx], high, sunk);
+
+    int sunkLanes = _mm_movemask_pd(_mm_castsi128_pd(sunk));
+    sunkBoards[sinkCount] = int(boardIdx);
+    sinkCount += sunkLanes & 1;
+    sunkBoards[sinkCount] = int(boardIdx + 1);
+    sinkCount += (sunkLanes >> 1) & 1;
+  }
+  return boardIdx;
+}
+
+__attribute__((target("avx2"))) std::size_t
+BoardBatch::takeBlowsAvx2(const uint16_t *targets, Shot::Impact *impacts,
+                          std::size_t from, std::size_t to) {
+  const __m256i one = _mm256_set1_epi64x(1);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i evenLanes = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+  const __m256i cellCount = _mm256_set1_epi64x(rows * columns);
+  std::size_t boardIdx = from;
+  for (; boardIdx + 4 <= to; boardIdx += 4) {
+    __m256i low;
+    __m256i high;
+    cellBitsAvx2(&targets[boardIdx], cellCount, low, high);
+    __m256i newShotLo = _mm256_or_si256(
+        _mm256_loadu_si256((const __m256i *)&shotLo[boardIdx]), low);
+    __m256i newShotHi = _mm256_or_si256(
+        _mm256_loadu_si256((const __m256i *)&shotHi[boardIdx]), high);
+    _mm256_storeu_si256((__m256i *)&shotLo[boardIdx], newShotLo);
+    _mm256_storeu_si256((__m256i *)&shotHi[boardIdx], newShotHi);
+
+    __m256i isShip = _mm256_or_si256(
+        _mm256_and_si256(
+            _mm256_loadu_si256((const __m256i *)&occupiedLo[boardIdx]), low),
+        _mm256_and_si256(
+            _mm256_loadu_si256((const __m256i *)&occupiedHi[boardIdx]), high));
+
+    // Most shots miss on all 4 boards: then no ship can sink
+    bool allMiss = _mm256_testz_si256(isShip, isShip);
+    __m256i sunk = zero;
+    for (int shipIdx = 0; !allMiss && shipIdx < MAX_SHIPS; shipIdx++) {
+      std::size_t slot = shipSlot(shipIdx, boardIdx);
+      __m256i maskLo = _mm256_loadu_si256((const __m256i *)&shipLo[slot]);
+      __m256i maskHi = _mm256_loadu_si256((const __m256i *)&shipHi[slot]);
+      __m256i onShip = _mm256_or_si256(_mm256_and_si256(maskLo, low),
+                                       _mm256_and_si256(maskHi, high));
+      __m256i untouched =
+          _mm256_or_si256(_mm256_andnot_si256(newShotLo, maskLo),
+                          _mm256_andnot_si256(newShotHi, maskHi));
+      sunk = _mm256_or_si256(
+          sunk, _mm256_andnot_si256(_mm256_cmpeq_epi64(onShip, zero),
+                                    _mm256_cmpeq_epi64(untouched, zero)));
+    }
+
+    // NONE = 0, HIT = 1, SUNKEN = 2, packed down to four 32-bit numbers
+    __m256i shipBit =
+        _mm256_andnot_si256(_mm256_cmpeq_epi64(isShip, zero), one);
+    __m256i impact = _mm256_add_epi64(shipBit, _mm256_and_si256(sunk, one));
+    _mm_storeu_si128(
+        (__m128i *)&impacts[boardIdx],
+        _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(impact, evenLanes)));
+  }
+  return boardIdx;
+}
+
+__attribute__((target("avx2"))) std::size_t
+BoardBatch::shotResultsAvx2(const uint16_t *targets,
+                            const Shot::Impact *impacts, std::size_t from,
+                            std::size_t to) {
+  const __m256i ones = _mm256_set1_epi64x(-1);
+  const __m256i sunken = _mm256_set1_epi64x(Shot::SUNKEN);
+  const __m256i cellCount = _mm256_set1_epi64x(rows * columns);
+  std::size_t boardIdx = from;
+  for (; boardIdx + 4 <= to; boardIdx += 4) {
+    __m256i low;
+    __m256i high;
+    cellBitsAvx2(&targets[boardIdx], cellCount, low, high);
+    __m256i impact = _mm256_cvtepi32_epi64(
+        _mm_loadu_si128((const __m128i *)&impacts[boardIdx]));
+    __m256i hit = _mm256_xor_si256(
+        _mm256_cmpeq_epi64(impact, _mm256_setzero_si256()), ones);
+    __m256i sunk = _mm256_cmpeq_epi64(impact, sunken);
+
+    updateBitAvx2(&trackerShotLo[boardIdx], low, ones);
+    updateBitAvx2(&trackerShotHi[boardIdx], high, ones);
+    updateBitAvx2(&trackerHitLo[boardIdx], low, hit);
+    updateBitAvx2(&trackerHitHi[boardIdx], high, hit);
+    updateBitAvx2(&trackerSunkLo[boardIdx], low, sunk);
+    updateBitAvx2(&trackerSunkHi[boardIdx], high, sunk);
+
+    int sunkLanes = _mm256_movemask_pd(_mm256_castsi256_pd(sunk));
+    for (int lane = 0; lane < 4; lane++) {
+      sunkBoards[sinkCount] = int(boardIdx + lane);
+      sinkCount += (sunkLanes >> lane) & 1;
+    }
+  }
+  return boardIdx;
+}
+
+#else
+
+std::size_t BoardBatch::takeBlowsSse2(const uint16_t *, Shot::Impact *,
+                                      std::size_t from, std::size_t) {
+  return from;
+}
+
+std::size_t BoardBatch::shotResultsSse2(const uint16_t *,
+                                        const Shot::Impact *,
+                                        std::size_t from, std::size_t) {
+  return from;
+}
+
+std::size_t BoardBatch::takeBlowsAvx2(const uint16_t *, Shot::Impact *,
+                                      std::size_t from, std::size_t) {
+  return from;
+}
+
+std::size_t BoardBatch::shotResultsAvx2(const uint16_t *,
+                                        const Shot::Impact *,
+                                        std::size_t from, std::size_t) {
+  return from;
+}
+
+#endif
+
+bool BoardBatch::isShipSegment(int boardIdx, int rowIdx, int colIdx) const {
+  if (rowIdx < 0 || rowIdx >= rows || colIdx < 0 || colIdx >= columns) {
+    return false;
+  }
+  int cell = rowIdx * columns + colIdx;
+  uint64_t word = (cell < 64) ? trackerHitLo[boardIdx] : trackerHitHi[boardIdx];
+  return (word >> (cell & 63)) & 1;
+}
+
+/**
+ * Same search as OpponentGrid::shotResult(): left and right first, up and
+ * down only if there was nothing sideways.
+ */
+void BoardBatch::recordSunkenShip(int boardIdx, int cell) {
+  int rowIdx = cell / columns;
+  int colIdx = cell % columns;
+  int firstRow = rowIdx;
+  int lastRow = rowIdx;
+  int firstCol = colIdx;
+  int lastCol = colIdx;
+
+  while (isShipSegment(boardIdx, rowIdx, firstCol - 1)) {
+    firstCol--;
+  }
+  while (isShipSegment(boardIdx, rowIdx, lastCol + 1)) {
+    lastCol++;
+  }
+  if (firstCol == colIdx && lastCol == colIdx) {
+    while (isShipSegment(boardIdx, firstRow - 1, colIdx)) {
+      firstRow--;
+    }
+    while (isShipSegment(boardIdx, lastRow + 1, colIdx)) {
+      lastRow++;
+    }
+  }
+
+  int count = sunkenCount[boardIdx];
+  if (count < MAX_SHIPS) {
+    std::size_t slot = std::size_t(count) * size + boardIdx;
+    sunkenBows[slot] = GridPosition('A' + firstRow, firstCol + 1);
+    sunkenSterns[slot] = GridPosition('A' + lastRow, lastCol + 1);
+    sunkenCount[boardIdx] = uint8_t(count + 1);
+  }
+}
+
+bool BoardBatch::isShotAt(int boardIdx, const GridPosition &position) const {
+  int rowIdx = position.getRow() - 'A';
+  int colIdx = position.getColumn() - 1;
+  if (rowIdx < 0 || rowIdx >= rows || colIdx < 0 || colIdx >= columns) {
+    return false;
+  }
+  int cell = rowIdx * columns + colIdx;
+  uint64_t word = (cell < 64) ? shotLo[boardIdx] : shotHi[boardIdx];
+  return (word >> (cell & 63)) & 1;
+}
+
+/**
+ * A ship is still afloat while at least one of its squares hasn't been shot.
+ */
+int BoardBatch::getShipsAfloat(int boardIdx) const {
+  int afloat = 0;
+  for (int shipIdx = 0; shipIdx < shipCount[boardIdx]; shipIdx++) {
+    std::size_t slot = shipSlot(shipIdx, boardIdx);
+    if (((shipLo[slot] & ~shotLo[boardIdx]) |
+         (shipHi[slot] & ~shotHi[boardIdx])) != 0) {
+      afloat++;
+    }
+  }
+  return afloat;
+}
+
+OpponentGrid::CellState
+BoardBatch::getCellState(int boardIdx, const GridPosition &position) const {
+  int rowIdx = position.getRow() - 'A';
+  int colIdx = position.getColumn() - 1;
+  if (rowIdx < 0 || rowIdx >= rows || colIdx < 0 || colIdx >= columns) {
+    return OpponentGrid::UNKNOWN;
+  }
+
+  int cell = rowIdx * columns + colIdx;
+  bool high = cell >= 64;
+  int bit = cell & 63;
+  if (!(((high ? trackerShotHi : trackerShotLo)[boardIdx] >> bit) & 1)) {
+    return OpponentGrid::UNKNOWN;
+  }
+  if (((high ? trackerSunkHi : trackerSunkLo)[boardIdx] >> bit) & 1) {
+    return OpponentGrid::SUNK;
+  }
+  if (((high ? trackerHitHi : trackerHitLo)[boardIdx] >> bit) & 1) {
+    return OpponentGrid::HIT;
+  }
+  return OpponentGrid::MISS;
+}
+
+int BoardBatch::getSunkenShipCount(int boardIdx) const {
+  return sunkenCount[boardIdx];
+}
+
+Ship BoardBatch::getSunkenShip(int boardIdx, int index) const {
+  std::size_t slot = std::size_t(index) * size + boardIdx;
+  return Ship(sunkenBows[slot], sunkenSterns[slot]);
+}
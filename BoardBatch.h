@@ -0,0 +1,266 @@
+/**
+ * @file BoardBatch.h
+ * @brief Header for the BoardBatch class.
+ *
+ * Many small boards side by side, so one shot per board can be worked out
+ * for all of them together with SIMD instructions.
+ */
+
+#ifndef BOARDBATCH_H_
+#define BOARDBATCH_H_
+
+#include "CompactBoard.h"
+#include "Span.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class BoardBatch
+ * @brief N boards (own grid and tracker) stored "structure of arrays".
+ *
+ * A vector of Boards puts each board's data somewhere else on the heap. Here
+ * every piece of state gets its own array with one entry per board: all the
+ * occupancy masks next to each other, all the shot masks next to each other,
+ * and so on. Then "fire one shot at every board" is the same few mask
+ * operations for board 0, 1, 2, ..., which the CPU can do 4 boards at a time
+ * (AVX2) or 2 at a time (SSE2).
+ *
+ * Each ship has its own mask, so instead of counting hits per ship we check
+ * whether any of its squares is still untouched. That gives exactly the
+ * same NONE / HIT / SUNKEN answers as OwnGrid::takeBlow(), and the tracker
+ * follows OpponentGrid::shotResult().
+ *
+ * The shots can be given as Shots or already packed into square indices
+ * (row * columns + column, counted from 0, see toCell()). The packed form
+ * goes straight to the kernels; Shots are packed first.
+ *
+ * Limits (the same as CompactBoard): at most MAX_CELLS squares and
+ * MAX_SHIPS ships per board, all boards of the batch have the same size,
+ * shots off the grid miss and are not kept, and at most MAX_SHIPS sunk
+ * ships are remembered per tracker.
+ */
+class BoardBatch {
+public:
+  static constexpr int MAX_CELLS = CompactBoard::MAX_CELLS; ///< 2 mask words
+  static constexpr int MAX_SHIPS = CompactBoard::MAX_SHIPS; ///< Per board
+  static constexpr int GROUP = 4; ///< Boards per block of ship masks
+  static constexpr uint16_t OFF_GRID = 0xFFFF; ///< Packed shot off the grid
+
+  /**
+   * @brief Which instructions the shot kernels use.
+   */
+  enum Kernel {
+    SCALAR, ///< Plain C++, one board at a time (works everywhere)
+    SSE2,   ///< 2 boards per step
+    AVX2    ///< 4 boards per step
+  };
+
+private:
+  int size;      ///< Number of boards
+  int rows;      ///< Height of every board
+  int columns;   ///< Width of every board
+  Kernel kernel; ///< Kernel used by takeBlows() and shotResults()
+
+  // Every mask is split into its low word (squares 0-63) and its high word
+  // (squares 64-127). Entry [boardIdx] belongs to one board. The per-ship
+  // masks come in groups of GROUP boards (see shipSlot()), so the masks a
+  // kernel step needs sit next to each other in memory.
+  std::vector<uint64_t> occupiedLo; ///< Own grid: squares covered by ships
+  std::vector<uint64_t> occupiedHi;
+  std::vector<uint64_t> shotLo; ///< Own grid: squares the opponent shot at
+  std::vector<uint64_t> shotHi;
+  std::vector<uint64_t> shipLo; ///< Own grid: the squares of each ship
+  std::vector<uint64_t> shipHi;
+  std::vector<uint8_t> shipCount; ///< Own grid: ships on each board
+
+  std::vector<uint64_t> trackerShotLo; ///< Tracker: squares we fired at
+  std::vector<uint64_t> trackerShotHi;
+  std::vector<uint64_t> trackerHitLo; ///< Tracker: ... that were HIT or SUNK
+  std::vector<uint64_t> trackerHitHi;
+  std::vector<uint64_t> trackerSunkLo; ///< Tracker: ... where a ship sank
+  std::vector<uint64_t> trackerSunkHi;
+  std::vector<GridPosition> sunkenBows;   ///< Tracker: sunk ships' bows
+  std::vector<GridPosition> sunkenSterns; ///< Tracker: sunk ships' sterns
+  std::vector<uint8_t> sunkenCount;       ///< Tracker: sunk ships per board
+
+  // Scratch space for one round of shots
+  std::vector<uint16_t> cells; ///< Shots given as Shots, packed by toCell()
+  std::vector<int> sunkBoards; ///< Boards whose result was a sink
+  std::size_t sinkCount;       ///< How many of 'sunkBoards' are in use
+
+  /**
+   * @brief Where ship 'shipIdx' of board 'boardIdx' is in 'shipLo'/'shipHi':
+   * all ships of boards 0-3 first, then of boards 4-7, and so on.
+   */
+  std::size_t shipSlot(int shipIdx, std::size_t boardIdx) const {
+    return ((boardIdx / GROUP) * MAX_SHIPS + shipIdx) * GROUP +
+           boardIdx % GROUP;
+  }
+
+  /**
+   * @brief Pack the first 'count' shots into 'cells'.
+   */
+  void packShots(Span<const Shot> shots, std::size_t count);
+
+  /**
+   * @brief Own grid kernels: resolve the packed 'targets' of boards
+   * [from, to) into 'impacts'.
+   * @return The first board that wasn't handled (the SIMD kernels only do
+   * whole groups of 2 or 4 boards and leave the rest to the scalar one).
+   */
+  std::size_t takeBlowsScalar(const uint16_t *targets, Shot::Impact *impacts,
+                              std::size_t from, std::size_t to);
+  std::size_t takeBlowsSse2(const uint16_t *targets, Shot::Impact *impacts,
+                            std::size_t from, std::size_t to);
+  std::size_t takeBlowsAvx2(const uint16_t *targets, Shot::Impact *impacts,
+                            std::size_t from, std::size_t to);
+
+  /**
+   * @brief Tracker kernels: update the masks of boards [from, to) and add
+   * every board with a SUNKEN result to 'sunkBoards'.
+   * @return The first board that wasn't handled.
+   */
+  std::size_t shotResultsScalar(const uint16_t *targets,
+                                const Shot::Impact *impacts, std::size_t from,
+                                std::size_t to);
+  std::size_t shotResultsSse2(const uint16_t *targets,
+                              const Shot::Impact *impacts, std::size_t from,
+                              std::size_t to);
+  std::size_t shotResultsAvx2(const uint16_t *targets,
+                              const Shot::Impact *impacts, std::size_t from,
+                              std::size_t to);
+
+  /**
+   * @brief Is this square a HIT or SUNK segment on a board's tracker?
+   */
+  bool isShipSegment(int boardIdx, int rowIdx, int colIdx) const;
+
+  /**
+   * @brief Find and remember the ship that sank at 'cell' on a tracker.
+   */
+  void recordSunkenShip(int boardIdx, int cell);
+
+public:
+  /**
+   * @brief Create 'size' empty boards of rows x columns (at most MAX_CELLS
+   * squares; bigger sizes give an empty batch). Uses bestKernel().
+   */
+  BoardBatch(int size, int rows, int columns);
+
+  /**
+   * @brief Number of boards in the batch.
+   */
+  int getSize() const;
+
+  /**
+   * @brief Get height of the boards.
+   */
+  int getRows() const;
+
+  /**
+   * @brief Get width of the boards.
+   */
+  int getColumns() const;
+
+  /**
+   * @brief The fastest kernel this CPU can run.
+   */
+  static Kernel bestKernel();
+
+  /**
+   * @brief Can this CPU run the kernel?
+   */
+  static bool isSupported(Kernel kernel);
+
+  /**
+   * @brief A readable name for a kernel ("scalar", "sse2", "avx2").
+   */
+  static const char *kernelName(Kernel kernel);
+
+  /**
+   * @brief The kernel currently in use.
+   */
+  Kernel getKernel() const;
+
+  /**
+   * @brief Switch to another kernel (e.g. to compare them).
+   * @return False if this CPU can't run it; nothing changes then.
+   */
+  bool setKernel(Kernel kernel);
+
+  /**
+   * @brief Copy a position into one of the boards.
+   * @return False if the index is out of range or the sizes differ.
+   */
+  bool load(int boardIdx, const CompactBoard &board);
+
+  /**
+   * @brief Copy a Board into one of the boards.
+   * @return False if the index is out of range or the board doesn't fit.
+   */
+  bool load(int boardIdx, Board &board);
+
+  /**
+   * @brief Pack a position into the square index the kernels work with.
+   * @return row * columns + column (counted from 0), or OFF_GRID.
+   */
+  uint16_t toCell(const GridPosition &position) const;
+
+  /**
+   * @brief Fire shots[i] at the own grid of board i, for every board at
+   * once, exactly like OwnGrid::takeBlow().
+   * @return Number of boards processed (the smallest of the batch size and
+   * the two span sizes).
+   */
+  std::size_t takeBlows(Span<const Shot> shots, Span<Shot::Impact> impacts);
+
+  /**
+   * @brief The same with the shots already packed by toCell(), so nothing
+   * has to be converted per round. Any index of rows * columns or more is
+   * a shot off the grid.
+   */
+  std::size_t takeBlows(Span<const uint16_t> targets,
+                        Span<Shot::Impact> impacts);
+
+  /**
+   * @brief Record shots[i] with impacts[i] on the tracker of board i, for
+   * every board at once, exactly like OpponentGrid::shotResult().
+   * @return Number of boards processed.
+   */
+  std::size_t shotResults(Span<const Shot> shots,
+                          Span<const Shot::Impact> impacts);
+
+  /**
+   * @brief The same with the shots already packed by toCell().
+   */
+  std::size_t shotResults(Span<const uint16_t> targets,
+                          Span<const Shot::Impact> impacts);
+
+  /**
+   * @brief Has the opponent shot at this square of a board's own grid?
+   */
+  bool isShotAt(int boardIdx, const GridPosition &position) const;
+
+  /**
+   * @brief Number of ships of a board that aren't sunk yet.
+   */
+  int getShipsAfloat(int boardIdx) const;
+
+  /**
+   * @brief What does a board's tracker know about this square?
+   */
+  OpponentGrid::CellState getCellState(int boardIdx,
+                                       const GridPosition &position) const;
+
+  /**
+   * @brief Number of ships a board's tracker has seen sink.
+   */
+  int getSunkenShipCount(int boardIdx) const;
+
+  /**
+   * @brief One of those ships, in the order they sank.
+   */
+  Ship getSunkenShip(int boardIdx, int index) const;
+};
+
+#endif /* BOARDBATCH_H_ */
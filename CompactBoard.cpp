@@ -0,0 +1,310 @@
+/**
+ * @file CompactBoard.cpp
+ * @brief Implementation of the CompactBoard class.
+ *
+ * Everything here works on the bitmasks and small arrays inside the class,
+ * so none of it allocates memory (except load() and toBoard(), which talk
+ * to a normal Board).
+ */
+
+#include "CompactBoard.h"
+#include <vector>
+
+CompactBoard::CompactBoard()
+    : fleetLengths(0), rows(0), columns(0), shipCount(0), sunkenCount(0) {
+  for (int shipIdx = 0; shipIdx < MAX_SHIPS; shipIdx++) {
+    shipHits[shipIdx] = 0;
+  }
+  for (int lengthIdx = 0; lengthIdx < 4; lengthIdx++) {
+    fleetCounts[lengthIdx] = 0;
+  }
+}
+
+bool CompactBoard::fits(int rows, int columns) {
+  return rows >= 0 && columns >= 0 && rows <= 26 && columns <= 255 &&
+         rows * columns <= MAX_CELLS;
+}
+
+int CompactBoard::cellIndex(const GridPosition &position) const {
+  int rowIdx = position.getRow() - 'A';
+  int colIdx = position.getColumn() - 1;
+  if (rowIdx < 0 || rowIdx >= rows || colIdx < 0 || colIdx >= columns) {
+    return -1;
+  }
+  return rowIdx * columns + colIdx;
+}
+
+bool CompactBoard::isShipSegment(int rowIdx, int colIdx) const {
+  return rowIdx >= 0 && rowIdx < rows && colIdx >= 0 && colIdx < columns &&
+         opponentHit.test(rowIdx * columns + colIdx);
+}
+
+/**
+ * Works on a scratch copy and only overwrites this board once everything
+ * turned out to fit.
+ */
+bool CompactBoard::load(Board &board) {
+  OwnGrid &ownGrid = board.getOwnGrid();
+  OpponentGrid &opponentGrid = board.getOpponentGrid();
+  if (!fits(board.getRows(), board.getColumns()) ||
+      opponentGrid.getRows() != board.getRows() ||
+      opponentGrid.getColumns() != board.getColumns()) {
+    return false;
+  }
+
+  Span<const Ship> ships = ownGrid.getShipView();
+  Span<const Ship> sunkenShips = opponentGrid.getSunkenShipView();
+  if (ships.size() > MAX_SHIPS || sunkenShips.size() > MAX_SHIPS) {
+    return false;
+  }
+
+  CompactBoard copy;
+  copy.rows = uint8_t(board.getRows());
+  copy.columns = uint8_t(board.getColumns());
+  int cells = copy.rows * copy.columns;
+
+  // The inventory: every length in it, with the ships of that length that
+  // are placed plus the ones still left
+  const std::pmr::map<int, int> &available = ownGrid.getAvailableShips();
+  for (std::pmr::map<int, int>::const_iterator countIt = available.begin();
+       countIt != available.end(); ++countIt) {
+    if (countIt->first < 2 || countIt->first > 5 || countIt->second < 0) {
+      return false;
+    }
+    int total = countIt->second;
+    for (const Ship *shipIt = ships.begin(); shipIt != ships.end(); ++shipIt) {
+      total += (shipIt->length() == countIt->first) ? 1 : 0;
+    }
+    if (total > 255) {
+      return false;
+    }
+    copy.fleetCounts[countIt->first - 2] = uint8_t(total);
+    copy.fleetLengths |= uint8_t(1 << (countIt->first - 2));
+  }
+
+  // Own grid: the masks come straight from OwnGrid's bitboards
+  const std::pmr::vector<uint64_t> &ownOccupied = ownGrid.getOccupiedMask();
+  const std::pmr::vector<uint64_t> &ownShots = ownGrid.getShotMask();
+  for (int wordIdx = 0; wordIdx < Mask::WORDS; wordIdx++) {
+    if (wordIdx < int(ownOccupied.size())) {
+      copy.occupied.setWord(wordIdx, ownOccupied[wordIdx]);
+      copy.shotAt.setWord(wordIdx, ownShots[wordIdx]);
+    }
+  }
+
+  for (const Ship *shipIt = ships.begin();
+       shipIt != ships.end(); ++shipIt) {
+    int slot = copy.shipCount++;
+    copy.shipBows[slot] = shipIt->getBow();
+    copy.shipSterns[slot] = shipIt->getStern();
+
+    GridArea area = shipIt->occupiedCells();
+    for (GridArea::Iterator posIt = area.begin(); posIt != area.end();
+         ++posIt) {
+      int idx = copy.cellIndex(*posIt);
+      if (idx >= 0 && copy.shotAt.test(idx)) {
+        copy.shipHits[slot]++;
+      }
+    }
+  }
+
+  // Opponent grid: one bit per state
+  const std::pmr::vector<unsigned char> &states = opponentGrid.getCellStates();
+  for (int idx = 0; idx < cells; idx++) {
+    if (states[idx] != OpponentGrid::UNKNOWN) {
+      copy.opponentShot.set(idx);
+    }
+    if (states[idx] == OpponentGrid::HIT || states[idx] == OpponentGrid::SUNK) {
+      copy.opponentHit.set(idx);
+    }
+    if (states[idx] == OpponentGrid::SUNK) {
+      copy.opponentSunk.set(idx);
+    }
+  }
+
+  for (const Ship *shipIt = sunkenShips.begin();
+       shipIt != sunkenShips.end(); ++shipIt) {
+    copy.sunkenBows[copy.sunkenCount] = shipIt->getBow();
+    copy.sunkenSterns[copy.sunkenCount] = shipIt->getStern();
+    copy.sunkenCount++;
+  }
+
+  *this = copy;
+  return true;
+}
+
+/**
+ * Replays everything into a fresh Board: first the ships, then the shots.
+ *
+ * On the opponent side, misses and hits go first and every sunk ship's
+ * final shot goes last, in the order the ships went down. That way
+ * OpponentGrid finds the same sunk ships again.
+ */
+Board CompactBoard::toBoard() const {
+  std::map<int, int> fleet;
+  for (int length = 2; length <= 5; length++) {
+    if ((fleetLengths >> (length - 2)) & 1) {
+      fleet[length] = fleetCounts[length - 2];
+    }
+  }
+  Board board(rows, columns, fleet);
+  OwnGrid &ownGrid = board.getOwnGrid();
+  OpponentGrid &opponentGrid = board.getOpponentGrid();
+  int cells = rows * columns;
+
+  for (int shipIdx = 0; shipIdx < shipCount; shipIdx++) {
+    ownGrid.placeShip(getShip(shipIdx));
+  }
+  for (int idx = 0; idx < cells; idx++) {
+    GridPosition position = GridPosition::fromIndex(idx, columns);
+    if (shotAt.test(idx)) {
+      ownGrid.takeBlow(Shot(position));
+    }
+    if (opponentShot.test(idx) && !opponentSunk.test(idx)) {
+      opponentGrid.shotResult(Shot(position), opponentHit.test(idx)
+                                                  ? Shot::HIT
+                                                  : Shot::NONE);
+    }
+  }
+
+  Mask replayed;
+  for (int shipIdx = 0; shipIdx < sunkenCount; shipIdx++) {
+    GridArea area = getSunkenShip(shipIdx).occupiedCells();
+    for (GridArea::Iterator posIt = area.begin(); posIt != area.end();
+         ++posIt) {
+      int idx = cellIndex(*posIt);
+      if (idx >= 0 && opponentSunk.test(idx) && !replayed.test(idx)) {
+        opponentGrid.shotResult(Shot(*posIt), Shot::SUNKEN);
+        replayed.set(idx);
+      }
+    }
+  }
+  return board;
+}
+
+int CompactBoard::getRows() const { return rows; }
+
+int CompactBoard::getColumns() const { return columns; }
+
+int CompactBoard::getShipCount() const { return shipCount; }
+
+Ship CompactBoard::getShip(int index) const {
+  return Ship(shipBows[index], shipSterns[index]);
+}
+
+int CompactBoard::getShipsAfloat() const {
+  int afloat = 0;
+  for (int shipIdx = 0; shipIdx < shipCount; shipIdx++) {
+    if (shipHits[shipIdx] < getShip(shipIdx).length()) {
+      afloat++;
+    }
+  }
+  return afloat;
+}
+
+bool CompactBoard::isShotAt(const GridPosition &position) const {
+  int idx = cellIndex(position);
+  return idx >= 0 && shotAt.test(idx);
+}
+
+/**
+ * Same rules as OwnGrid::takeBlow(). Instead of a per-square owner table we
+ * ask the (at most MAX_SHIPS) ships which one covers the square.
+ */
+Shot::Impact CompactBoard::takeBlow(const Shot &shot) {
+  const GridPosition &target = shot.getTargetPosition();
+  int idx = cellIndex(target);
+  if (idx < 0) {
+    return Shot::NONE; // Off the grid: nothing to hit
+  }
+
+  bool firstShot = !shotAt.test(idx);
+  shotAt.set(idx);
+  if (!occupied.test(idx)) {
+    return Shot::NONE;
+  }
+
+  for (int shipIdx = 0; shipIdx < shipCount; shipIdx++) {
+    Ship ship = getShip(shipIdx);
+    if (ship.occupiedCells().contains(target)) {
+      if (firstShot) {
+        shipHits[shipIdx]++;
+      }
+      return (shipHits[shipIdx] == ship.length()) ? Shot::SUNKEN : Shot::HIT;
+    }
+  }
+  return Shot::HIT;
+}
+
+/**
+ * Same rules as OpponentGrid::shotResult(): on a sink we walk left and right
+ * (or up and down) over the hit squares to find both ends of the ship.
+ */
+bool CompactBoard::shotResult(const Shot &shot, Shot::Impact impact) {
+  const GridPosition &target = shot.getTargetPosition();
+  int idx = cellIndex(target);
+  if (idx < 0) {
+    return true;
+  }
+
+  opponentShot.set(idx);
+  if (impact == Shot::NONE) {
+    opponentHit.reset(idx);
+    opponentSunk.reset(idx);
+    return true;
+  }
+  opponentHit.set(idx);
+  if (impact != Shot::SUNKEN) {
+    opponentSunk.reset(idx);
+    return true;
+  }
+  opponentSunk.set(idx);
+  if (sunkenCount >= MAX_SHIPS) {
+    return false; // The square is marked, but the list is full
+  }
+
+  int rowIdx = idx / columns;
+  int colIdx = idx % columns;
+  int firstRow = rowIdx;
+  int lastRow = rowIdx;
+  int firstCol = colIdx;
+  int lastCol = colIdx;
+
+  while (isShipSegment(rowIdx, firstCol - 1)) {
+    firstCol--;
+  }
+  while (isShipSegment(rowIdx, lastCol + 1)) {
+    lastCol++;
+  }
+  if (firstCol == colIdx && lastCol == colIdx) {
+    while (isShipSegment(firstRow - 1, colIdx)) {
+      firstRow--;
+    }
+    while (isShipSegment(lastRow + 1, colIdx)) {
+      lastRow++;
+    }
+  }
+
+  sunkenBows[sunkenCount] = GridPosition('A' + firstRow, firstCol + 1);
+  sunkenSterns[sunkenCount] = GridPosition('A' + lastRow, lastCol + 1);
+  sunkenCount++;
+  return true;
+}
+
+OpponentGrid::CellState
+CompactBoard::getCellState(const GridPosition &position) const {
+  int idx = cellIndex(position);
+  if (idx < 0 || !opponentShot.test(idx)) {
+    return OpponentGrid::UNKNOWN;
+  }
+  if (opponentSunk.test(idx)) {
+    return OpponentGrid::SUNK;
+  }
+  return opponentHit.test(idx) ? OpponentGrid::HIT : OpponentGrid::MISS;
+}
+
+int CompactBoard::getSunkenShipCount() const { return sunkenCount; }
+
+Ship CompactBoard::getSunkenShip(int index) const {
+  return Ship(sunkenBows[index], sunkenSterns[index]);
+}
@@ -0,0 +1,161 @@
+/**
+ * @file CompactBoard.h
+ * @brief Header for the CompactBoard class.
+ *
+ * A small, flat copy of a Board that can be cloned with a plain memcpy.
+ */
+
+#ifndef COMPACTBOARD_H_
+#define COMPACTBOARD_H_
+
+#include "BitMask.h"
+#include "Board.h"
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @class CompactBoard
+ * @brief Both grids of a Board in about 180 bytes, with no pointers inside.
+ *
+ * A normal Board keeps its data in vectors, maps and sets, so every copy
+ * allocates memory many times. A CompactBoard keeps everything in fixed-size
+ * arrays and bitmasks instead, so copying one is just copying bytes. That
+ * makes it a good fit for "what if" searches that clone a position many
+ * times.
+ *
+ * The price is a fixed capacity: at most MAX_CELLS squares and MAX_SHIPS
+ * ships per side, all of them 2 to 5 squares long. Shots that land off the
+ * grid can't hit anything and are not kept.
+ */
+class CompactBoard {
+public:
+  static constexpr int MAX_CELLS = 128; ///< Largest board (e.g. 10x10, 11x11)
+  static constexpr int MAX_SHIPS = 10;  ///< Largest fleet (the standard one)
+
+  typedef BitMask<(MAX_CELLS + 63) / 64> Mask; ///< One bit per square
+
+private:
+  // Squares use the row-major index (GridPosition::toIndex).
+  Mask occupied;      ///< Own grid: squares covered by our ships
+  Mask shotAt;        ///< Own grid: squares the opponent shot at
+  Mask opponentShot;  ///< Opponent grid: squares we fired at
+  Mask opponentHit;   ///< Opponent grid: ... that were HIT or SUNK
+  Mask opponentSunk;  ///< Opponent grid: ... where a ship went down
+
+  GridPosition shipBows[MAX_SHIPS];    ///< Top/left end of each of our ships
+  GridPosition shipSterns[MAX_SHIPS];  ///< Bottom/right end of each ship
+  GridPosition sunkenBows[MAX_SHIPS];  ///< Top/left end of each sunk enemy
+  GridPosition sunkenSterns[MAX_SHIPS]; ///< Bottom/right end of each one
+  uint8_t shipHits[MAX_SHIPS]; ///< Distinct hits taken by each of our ships
+  uint8_t fleetCounts[4]; ///< Inventory per length 2-5, placed or not
+  uint8_t fleetLengths;   ///< Bit (length - 2): that length is in the fleet
+
+  uint8_t rows;         ///< Height of the grids
+  uint8_t columns;      ///< Width of the grids
+  uint8_t shipCount;    ///< Entries used in shipBows/shipSterns
+  uint8_t sunkenCount;  ///< Entries used in sunkenBows/sunkenSterns
+
+  /**
+   * @brief Turn a position into its square index, or -1 if it is off the
+   * grid.
+   */
+  int cellIndex(const GridPosition &position) const;
+
+  /**
+   * @brief Is this square of the opponent grid a HIT or SUNK ship segment?
+   */
+  bool isShipSegment(int rowIdx, int colIdx) const;
+
+public:
+  /**
+   * @brief Create an empty 0x0 board (use load() to fill it).
+   */
+  CompactBoard();
+
+  /**
+   * @brief Does a board of this size fit?
+   */
+  static bool fits(int rows, int columns);
+
+  /**
+   * @brief Copy everything from a Board, its fleet inventory included.
+   * @return False if the board is too big, has too many ships, or its
+   * inventory holds a length other than 2 to 5; this board is left
+   * unchanged in that case.
+   */
+  bool load(Board &board);
+
+  /**
+   * @brief Build a normal Board with the same inventory, ships, shots and
+   * sunk ships.
+   */
+  Board toBoard() const;
+
+  /**
+   * @brief Get height of the board.
+   */
+  int getRows() const;
+
+  /**
+   * @brief Get width of the board.
+   */
+  int getColumns() const;
+
+  /**
+   * @brief Number of our own ships.
+   */
+  int getShipCount() const;
+
+  /**
+   * @brief One of our own ships (0 <= index < getShipCount()).
+   */
+  Ship getShip(int index) const;
+
+  /**
+   * @brief Number of our own ships that aren't sunk yet.
+   */
+  int getShipsAfloat() const;
+
+  /**
+   * @brief Has the opponent shot at this square of our grid?
+   */
+  bool isShotAt(const GridPosition &position) const;
+
+  /**
+   * @brief Process a shot from the opponent, exactly like
+   * OwnGrid::takeBlow().
+   */
+  Shot::Impact takeBlow(const Shot &shot);
+
+  /**
+   * @brief Record the result of our own shot, exactly like
+   * OpponentGrid::shotResult() (shots off the grid are ignored).
+   *
+   * Only MAX_SHIPS sunk ships fit in the list. A sink after that still marks
+   * its square SUNK, but the ship isn't added to getSunkenShip().
+   * @return False if the sunk ship didn't fit in the list.
+   */
+  bool shotResult(const Shot &shot, Shot::Impact impact);
+
+  /**
+   * @brief What do we know about this square of the opponent's grid?
+   */
+  OpponentGrid::CellState getCellState(const GridPosition &position) const;
+
+  /**
+   * @brief Number of opponent ships we've sunk.
+   */
+  int getSunkenShipCount() const;
+
+  /**
+   * @brief One of the sunk opponent ships, in the order they went down.
+   */
+  Ship getSunkenShip(int index) const;
+};
+
+static_assert(std::is_trivially_copyable<CompactBoard>::value,
+              "CompactBoard must be copyable with memcpy");
+static_assert(sizeof(CompactBoard) <= 192,
+              "CompactBoard should stay small enough to clone cheaply");
+
+#endif /* COMPACTBOARD_H_ */
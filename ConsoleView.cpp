@@ -7,138 +7,235 @@
  */
 
 #include "ConsoleView.h"
+#include "Metrics.h"
+#include "Trace.h"
 #include <iostream>
-#include <set>
 #include <vector>
 
+namespace {
+
+const char CLEAR_SCREEN[] = "\x1b[H\x1b[2J"; ///< Cursor home, then clear
+
+/**
+ * Append a positive number in decimal, without going through a stream.
+ */
+void appendNumber(std::string &text, int number) {
+  char digits[12];
+  int digitCount = 0;
+  do {
+    digits[digitCount++] = '0' + number % 10;
+    number /= 10;
+  } while (number > 0);
+  while (digitCount > 0) {
+    text += digits[--digitCount];
+  }
+}
+
+/**
+ * Append the ANSI code that moves the cursor to a (1-based) line and column.
+ */
+void appendCursorMove(std::string &text, int line, int column) {
+  text += "\x1b[";
+  appendNumber(text, line);
+  text += ';';
+  appendNumber(text, column);
+  text += 'H';
+}
+
+} // namespace
+
 ConsoleView::ConsoleView(Board *board) { this->board = board; }
 
 /**
- * The main render function. It builds two  grids side-by-side
- * and print them.
+ * Draws the frame and flushes, just like printing every row with std::endl
+ * used to do.
  */
 void ConsoleView::print() {
-  int rows = board->getRows();
-  int columns = board->getColumns();
+  Trace::Span span("ConsoleView::print");
+  renderTo(std::cout);
+  std::cout.flush();
+}
 
-  // We use 2D character vectors to build the display layers first
-  std::vector<std::vector<char>> ownGridDisplay(rows);
-  std::vector<std::vector<char>> opponentGridDisplay(rows);
+void ConsoleView::renderTo(std::ostream &out) {
+  renderTo(frame);
+  out.write(frame.data(), frame.size());
+}
 
-  // Layer 1: Fill everything with water ('~')
-  for (int rowIdx = 0; rowIdx < rows; rowIdx++) {
-    ownGridDisplay[rowIdx].resize(columns, '~');
-    opponentGridDisplay[rowIdx].resize(columns, '~');
+/**
+ * The main render function. It builds two grids side-by-side in one block
+ * of text.
+ *
+ * Every line has a fixed length, so we can first lay out the empty frame
+ * (headers, row letters and water everywhere) and then paint each square
+ * straight into its spot:
+ *
+ *   "  1 2 3     1 2 3 \n"
+ *   "A ~ ~ ~   A ~ ~ ~ \n"
+ */
+void ConsoleView::renderTo(std::string &text) const {
+  Metrics::Timer timer(Metrics::VIEW_RENDER_NS);
+  Metrics::add(Metrics::VIEW_FRAMES);
+  int rows = board->getRows();
+  int columns = board->getColumns();
+  if (rows < 0 || columns < 0) {
+    rows = 0;
+    columns = 0;
   }
 
-  // Layer 2 (Own Grid): Draw our ships ('#')
-  OwnGrid &ownGrid = board->getOwnGrid();
-  std::vector<Ship> ships = ownGrid.getShips();
-
-  for (std::vector<Ship>::const_iterator shipIt = ships.begin();
-       shipIt != ships.end(); ++shipIt) {
-    std::set<GridPosition> occupied = shipIt->occupiedArea();
+  int lineLength = 4 * columns + 7; // 2 x (2 + 2 x columns) + 2 + newline
+  int opponentStart = 2 * columns + 4; // Where the right board starts
+  text.resize(std::size_t(rows + 1) * lineLength);
 
-    for (std::set<GridPosition>::const_iterator posIt = occupied.begin();
-         posIt != occupied.end(); ++posIt) {
-      int row = posIt->getRow() - 'A';
-      int col = posIt->getColumn() - 1;
+  // Layer 1: Headers, row letters, and water ('~') everywhere
+  char *line = &text[0];
+  line[0] = ' ';
+  line[1] = ' ';
+  for (int col = 1; col <= columns; col++) {
+    line[2 * col] = '0' + col % 10;
+    line[2 * col + 1] = ' ';
+    line[opponentStart + 2 * col] = '0' + col % 10;
+    line[opponentStart + 2 * col + 1] = ' ';
+  }
+  line[2 * columns + 2] = ' ';
+  line[2 * columns + 3] = ' ';
+  line[opponentStart] = ' ';
+  line[opponentStart + 1] = ' ';
+  line[lineLength - 1] = '\n';
 
-      if (row >= 0 && row < rows && col >= 0 && col < columns) {
-        ownGridDisplay[row][col] = '#';
-      }
+  for (int rowIdx = 0; rowIdx < rows; rowIdx++) {
+    line = &text[std::size_t(rowIdx + 1) * lineLength];
+    char rowLetter = 'A' + rowIdx;
+    line[0] = rowLetter;
+    line[1] = ' ';
+    for (int colIdx = 0; colIdx < columns; colIdx++) {
+      line[2 + 2 * colIdx] = '~';
+      line[3 + 2 * colIdx] = ' ';
+      line[opponentStart + 2 + 2 * colIdx] = '~';
+      line[opponentStart + 3 + 2 * colIdx] = ' ';
     }
+    line[2 * columns + 2] = ' ';
+    line[2 * columns + 3] = ' ';
+    line[opponentStart] = rowLetter;
+    line[opponentStart + 1] = ' ';
+    line[lineLength - 1] = '\n';
   }
 
-  // Layer 3 (Own Grid): Overwrite with opponent's hits ('O') and misses ('^')
-  const std::set<GridPosition> &ownShotAt = ownGrid.getShotAt();
-
-  for (std::set<GridPosition>::const_iterator shotIt = ownShotAt.begin();
-       shotIt != ownShotAt.end(); ++shotIt) {
-    int row = shotIt->getRow() - 'A';
-    int col = shotIt->getColumn() - 1;
-
-    if (row >= 0 && row < rows && col >= 0 && col < columns) {
-      if (ownGridDisplay[row][col] == '#') {
-        ownGridDisplay[row][col] = 'O'; // They hit our ship!
-      } else {
-        ownGridDisplay[row][col] = '^'; // They hit water.
+  // Layers 2 and 3 (Own Grid): our ships ('#'), and the opponent's hits ('O')
+  // and misses ('^'), straight from the grid's bitboards
+  OwnGrid &ownGrid = board->getOwnGrid();
+  const std::pmr::vector<uint64_t> &occupied = ownGrid.getOccupiedMask();
+  const std::pmr::vector<uint64_t> &shotAt = ownGrid.getShotMask();
+  int ownColumns = ownGrid.getColumns();
+
+  for (int rowIdx = 0; rowIdx < rows && rowIdx < ownGrid.getRows(); rowIdx++) {
+    line = &text[std::size_t(rowIdx + 1) * lineLength];
+    for (int colIdx = 0; colIdx < columns && colIdx < ownColumns; colIdx++) {
+      int idx = rowIdx * ownColumns + colIdx;
+      bool isShip = (occupied[idx >> 6] >> (idx & 63)) & 1;
+      bool isShot = (shotAt[idx >> 6] >> (idx & 63)) & 1;
+
+      if (isShot) {
+        line[2 + 2 * colIdx] = isShip ? 'O' : '^'; // Hit ship or water
+      } else if (isShip) {
+        line[2 + 2 * colIdx] = '#';
       }
     }
   }
 
   // Layer 2 (Opponent Grid): Draw ships we've successfully SUNK ('#')
   OpponentGrid &opponentGrid = board->getOpponentGrid();
-  const std::vector<Ship> &sunkenShips = opponentGrid.getSunkenShips();
+  Span<const Ship> sunkenShips = opponentGrid.getSunkenShipView();
 
-  for (std::vector<Ship>::const_iterator shipIt = sunkenShips.begin();
+  for (const Ship *shipIt = sunkenShips.begin();
        shipIt != sunkenShips.end(); ++shipIt) {
-    std::set<GridPosition> occupied = shipIt->occupiedArea();
+    GridArea area = shipIt->occupiedCells();
 
-    for (std::set<GridPosition>::const_iterator posIt = occupied.begin();
-         posIt != occupied.end(); ++posIt) {
-      int row = posIt->getRow() - 'A';
-      int col = posIt->getColumn() - 1;
+    for (GridArea::Iterator posIt = area.begin(); posIt != area.end();
+         ++posIt) {
+      int row = (*posIt).getRow() - 'A';
+      int col = (*posIt).getColumn() - 1;
 
       if (row >= 0 && row < rows && col >= 0 && col < columns) {
-        opponentGridDisplay[row][col] = '#';
+        text[std::size_t(row + 1) * lineLength + opponentStart + 2 + 2 * col] =
+            '#';
       }
     }
   }
 
   // Layer 3 (Opponent Grid): Draw our hits ('O') and misses ('^')
-  const std::map<GridPosition, Shot::Impact> &opponentShots =
-      opponentGrid.getShotsAt();
-
-  for (std::map<GridPosition, Shot::Impact>::const_iterator shotIt =
-           opponentShots.begin();
-       shotIt != opponentShots.end(); ++shotIt) {
-    int row = shotIt->first.getRow() - 'A';
-    int col = shotIt->first.getColumn() - 1;
-
-    if (row >= 0 && row < rows && col >= 0 && col < columns) {
-      if (shotIt->second == Shot::NONE) {
-        opponentGridDisplay[row][col] = '^'; // We missed.
-      } else if (shotIt->second == Shot::HIT ||
-                 shotIt->second == Shot::SUNKEN) {
+  const std::pmr::vector<unsigned char> &opponentStates =
+      opponentGrid.getCellStates();
+
+  for (int rowIdx = 0; rowIdx < rows && rowIdx < opponentGrid.getRows();
+       rowIdx++) {
+    line = &text[std::size_t(rowIdx + 1) * lineLength + opponentStart + 2];
+    for (int colIdx = 0; colIdx < columns && colIdx < opponentGrid.getColumns();
+         colIdx++) {
+      unsigned char state =
+          opponentStates[rowIdx * opponentGrid.getColumns() + colIdx];
+
+      if (state == OpponentGrid::MISS) {
+        line[2 * colIdx] = '^'; // We missed.
+      } else if (state == OpponentGrid::HIT || state == OpponentGrid::SUNK) {
         // Only mark 'O' if we haven't already marked the whole ship '#'
-        if (opponentGridDisplay[row][col] != '#') {
-          opponentGridDisplay[row][col] =
-              'O'; // We hit but it's not sunken (yet).
+        if (line[2 * colIdx] != '#') {
+          line[2 * colIdx] = 'O'; // We hit but it's not sunken (yet).
         }
       }
     }
   }
+}
 
-  // Now, print everything to the console with column headers
-  std::cout << "  ";
-  for (int col = 1; col <= columns; col++) {
-    std::cout << (col % 10) << " ";
-  }
-  std::cout << "    ";
-  for (int col = 1; col <= columns; col++) {
-    std::cout << (col % 10) << " ";
+void ConsoleView::printLive() {
+  Trace::Span span("ConsoleView::printLive");
+  renderLiveTo(changes);
+  std::cout.write(changes.data(), changes.size());
+  std::cout.flush();
+}
+
+void ConsoleView::restartLive() { shown.clear(); }
+
+/**
+ * Draws the new frame into 'frame' and compares it with 'shown' (the one on
+ * the terminal). Both have the same layout, so a changed character at
+ * position 'pos' sits on line pos / lineLength and column pos % lineLength.
+ *
+ * The terminal moves the cursor one step right after every symbol, so for
+ * changes right next to each other we can leave out the cursor move.
+ */
+void ConsoleView::renderLiveTo(std::string &text) {
+  Metrics::Timer timer(Metrics::VIEW_LIVE_NS);
+  renderTo(frame);
+  text.clear();
+
+  if (shown.size() != frame.size()) {
+    // Nothing (or a different board) on the terminal: draw it all
+    text += CLEAR_SCREEN;
+    text += frame;
+    shown = frame;
+    return;
   }
-  std::cout << std::endl;
 
-  // Print each row, starting with the row letter (A, B, C...)
-  for (int rowIdx = 0; rowIdx < rows; rowIdx++) {
-    char rowLetter = 'A' + rowIdx;
+  std::size_t lineLength = frame.find('\n') + 1;
+  std::size_t lineCount = frame.size() / lineLength;
+  std::size_t cursor = frame.size(); // Where the cursor is, as far as we know
 
-    // Drawing OUR board (Left side)
-    std::cout << rowLetter << " ";
-    for (int colIdx = 0; colIdx < columns; colIdx++) {
-      std::cout << ownGridDisplay[rowIdx][colIdx] << " ";
+  for (std::size_t pos = 0; pos < frame.size(); pos++) {
+    if (frame[pos] == shown[pos]) {
+      continue;
     }
 
-    std::cout << "  ";
-
-    // Drawing THE ENEMY board (Right side)
-    std::cout << rowLetter << " ";
-    for (int colIdx = 0; colIdx < columns; colIdx++) {
-      std::cout << opponentGridDisplay[rowIdx][colIdx] << " ";
+    if (pos != cursor) {
+      appendCursorMove(text, int(pos / lineLength) + 1,
+                       int(pos % lineLength) + 1);
     }
+    text += frame[pos];
+    shown[pos] = frame[pos];
+    cursor = pos + 1;
+    Metrics::add(Metrics::VIEW_LIVE_CHANGES);
+  }
 
-    std::cout << std::endl;
+  if (!text.empty()) {
+    appendCursorMove(text, int(lineCount) + 1, 1); // Park below the frame
   }
 }
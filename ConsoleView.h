@@ -9,6 +9,8 @@
 #define CONSOLEVIEW_H_
 
 #include "Board.h"
+#include <ostream>
+#include <string>
 
 /**
  * @class ConsoleView
@@ -17,10 +19,23 @@
  * It takes a Board and renders a text visualization.
  * Symbols used: '~' is water, '#' is a ship, 'O' is a hit ship, and '^' is a
  * miss.
+ *
+ * A whole frame (both grids with their headers) is drawn into one character
+ * buffer first and then written out in one go. The buffer is kept between
+ * calls, so drawing the same board again doesn't allocate any memory.
+ *
+ * For live displays there is a second mode (printLive()). It remembers the
+ * frame that is on the terminal and only sends ANSI "move the cursor here"
+ * codes plus the new symbol for the squares that changed. A shot changes one
+ * square (or one ship on a sink), so each update is only a few bytes long,
+ * however big the board is.
  */
 class ConsoleView {
 private:
-  Board *board; ///< The board we are currently visualizing
+  Board *board;      ///< The board we are currently visualizing
+  std::string frame; ///< Reused buffer for the last drawn frame
+  std::string shown; ///< Frame currently on the terminal (live mode)
+  std::string changes; ///< Reused buffer for the live mode's update codes
 
 public:
   /**
@@ -33,6 +48,39 @@ public:
    * console.
    */
   void print();
+
+  /**
+   * @brief Draw the frame into 'text' (replacing what was in it). Reuses
+   * the string's memory if it is big enough.
+   */
+  void renderTo(std::string &text) const;
+
+  /**
+   * @brief Draw the frame and hand it to 'out' with a single write.
+   */
+  void renderTo(std::ostream &out);
+
+  /**
+   * @brief Bring the live display on the console up to date.
+   */
+  void printLive();
+
+  /**
+   * @brief Put the terminal codes for the next live update into 'text'
+   * (replacing what was in it).
+   *
+   * The first update clears the screen and draws the whole frame in the top
+   * left corner. Later updates move the cursor to each changed square and
+   * draw only its new symbol. In the end the cursor is parked on the line
+   * below the frame.
+   */
+  void renderLiveTo(std::string &text);
+
+  /**
+   * @brief Forget what is on the terminal, so the next live update draws
+   * everything again (e.g. after other text was printed).
+   */
+  void restartLive();
 };
 
 #endif /* CONSOLEVIEW_H_ */
@@ -0,0 +1,152 @@
+/**
+ * @file FixedOwnGrid.h
+ * @brief Header for the FixedOwnGrid class template.
+ *
+ * An own grid whose size and fleet are fixed by a GameRules type.
+ */
+
+#ifndef FIXEDOWNGRID_H_
+#define FIXEDOWNGRID_H_
+
+#include "GameRules.h"
+#include "Shot.h"
+
+/**
+ * @brief Every placement of a rule set's ships, built by the compiler.
+ */
+template <typename Rules>
+inline constexpr typename Rules::Table RULES_PLACEMENTS{};
+
+/**
+ * @class FixedOwnGrid
+ * @brief OwnGrid's placing and shooting rules with everything sized by
+ * 'Rules' at compile time.
+ *
+ * The masks are BitMask<Rules::WORDS>, the inventory is an int array with
+ * one entry per length, and ships are found in RULES_PLACEMENTS<Rules>, so
+ * checking a placement is a table lookup and a fixed number of word ANDs.
+ * Nothing is allocated, and the grid can be copied with a plain memcpy.
+ *
+ * It answers shots exactly like an OwnGrid with the same fleet (a repeated
+ * shot doesn't count twice). It doesn't keep a shot log or undo history;
+ * it is meant for simulations that only need the answers.
+ */
+template <typename Rules> class FixedOwnGrid {
+public:
+  typedef typename Rules::Mask Mask; ///< One bit per square
+
+  static_assert(Rules::FLEET_SIZE <= 127, "Ship numbers must fit a char");
+
+private:
+  Mask occupied; ///< Squares covered by a ship
+  Mask blocked;  ///< Squares covered by a ship or its halo
+  Mask shot;     ///< Squares shot at
+  int available[Rules::MAX_LENGTH + 1];  ///< Ships left to place per length
+  signed char cellOwner[Rules::CELLS];   ///< Ship on each occupied square
+  int shipLength[Rules::FLEET_SIZE];     ///< Length of each placed ship
+  int shipHits[Rules::FLEET_SIZE];       ///< Distinct hits on each ship
+  int shipCount;                         ///< Ships placed
+  int sunkCount;                         ///< Ships sunk
+
+public:
+  /**
+   * @brief An empty grid with the full inventory.
+   */
+  FixedOwnGrid() { reset(); }
+
+  /**
+   * @brief Remove all ships and shots and refill the inventory.
+   */
+  void reset() {
+    occupied = Mask();
+    blocked = Mask();
+    shot = Mask();
+    for (int length = 0; length <= Rules::MAX_LENGTH; length++) {
+      available[length] = Rules::countOf(length);
+    }
+    shipCount = 0;
+    sunkCount = 0;
+  }
+
+  /**
+   * @brief Check if a ship could be placed (straight, on the board, a
+   * length the fleet still has, not touching another ship).
+   */
+  bool canPlaceShip(const Ship &ship) const {
+    int index = RULES_PLACEMENTS<Rules>.indexOf(ship);
+    return index >= 0 && available[ship.length()] > 0 &&
+           !blocked.intersects(RULES_PLACEMENTS<Rules>[index].occupied);
+  }
+
+  /**
+   * @brief Place a ship if canPlaceShip() allows it.
+   * @return True if the ship was placed.
+   */
+  bool placeShip(const Ship &ship) {
+    if (!canPlaceShip(ship)) {
+      return false;
+    }
+
+    const typename Rules::Table::Placement &placement =
+        RULES_PLACEMENTS<Rules>[RULES_PLACEMENTS<Rules>.indexOf(ship)];
+    int slot = shipCount++;
+    for (int wordIdx = 0; wordIdx < Rules::WORDS; wordIdx++) {
+      uint64_t bits = placement.occupied.word(wordIdx);
+      while (bits != 0) {
+        cellOwner[wordIdx * 64 + __builtin_ctzll(bits)] = (signed char)slot;
+        bits &= bits - 1;
+      }
+    }
+    occupied |= placement.occupied;
+    blocked |= placement.halo;
+    available[ship.length()]--;
+    shipLength[slot] = ship.length();
+    shipHits[slot] = (placement.occupied & shot).count();
+    sunkCount += (shipHits[slot] == shipLength[slot]) ? 1 : 0;
+    return true;
+  }
+
+  /**
+   * @brief Answer a shot at this grid.
+   */
+  Shot::Impact takeBlow(const Shot &blow) {
+    const GridPosition &target = blow.getTargetPosition();
+    int rowIdx = target.getRow() - 'A';
+    int colIdx = target.getColumn() - 1;
+    if (rowIdx < 0 || rowIdx >= Rules::ROWS || colIdx < 0 ||
+        colIdx >= Rules::COLUMNS) {
+      return Shot::NONE;
+    }
+
+    int cell = rowIdx * Rules::COLUMNS + colIdx;
+    bool firstShot = !shot.test(cell);
+    shot.set(cell);
+    if (!occupied.test(cell)) {
+      return Shot::NONE;
+    }
+
+    int slot = cellOwner[cell];
+    if (firstShot) {
+      shipHits[slot]++;
+      sunkCount += (shipHits[slot] == shipLength[slot]) ? 1 : 0;
+    }
+    return (shipHits[slot] == shipLength[slot]) ? Shot::SUNKEN : Shot::HIT;
+  }
+
+  /**
+   * @brief Number of ships placed.
+   */
+  int getShipCount() const { return shipCount; }
+
+  /**
+   * @brief Is the whole fleet of the rules placed?
+   */
+  bool isFleetComplete() const { return shipCount == Rules::FLEET_SIZE; }
+
+  /**
+   * @brief Has every placed ship been sunk (and at least one placed)?
+   */
+  bool allSunk() const { return shipCount > 0 && sunkCount == shipCount; }
+};
+
+#endif /* FIXEDOWNGRID_H_ */
@@ -0,0 +1,341 @@
+/**
+ * @file FleetGenerator.cpp
+ * @brief Implementation of the FleetGenerator class.
+ *
+ * Both modes work on whole fleets and on masks: ships are tried longest
+ * first, and only among the placements that are still free on the grid we
+ * were given. If a ship can't be placed we start over with an empty set of
+ * new ships. The grid only sees a fleet once it is complete.
+ *
+ * UNIFORM always runs FAST first. That answers "does the fleet fit at all?"
+ * quickly, and gives a layout to fall back on if no fair one turns up
+ * within MAX_UNIFORM_ATTEMPTS tries, so UNIFORM never fails where FAST
+ * succeeds.
+ */
+
+#include "FleetGenerator.h"
+#include "PlacementTable.h"
+#include <vector>
+
+namespace {
+
+const int MAX_SHIPS = 32;              ///< Largest fleet we can place at once
+const int MAX_FAST_ATTEMPTS = 1000;    ///< Restarts before FAST gives up
+const int MAX_UNIFORM_ATTEMPTS = 20000000; ///< Tries before UNIFORM does
+
+/**
+ * Lists the ships still left in the grid's inventory, longest first.
+ * Returns how many there are, or -1 if there are more than MAX_SHIPS.
+ */
+int shipLengths(const OwnGrid &grid, int lengths[]) {
+  int shipCount = 0;
+  const std::pmr::map<int, int> &available = grid.getAvailableShips();
+  for (std::pmr::map<int, int>::const_reverse_iterator countIt =
+           available.rbegin();
+       countIt != available.rend(); ++countIt) {
+    for (int copy = 0; copy < countIt->second; copy++) {
+      if (shipCount == MAX_SHIPS) {
+        return -1;
+      }
+      lengths[shipCount++] = countIt->first;
+    }
+  }
+  return shipCount;
+}
+
+/**
+ * Number of ways a ship of this length can lie on the board.
+ */
+int placementCount(int length, int rows, int columns) {
+  int across = (columns >= length) ? rows * (columns - length + 1) : 0;
+  int down = (rows >= length) ? columns * (rows - length + 1) : 0;
+  return across + down;
+}
+
+/**
+ * The placement with number 'index' (horizontal ones first, then vertical
+ * ones, both in row-major order - the same order as PlacementTable).
+ */
+Ship placementAt(int length, int index, int rows, int columns) {
+  int across = (columns >= length) ? rows * (columns - length + 1) : 0;
+  if (index < across) {
+    int rowIdx = index / (columns - length + 1);
+    int colIdx = index % (columns - length + 1);
+    return Ship(GridPosition('A' + rowIdx, colIdx + 1),
+                GridPosition('A' + rowIdx, colIdx + length));
+  }
+  index -= across;
+  int rowIdx = index / columns;
+  int colIdx = index % columns;
+  return Ship(GridPosition('A' + rowIdx, colIdx + 1),
+              GridPosition('A' + rowIdx + length - 1, colIdx + 1));
+}
+
+/**
+ * Sets the bits of every square of 'area' that lies on the board.
+ */
+void setCells(uint64_t *mask, const GridArea &area, int rows, int columns) {
+  for (GridArea::Iterator posIt = area.begin(); posIt != area.end();
+       ++posIt) {
+    int rowIdx = (*posIt).getRow() - 'A';
+    int colIdx = (*posIt).getColumn() - 1;
+    if (rowIdx >= 0 && rowIdx < rows && colIdx >= 0 && colIdx < columns) {
+      int cell = rowIdx * columns + colIdx;
+      mask[cell >> 6] |= uint64_t(1) << (cell & 63);
+    }
+  }
+}
+
+/**
+ * Do two masks of 'words' words share a square?
+ */
+bool intersects(const uint64_t *left, const uint64_t *right, int words) {
+  uint64_t common = 0;
+  for (int wordIdx = 0; wordIdx < words; wordIdx++) {
+    common |= left[wordIdx] & right[wordIdx];
+  }
+  return common != 0;
+}
+
+/**
+ * ORs 'mask' into 'target'.
+ */
+void addMask(uint64_t *target, const uint64_t *mask, int words) {
+  for (int wordIdx = 0; wordIdx < words; wordIdx++) {
+    target[wordIdx] |= mask[wordIdx];
+  }
+}
+
+} // namespace
+
+FleetGenerator::FleetGenerator(uint64_t seed) : random(seed) {}
+
+void FleetGenerator::reseed(uint64_t seed) { random.seed(seed); }
+
+int FleetGenerator::pick(int count) {
+  std::uniform_int_distribution<int> distribution(0, count - 1);
+  return distribution(random);
+}
+
+/**
+ * Hands the grid to the right strategy.
+ */
+bool FleetGenerator::fill(OwnGrid &grid, Mode mode) {
+  if (grid.getRows() == STANDARD_PLACEMENTS.ROWS &&
+      grid.getColumns() == STANDARD_PLACEMENTS.COLUMNS) {
+    return fillStandard(grid, mode);
+  }
+  return fillGeneric(grid, mode);
+}
+
+/**
+ * On a 10x10 board we copy the grid's blocked mask and work with the
+ * compile-time placement table. Table entries that are already blocked on
+ * the grid can never be used, so each ship only looks at the free ones:
+ * ship i picks from free[first[i]] up to free[last[i] - 1].
+ *
+ * FAST: for each ship, collect the free entries that don't hit the blocked
+ * mask yet and pick one of them.
+ *
+ * UNIFORM: pick any free entry for the ship's length and give up on this
+ * fleet if it hits the blocked mask. Every combination of free entries is
+ * then equally likely to be tried, and every legal one is equally likely to
+ * survive.
+ */
+bool FleetGenerator::fillStandard(OwnGrid &grid, Mode mode) {
+  typedef PlacementTable<10, 10>::Placement Placement;
+
+  int lengths[MAX_SHIPS];
+  int shipCount = shipLengths(grid, lengths);
+  if (shipCount < 0) {
+    return false; // Too many ships for our arrays
+  }
+
+  PlacementTable<10, 10>::Mask startMask;
+  const std::pmr::vector<uint64_t> &gridMask = grid.getBlockedMask();
+  for (int wordIdx = 0; wordIdx < STANDARD_PLACEMENTS.WORDS; wordIdx++) {
+    startMask.setWord(wordIdx, gridMask[wordIdx]);
+  }
+
+  const Placement *free[STANDARD_PLACEMENTS.SIZE];
+  int first[MAX_SHIPS];
+  int last[MAX_SHIPS];
+  int freeCount = 0;
+  for (int shipIdx = 0; shipIdx < shipCount; shipIdx++) {
+    int length = lengths[shipIdx];
+    if (shipIdx > 0 && length == lengths[shipIdx - 1]) {
+      first[shipIdx] = first[shipIdx - 1];
+      last[shipIdx] = last[shipIdx - 1];
+      continue;
+    }
+    first[shipIdx] = freeCount;
+    for (const Placement *placement = STANDARD_PLACEMENTS.begin(length);
+         placement != STANDARD_PLACEMENTS.end(length); ++placement) {
+      if (!placement->occupied.intersects(startMask)) {
+        free[freeCount++] = placement;
+      }
+    }
+    last[shipIdx] = freeCount;
+    if (first[shipIdx] == last[shipIdx]) {
+      return false; // This length never fits
+    }
+  }
+
+  const Placement *chosen[MAX_SHIPS];
+  const Placement *candidates[STANDARD_PLACEMENTS.SIZE];
+  bool complete = false;
+  for (int attempt = 0; attempt < MAX_FAST_ATTEMPTS && !complete;
+       attempt++) {
+    PlacementTable<10, 10>::Mask blocked = startMask;
+    complete = true;
+    for (int shipIdx = 0; shipIdx < shipCount && complete; shipIdx++) {
+      int candidateCount = 0;
+      for (int freeIdx = first[shipIdx]; freeIdx < last[shipIdx];
+           freeIdx++) {
+        if (!free[freeIdx]->occupied.intersects(blocked)) {
+          candidates[candidateCount++] = free[freeIdx];
+        }
+      }
+      complete = candidateCount > 0; // Otherwise no room left, start over
+      if (complete) {
+        chosen[shipIdx] = candidates[pick(candidateCount)];
+        blocked |= chosen[shipIdx]->halo;
+      }
+    }
+  }
+  if (!complete) {
+    return false;
+  }
+
+  if (mode == UNIFORM) {
+    const Placement *fair[MAX_SHIPS];
+    complete = false;
+    for (int attempt = 0; attempt < MAX_UNIFORM_ATTEMPTS && !complete;
+         attempt++) {
+      PlacementTable<10, 10>::Mask blocked = startMask;
+      complete = true;
+      for (int shipIdx = 0; shipIdx < shipCount && complete; shipIdx++) {
+        fair[shipIdx] =
+            free[first[shipIdx] + pick(last[shipIdx] - first[shipIdx])];
+        complete = !fair[shipIdx]->occupied.intersects(blocked);
+        if (complete) {
+          blocked |= fair[shipIdx]->halo;
+        }
+      }
+    }
+    for (int shipIdx = 0; complete && shipIdx < shipCount; shipIdx++) {
+      chosen[shipIdx] = fair[shipIdx];
+    }
+  }
+
+  for (int shipIdx = 0; shipIdx < shipCount; shipIdx++) {
+    grid.placeShip(Ship(chosen[shipIdx]->bow, chosen[shipIdx]->stern));
+  }
+  return true;
+}
+
+/**
+ * Same idea for any other board size. Without a compile-time table we
+ * number the placements the same way PlacementTable does and build the
+ * masks of the free ones here, so no copy of the grid is needed.
+ */
+bool FleetGenerator::fillGeneric(OwnGrid &grid, Mode mode) {
+  int rows = grid.getRows();
+  int columns = grid.getColumns();
+  int lengths[MAX_SHIPS];
+  int shipCount = shipLengths(grid, lengths);
+  if (shipCount < 0) {
+    return false; // Too many ships for our arrays
+  }
+
+  const std::pmr::vector<uint64_t> &startMask = grid.getBlockedMask();
+  int words = startMask.size();
+  std::vector<Ship> free;
+  std::vector<uint64_t> occupied; // 'words' words per free placement
+  std::vector<uint64_t> halo;
+  int first[MAX_SHIPS];
+  int last[MAX_SHIPS];
+  for (int shipIdx = 0; shipIdx < shipCount; shipIdx++) {
+    int length = lengths[shipIdx];
+    if (shipIdx > 0 && length == lengths[shipIdx - 1]) {
+      first[shipIdx] = first[shipIdx - 1];
+      last[shipIdx] = last[shipIdx - 1];
+      continue;
+    }
+    first[shipIdx] = free.size();
+    int count = placementCount(length, rows, columns);
+    for (int placementIdx = 0; placementIdx < count; placementIdx++) {
+      Ship ship = placementAt(length, placementIdx, rows, columns);
+      std::size_t offset = occupied.size();
+      occupied.resize(offset + words, 0);
+      setCells(&occupied[offset], ship.occupiedCells(), rows, columns);
+      if (intersects(&occupied[offset], startMask.data(), words)) {
+        occupied.resize(offset);
+        continue;
+      }
+      halo.resize(offset + words, 0);
+      setCells(&halo[offset], ship.blockedCells(), rows, columns);
+      free.push_back(ship);
+    }
+    last[shipIdx] = free.size();
+    if (first[shipIdx] == last[shipIdx]) {
+      return false; // This length never fits
+    }
+  }
+
+  std::vector<uint64_t> blocked(words);
+  std::vector<int> candidates(free.size());
+  int chosen[MAX_SHIPS];
+  bool complete = false;
+  for (int attempt = 0; attempt < MAX_FAST_ATTEMPTS && !complete;
+       attempt++) {
+    blocked.assign(startMask.begin(), startMask.end());
+    complete = true;
+    for (int shipIdx = 0; shipIdx < shipCount && complete; shipIdx++) {
+      int candidateCount = 0;
+      for (int freeIdx = first[shipIdx]; freeIdx < last[shipIdx];
+           freeIdx++) {
+        if (!intersects(&occupied[std::size_t(freeIdx) * words],
+                        blocked.data(), words)) {
+          candidates[candidateCount++] = freeIdx;
+        }
+      }
+      complete = candidateCount > 0; // Otherwise no room left, start over
+      if (complete) {
+        chosen[shipIdx] = candidates[pick(candidateCount)];
+        addMask(blocked.data(), &halo[std::size_t(chosen[shipIdx]) * words],
+                words);
+      }
+    }
+  }
+  if (!complete) {
+    return false;
+  }
+
+  if (mode == UNIFORM) {
+    int fair[MAX_SHIPS];
+    complete = false;
+    for (int attempt = 0; attempt < MAX_UNIFORM_ATTEMPTS && !complete;
+         attempt++) {
+      blocked.assign(startMask.begin(), startMask.end());
+      complete = true;
+      for (int shipIdx = 0; shipIdx < shipCount && complete; shipIdx++) {
+        fair[shipIdx] =
+            first[shipIdx] + pick(last[shipIdx] - first[shipIdx]);
+        std::size_t offset = std::size_t(fair[shipIdx]) * words;
+        complete = !intersects(&occupied[offset], blocked.data(), words);
+        if (complete) {
+          addMask(blocked.data(), &halo[offset], words);
+        }
+      }
+    }
+    for (int shipIdx = 0; complete && shipIdx < shipCount; shipIdx++) {
+      chosen[shipIdx] = fair[shipIdx];
+    }
+  }
+
+  for (int shipIdx = 0; shipIdx < shipCount; shipIdx++) {
+    grid.placeShip(free[chosen[shipIdx]]);
+  }
+  return true;
+}
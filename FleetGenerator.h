@@ -0,0 +1,80 @@
+/**
+ * @file FleetGenerator.h
+ * @brief Header for the FleetGenerator class.
+ *
+ * Fills an OwnGrid with a random, legal fleet.
+ */
+
+#ifndef FLEETGENERATOR_H_
+#define FLEETGENERATOR_H_
+
+#include "OwnGrid.h"
+#include <cstdint>
+#include <random>
+
+/**
+ * @class FleetGenerator
+ * @brief Places every ship that is still left in an OwnGrid's inventory at
+ * random, following the normal placement rules.
+ *
+ * The same seed always gives the same sequence of fleets. There are two
+ * modes:
+ * - FAST picks each ship (longest first) among the placements that are still
+ *   free, using mask tests instead of trial and error. It is very quick, but
+ *   some layouts come up more often than others.
+ * - UNIFORM makes every legal layout exactly equally likely. Each ship is
+ *   put on any of the placements for its length that are free on the
+ *   starting grid, and the whole fleet is thrown away as soon as one ship
+ *   touches another. This is much slower (about ten fleets per second on
+ *   an empty 10x10 board). The work is capped: on a board so tight that no
+ *   fair layout turns up in time, the FAST layout is used instead, so
+ *   UNIFORM only fails where FAST does.
+ */
+class FleetGenerator {
+public:
+  /**
+   * @brief How the random layouts are picked.
+   */
+  enum Mode {
+    FAST,   ///< Quick, but not every layout is equally likely
+    UNIFORM ///< Every legal layout is equally likely
+  };
+
+private:
+  std::mt19937_64 random; ///< Source of randomness
+
+  /**
+   * @brief Fill a 10x10 board, using the placement table.
+   */
+  bool fillStandard(OwnGrid &grid, Mode mode);
+
+  /**
+   * @brief Fill a board of any other size.
+   */
+  bool fillGeneric(OwnGrid &grid, Mode mode);
+
+  /**
+   * @brief Pick a number in [0, count) with every value equally likely.
+   */
+  int pick(int count);
+
+public:
+  /**
+   * @brief Create a generator with a fixed seed.
+   */
+  FleetGenerator(uint64_t seed);
+
+  /**
+   * @brief Restart the random sequence from a new seed.
+   */
+  void reseed(uint64_t seed);
+
+  /**
+   * @brief Place every ship that is still available in the grid.
+   * @return False if no legal layout was found, or if more than 32 ships are
+   * left to place; the grid is left unchanged in that case.
+   */
+  bool fill(OwnGrid &grid, Mode mode = FAST);
+};
+
+#endif /* FLEETGENERATOR_H_ */
@@ -0,0 +1,82 @@
+/**
+ * @file GameAnalyzer.cpp
+ * @brief Implementation of the GameAnalyzer class.
+ */
+
+#include "GameAnalyzer.h"
+
+GameAnalyzer::GameAnalyzer(int rows, int columns, int threads)
+    : pool(threads) {
+  this->rows = rows;
+  this->columns = columns;
+  workerStats.assign(pool.getThreadCount(), GameStats(rows, columns));
+  records.resize(std::size_t(TASKS_PER_WINDOW) * GAMES_PER_TASK);
+  lines.resize(std::size_t(TASKS_PER_WINDOW) * GAMES_PER_TASK);
+}
+
+int GameAnalyzer::getThreadCount() const { return pool.getThreadCount(); }
+
+/**
+ * The records only point into the reader's mapping, so filling a window
+ * copies nothing but three pointers per game.
+ */
+bool GameAnalyzer::addLog(const std::string &path) {
+  GameLogReader reader;
+  if (!reader.open(path)) {
+    return false;
+  }
+
+  bool more = true;
+  while (more) {
+    int count = 0;
+    while (count < int(records.size()) && reader.next(records[count])) {
+      count++;
+    }
+    more = count == int(records.size());
+
+    int taskCount = (count + GAMES_PER_TASK - 1) / GAMES_PER_TASK;
+    pool.run(taskCount, [this, count](int task, int worker) {
+      int first = task * GAMES_PER_TASK;
+      for (int game = first; game < first + GAMES_PER_TASK && game < count;
+           game++) {
+        workerStats[worker].addGame(records[game]);
+      }
+    });
+  }
+  return !reader.hasError();
+}
+
+/**
+ * The line strings are kept from window to window, so once they have grown
+ * to the longest line, reading doesn't allocate any more.
+ */
+void GameAnalyzer::addText(std::istream &in) {
+  bool more = true;
+  while (more) {
+    int count = 0;
+    while (count < int(lines.size()) && std::getline(in, lines[count])) {
+      if (!lines[count].empty() && lines[count][0] != '#') {
+        count++;
+      }
+    }
+    more = count == int(lines.size());
+
+    int taskCount = (count + GAMES_PER_TASK - 1) / GAMES_PER_TASK;
+    pool.run(taskCount, [this, count](int task, int worker) {
+      int first = task * GAMES_PER_TASK;
+      for (int game = first; game < first + GAMES_PER_TASK && game < count;
+           game++) {
+        workerStats[worker].addTextGame(lines[game]);
+      }
+    });
+  }
+}
+
+GameStats GameAnalyzer::getStats() const {
+  GameStats total(rows, columns);
+  for (std::vector<GameStats>::const_iterator statsIt = workerStats.begin();
+       statsIt != workerStats.end(); ++statsIt) {
+    total.merge(*statsIt);
+  }
+  return total;
+}
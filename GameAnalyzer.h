@@ -0,0 +1,77 @@
+/**
+ * @file GameAnalyzer.h
+ * @brief Header for the GameAnalyzer class.
+ *
+ * Runs GameStats over big collections of recorded games on several threads.
+ */
+
+#ifndef GAMEANALYZER_H_
+#define GAMEANALYZER_H_
+
+#include "GameStats.h"
+#include "WorkStealingPool.h"
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * @class GameAnalyzer
+ * @brief Counts the games of logs and text files with all threads.
+ *
+ * The games are read in windows of TASKS_PER_WINDOW * GAMES_PER_TASK. Each
+ * window is shared out over a WorkStealingPool, and every worker adds its
+ * games to its own GameStats, so the threads never touch the same counters.
+ * getStats() adds the workers' GameStats together at the end.
+ *
+ * Only one window is held at a time (and for logs, only pointers into the
+ * mapped file), so tens of millions of games take no more memory than a
+ * few thousand.
+ */
+class GameAnalyzer {
+public:
+  static constexpr int GAMES_PER_TASK = 1024;  ///< Games one task counts
+  static constexpr int TASKS_PER_WINDOW = 64;  ///< Tasks per window
+
+private:
+  int rows;                         ///< Height of the boards
+  int columns;                      ///< Width of the boards
+  WorkStealingPool pool;            ///< The worker threads
+  std::vector<GameStats> workerStats; ///< One GameStats per worker
+  std::vector<GameRecord> records;  ///< Window of log games
+  std::vector<std::string> lines;   ///< Window of text games
+
+public:
+  /**
+   * @brief An analyzer for games on rows x columns boards.
+   * @param threads Number of worker threads (at least 1).
+   */
+  GameAnalyzer(int rows, int columns, int threads);
+
+  GameAnalyzer(const GameAnalyzer &) = delete;
+  GameAnalyzer &operator=(const GameAnalyzer &) = delete;
+
+  /**
+   * @brief Number of worker threads.
+   */
+  int getThreadCount() const;
+
+  /**
+   * @brief Count every game of a binary game log.
+   * @return False if the file can't be read or is damaged (the games
+   * before the damage are still counted).
+   */
+  bool addLog(const std::string &path);
+
+  /**
+   * @brief Count every text game of a stream, one game per line (see
+   * GameStats). Empty lines and lines starting with '#' are ignored.
+   */
+  void addText(std::istream &in);
+
+  /**
+   * @brief All workers' counts added together.
+   */
+  GameStats getStats() const;
+};
+
+#endif /* GAMEANALYZER_H_ */
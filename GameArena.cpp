@@ -0,0 +1,26 @@
+/**
+ * @file GameArena.cpp
+ * @brief Implementation of the GameArena class.
+ */
+
+#include "GameArena.h"
+
+/**
+ * 'buffer' is declared before 'resource', so it already exists when the
+ * resource is pointed at it. Anything that doesn't fit goes to the default
+ * resource (the normal heap).
+ */
+GameArena::GameArena(std::size_t bytes)
+    : buffer(bytes > 0 ? bytes : 1),
+      resource(buffer.data(), buffer.size(), std::pmr::get_default_resource()) {
+}
+
+std::pmr::memory_resource *GameArena::getResource() { return &resource; }
+
+/**
+ * release() frees the borrowed heap blocks (if any) and starts handing out
+ * the buffer from the front again.
+ */
+void GameArena::reset() { resource.release(); }
+
+std::size_t GameArena::getCapacity() const { return buffer.size(); }
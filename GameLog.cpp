@@ -0,0 +1,374 @@
+/**
+ * @file GameLog.cpp
+ * @brief Implementation of GameLogWriter, GameRecord and GameLogReader.
+ *
+ * Numbers are written byte by byte (lowest byte first), so a log written on
+ * one computer can be read on any other, and the reader never has to worry
+ * about unaligned reads out of the mapping.
+ */
+
+#include "GameLog.h"
+#include <cstring>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GAMELOG_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/**
+ * Append the lowest 'count' bytes of 'value', lowest first.
+ */
+void appendNumber(std::vector<unsigned char> &bytes, uint64_t value,
+                  int count) {
+  for (int byteIdx = 0; byteIdx < count; byteIdx++) {
+    bytes.push_back((unsigned char)(value >> (8 * byteIdx)));
+  }
+}
+
+/**
+ * Read a number of 'count' bytes, lowest first.
+ */
+uint64_t readNumber(const unsigned char *bytes, int count) {
+  uint64_t value = 0;
+  for (int byteIdx = 0; byteIdx < count; byteIdx++) {
+    value |= uint64_t(bytes[byteIdx]) << (8 * byteIdx);
+  }
+  return value;
+}
+
+/**
+ * Is this the file header of a log we can read?
+ */
+bool isFileHeader(const unsigned char *bytes, std::size_t length) {
+  return length >= std::size_t(GameLogFormat::FILE_HEADER_SIZE) &&
+         std::memcmp(bytes, GameLogFormat::MAGIC, 4) == 0 &&
+         readNumber(bytes + 4, 2) == uint64_t(GameLogFormat::VERSION);
+}
+
+/**
+ * Append a ship's ends as two square indices.
+ */
+void appendShip(std::vector<unsigned char> &bytes, const Ship &ship,
+                int columns) {
+  appendNumber(bytes, ship.getBow().toIndex(columns), 2);
+  appendNumber(bytes, ship.getStern().toIndex(columns), 2);
+}
+
+} // namespace
+
+GameLogWriter::GameLogWriter() {
+  this->columns = 0;
+  this->cellCount = 0;
+  this->shotCount = 0;
+  this->inGame = false;
+}
+
+/**
+ * Looks at what is already in the file first: appending games to something
+ * that isn't a game log would only produce a broken file.
+ */
+bool GameLogWriter::open(const std::string &path) {
+  close();
+
+  unsigned char header[GameLogFormat::FILE_HEADER_SIZE];
+  std::ifstream existing(path.c_str(), std::ios::binary);
+  existing.read((char *)header, sizeof(header));
+  std::size_t existingBytes = existing.gcount();
+  if (existingBytes > 0 && !isFileHeader(header, existingBytes)) {
+    return false;
+  }
+  existing.close();
+
+  out.open(path.c_str(), std::ios::binary | std::ios::app);
+  if (!out) {
+    return false;
+  }
+  if (existingBytes == 0) {
+    record.clear();
+    for (int byteIdx = 0; byteIdx < 4; byteIdx++) {
+      record.push_back((unsigned char)GameLogFormat::MAGIC[byteIdx]);
+    }
+    appendNumber(record, GameLogFormat::VERSION, 2);
+    appendNumber(record, 0, 2);
+    out.write((const char *)record.data(), record.size());
+  }
+  return bool(out);
+}
+
+bool GameLogWriter::isOpen() const { return out.is_open(); }
+
+/**
+ * Writes the game header (with a shot count of 0 for now) and both fleets,
+ * and makes room for every square to be shot at by both players.
+ */
+bool GameLogWriter::beginGame(uint64_t seed, const OwnGrid &first,
+                              const OwnGrid &second) {
+  inGame = false;
+  int rows = first.getRows();
+  columns = first.getColumns();
+  cellCount = rows * columns;
+  Span<const Ship> fleets[2] = {first.getShipView(), second.getShipView()};
+
+  if (!out.is_open() || second.getRows() != rows ||
+      second.getColumns() != columns || rows < 1 || rows > 255 ||
+      columns < 1 || columns > 255 || cellCount > GameLogFormat::MAX_CELLS ||
+      fleets[0].size() > 255 || fleets[1].size() > 255) {
+    return false;
+  }
+
+  record.clear();
+  record.reserve(GameLogFormat::GAME_HEADER_SIZE +
+                 4 * (fleets[0].size() + fleets[1].size()) +
+                 2 * 2 * std::size_t(cellCount));
+  appendNumber(record, seed, 8);
+  appendNumber(record, rows, 1);
+  appendNumber(record, columns, 1);
+  appendNumber(record, fleets[0].size(), 1);
+  appendNumber(record, fleets[1].size(), 1);
+  appendNumber(record, 0, 4); // Shot count, filled in by endGame()
+
+  for (int player = 0; player < 2; player++) {
+    for (const Ship *shipIt = fleets[player].begin();
+         shipIt != fleets[player].end(); ++shipIt) {
+      appendShip(record, *shipIt, columns);
+    }
+  }
+
+  shotCount = 0;
+  inGame = true;
+  return true;
+}
+
+bool GameLogWriter::addShot(int player, const Shot &shot,
+                            Shot::Impact impact) {
+  const GridPosition &target = shot.getTargetPosition();
+  int rowIdx = target.getRow() - 'A';
+  int colIdx = target.getColumn() - 1;
+  if (!inGame || player < 0 || player > 1 || colIdx < 0 ||
+      colIdx >= columns || rowIdx < 0 || rowIdx * columns >= cellCount) {
+    return false;
+  }
+
+  int cell = rowIdx * columns + colIdx;
+  appendNumber(record, (cell << 3) | (player << 2) | int(impact), 2);
+  shotCount++;
+  return true;
+}
+
+bool GameLogWriter::endGame() {
+  if (!inGame) {
+    return false;
+  }
+  inGame = false;
+
+  for (int byteIdx = 0; byteIdx < 4; byteIdx++) {
+    record[12 + byteIdx] = (unsigned char)(shotCount >> (8 * byteIdx));
+  }
+  out.write((const char *)record.data(), record.size());
+  return bool(out);
+}
+
+void GameLogWriter::close() {
+  if (out.is_open()) {
+    out.close();
+  }
+  inGame = false;
+}
+
+GameRecord::GameRecord() {
+  this->header = 0;
+  this->ships = 0;
+  this->shots = 0;
+}
+
+GridPosition GameRecord::position(int cell) const {
+  return GridPosition::fromIndex(cell, getColumns());
+}
+
+uint64_t GameRecord::getSeed() const { return readNumber(header, 8); }
+
+int GameRecord::getRows() const { return header[8]; }
+
+int GameRecord::getColumns() const { return header[9]; }
+
+int GameRecord::getShipCount(int player) const { return header[10 + player]; }
+
+/**
+ * Player 1's ships come right after player 0's.
+ */
+Ship GameRecord::getShip(int player, int index) const {
+  int shipIdx = (player == 0) ? index : getShipCount(0) + index;
+  const unsigned char *ends = ships + 4 * shipIdx;
+  return Ship(position(int(readNumber(ends, 2))),
+              position(int(readNumber(ends + 2, 2))));
+}
+
+uint32_t GameRecord::getShotCount() const {
+  return uint32_t(readNumber(header + 12, 4));
+}
+
+int GameRecord::getShooter(uint32_t index) const {
+  return (readNumber(shots + 2 * std::size_t(index), 2) >> 2) & 1;
+}
+
+Shot GameRecord::getShot(uint32_t index) const {
+  int code = int(readNumber(shots + 2 * std::size_t(index), 2));
+  return Shot(position(code >> 3));
+}
+
+Shot::Impact GameRecord::getImpact(uint32_t index) const {
+  return Shot::Impact(readNumber(shots + 2 * std::size_t(index), 2) & 3);
+}
+
+/**
+ * The shots are decoded one at a time right out of the file's bytes; nothing
+ * is copied into a list first.
+ */
+bool GameRecord::replay(Board &first, Board &second) const {
+  Board *boards[2] = {&first, &second};
+  for (int player = 0; player < 2; player++) {
+    if (boards[player]->getRows() != getRows() ||
+        boards[player]->getColumns() != getColumns()) {
+      return false;
+    }
+    for (int shipIdx = 0; shipIdx < getShipCount(player); shipIdx++) {
+      if (!boards[player]->getOwnGrid().placeShip(getShip(player, shipIdx))) {
+        return false;
+      }
+    }
+  }
+
+  uint32_t shotCount = getShotCount();
+  int columns = getColumns();
+  for (uint32_t shotIdx = 0; shotIdx < shotCount; shotIdx++) {
+    int code = int(readNumber(shots + 2 * std::size_t(shotIdx), 2));
+    int shooter = (code >> 2) & 1;
+    Shot shot(GridPosition::fromIndex(code >> 3, columns));
+
+    Shot::Impact impact = boards[1 - shooter]->getOwnGrid().takeBlow(shot);
+    if (impact != Shot::Impact(code & 3)) {
+      return false;
+    }
+    boards[shooter]->getOpponentGrid().shotResult(shot, impact);
+  }
+  return true;
+}
+
+GameLogReader::GameLogReader() {
+  this->data = 0;
+  this->length = 0;
+  this->offset = 0;
+  this->mapped = false;
+  this->broken = false;
+}
+
+GameLogReader::~GameLogReader() { close(); }
+
+/**
+ * Maps the file read-only and tells the system we'll read it from front to
+ * back, so it can read ahead. The mapping stays valid after the file
+ * descriptor is closed.
+ */
+bool GameLogReader::open(const std::string &path) {
+  close();
+
+#ifdef GAMELOG_MMAP
+  int file = ::open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    return false;
+  }
+  struct stat info;
+  if (fstat(file, &info) != 0 || info.st_size <= 0) {
+    ::close(file);
+    return false;
+  }
+  void *region =
+      mmap(0, std::size_t(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+  ::close(file);
+  if (region == MAP_FAILED) {
+    return false;
+  }
+  madvise(region, std::size_t(info.st_size), MADV_SEQUENTIAL);
+  data = (const unsigned char *)region;
+  length = std::size_t(info.st_size);
+  mapped = true;
+#else
+  std::ifstream in(path.c_str(), std::ios::binary);
+  fallback.assign(std::istreambuf_iterator<char>(in),
+                  std::istreambuf_iterator<char>());
+  data = fallback.data();
+  length = fallback.size();
+#endif
+
+  if (!isFileHeader(data, length)) {
+    close();
+    return false;
+  }
+  offset = GameLogFormat::FILE_HEADER_SIZE;
+  return true;
+}
+
+void GameLogReader::close() {
+#ifdef GAMELOG_MMAP
+  if (mapped) {
+    munmap((void *)data, length);
+  }
+#endif
+  fallback.clear();
+  data = 0;
+  length = 0;
+  offset = 0;
+  mapped = false;
+  broken = false;
+}
+
+std::size_t GameLogReader::getFileSize() const { return length; }
+
+void GameLogReader::rewind() {
+  if (data != 0) {
+    offset = GameLogFormat::FILE_HEADER_SIZE;
+    broken = false;
+  }
+}
+
+/**
+ * Only the game header is looked at: it says how long the record is, and
+ * the record must fit in what is left of the file.
+ */
+bool GameLogReader::next(GameRecord &game) {
+  if (broken || offset >= length) {
+    return false;
+  }
+
+  const unsigned char *header = data + offset;
+  std::size_t left = length - offset;
+  if (left < std::size_t(GameLogFormat::GAME_HEADER_SIZE)) {
+    broken = true;
+    return false;
+  }
+
+  int rows = header[8];
+  int columns = header[9];
+  uint64_t recordSize = GameLogFormat::GAME_HEADER_SIZE +
+                        4 * uint64_t(header[10] + header[11]) +
+                        2 * readNumber(header + 12, 4);
+  if (rows == 0 || columns == 0 || rows * columns > GameLogFormat::MAX_CELLS ||
+      recordSize > left) {
+    broken = true;
+    return false;
+  }
+
+  game.header = header;
+  game.ships = header + GameLogFormat::GAME_HEADER_SIZE;
+  game.shots = game.ships + 4 * (header[10] + header[11]);
+  offset += std::size_t(recordSize);
+  return true;
+}
+
+bool GameLogReader::hasError() const { return broken; }
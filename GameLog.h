@@ -0,0 +1,255 @@
+/**
+ * @file GameLog.h
+ * @brief Header for the game log classes.
+ *
+ * A compact binary file format for archiving played games, a writer that
+ * appends to it, and a reader that replays the games straight out of the
+ * (memory-mapped) file.
+ */
+
+#ifndef GAMELOG_H_
+#define GAMELOG_H_
+
+#include "Board.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The file format, all numbers little-endian.
+ *
+ * File header (8 bytes): "BSGL", version (uint16), zero (uint16).
+ *
+ * Then one record per game:
+ *   - seed (uint64), rows (uint8), columns (uint8), ships of player 0
+ *     (uint8), ships of player 1 (uint8), shot count (uint32)
+ *   - the fleets, player 0 first: bow and stern of every ship as square
+ *     indices (uint16 each, index = rowIdx * columns + colIdx)
+ *   - the shots in the order they were fired, one uint16 each: the impact
+ *     in bits 0-1, the player who fired in bit 2 and the square index in
+ *     bits 3-15
+ *
+ * A 10x10 game with two standard fleets and 150 shots takes 396 bytes.
+ */
+namespace GameLogFormat {
+constexpr char MAGIC[4] = {'B', 'S', 'G', 'L'}; ///< Every log starts so
+constexpr int VERSION = 1;                      ///< Current format version
+constexpr int FILE_HEADER_SIZE = 8;  ///< Magic, version, zero
+constexpr int GAME_HEADER_SIZE = 16; ///< Seed, sizes, ship and shot counts
+constexpr int MAX_CELLS = 1 << 13;   ///< Square indices have 13 bits
+} // namespace GameLogFormat
+
+/**
+ * @class GameLogWriter
+ * @brief Appends games to a log file.
+ *
+ * Call beginGame() with both fleets, addShot() for every shot and endGame()
+ * to write the game out. The game is collected in a buffer that is reused
+ * from game to game and made big enough for a whole game in beginGame(),
+ * so adding a shot never allocates memory.
+ */
+class GameLogWriter {
+private:
+  std::ofstream out;                 ///< The log file (appended to)
+  std::vector<unsigned char> record; ///< The game being collected
+  int columns;        ///< Width of the current game's boards
+  int cellCount;      ///< Squares of the current game's boards
+  uint32_t shotCount; ///< Shots added to the current game
+  bool inGame;        ///< Between beginGame() and endGame()
+
+public:
+  /**
+   * @brief Create a writer that isn't connected to a file yet.
+   */
+  GameLogWriter();
+
+  /**
+   * @brief Open a log file for appending. A new (or empty) file gets the
+   * file header first.
+   * @return False if the file can't be opened, or isn't a game log.
+   */
+  bool open(const std::string &path);
+
+  /**
+   * @brief Is a file open?
+   */
+  bool isOpen() const;
+
+  /**
+   * @brief Start a new game (a started game that wasn't ended is dropped).
+   * @param seed The game's seed, to find it again later.
+   * @param first Own grid of player 0, with its fleet placed.
+   * @param second Own grid of player 1, with its fleet placed.
+   * @return False if no file is open or the grids don't fit the format.
+   */
+  bool beginGame(uint64_t seed, const OwnGrid &first, const OwnGrid &second);
+
+  /**
+   * @brief Add one shot to the current game.
+   * @param player Who fired (0 or 1).
+   * @return False if there is no game, or the shot was off the grid.
+   */
+  bool addShot(int player, const Shot &shot, Shot::Impact impact);
+
+  /**
+   * @brief Write the current game to the file.
+   * @return False if there was no game or the write failed.
+   */
+  bool endGame();
+
+  /**
+   * @brief Flush and close the file.
+   */
+  void close();
+};
+
+/**
+ * @class GameRecord
+ * @brief One game of a log, read straight from the file's bytes.
+ *
+ * A record doesn't own any memory; it points into the reader's mapping, so
+ * it is only valid while the reader stays open.
+ */
+class GameRecord {
+private:
+  const unsigned char *header; ///< Start of the game header
+  const unsigned char *ships;  ///< Start of the fleets
+  const unsigned char *shots;  ///< Start of the shots
+
+  friend class GameLogReader;
+
+  /**
+   * @brief A square index of this game as a position.
+   */
+  GridPosition position(int cell) const;
+
+public:
+  /**
+   * @brief An empty record (use GameLogReader::next() to fill it).
+   */
+  GameRecord();
+
+  /**
+   * @brief The seed the game was logged with.
+   */
+  uint64_t getSeed() const;
+
+  /**
+   * @brief Height of the boards.
+   */
+  int getRows() const;
+
+  /**
+   * @brief Width of the boards.
+   */
+  int getColumns() const;
+
+  /**
+   * @brief Number of ships in a player's fleet.
+   */
+  int getShipCount(int player) const;
+
+  /**
+   * @brief One ship of a player's fleet.
+   */
+  Ship getShip(int player, int index) const;
+
+  /**
+   * @brief Number of shots fired in the game (both players).
+   */
+  uint32_t getShotCount() const;
+
+  /**
+   * @brief Who fired shot number 'index' (0 or 1).
+   */
+  int getShooter(uint32_t index) const;
+
+  /**
+   * @brief Where shot number 'index' went.
+   */
+  Shot getShot(uint32_t index) const;
+
+  /**
+   * @brief What shot number 'index' did.
+   */
+  Shot::Impact getImpact(uint32_t index) const;
+
+  /**
+   * @brief Play the game again on two fresh boards of the right size.
+   *
+   * Places both fleets, then lets every shot hit the other player's
+   * OwnGrid and goes back into the shooter's OpponentGrid.
+   * @return False if a ship can't be placed or an impact differs from the
+   * one in the log (the log doesn't belong to these rules).
+   */
+  bool replay(Board &first, Board &second) const;
+};
+
+/**
+ * @class GameLogReader
+ * @brief Reads the games of a log file one after the other.
+ *
+ * The file is memory-mapped, so the operating system pages it in as the
+ * games are read. Even a log of many gigabytes is never copied into the
+ * program's own memory. (Where mmap isn't available, the file is read into
+ * a buffer instead.)
+ */
+class GameLogReader {
+private:
+  const unsigned char *data; ///< The whole file
+  std::size_t length;        ///< Size of the file in bytes
+  std::size_t offset;        ///< Where the next game starts
+  bool mapped;               ///< True if 'data' is an mmap'ed region
+  bool broken;               ///< True once a damaged record was found
+  std::vector<unsigned char> fallback; ///< File contents without mmap
+
+public:
+  /**
+   * @brief Create a reader without a file.
+   */
+  GameLogReader();
+
+  /**
+   * @brief Unmaps the file.
+   */
+  ~GameLogReader();
+
+  GameLogReader(const GameLogReader &) = delete;
+  GameLogReader &operator=(const GameLogReader &) = delete;
+
+  /**
+   * @brief Map a log file and check its file header.
+   * @return False if the file can't be opened or isn't a game log.
+   */
+  bool open(const std::string &path);
+
+  /**
+   * @brief Let go of the file.
+   */
+  void close();
+
+  /**
+   * @brief Size of the open file in bytes.
+   */
+  std::size_t getFileSize() const;
+
+  /**
+   * @brief Go back to the first game.
+   */
+  void rewind();
+
+  /**
+   * @brief Read the next game.
+   * @return False at the end of the file, or if the next record is damaged
+   * (then hasError() is true).
+   */
+  bool next(GameRecord &game);
+
+  /**
+   * @brief Did reading stop at a damaged or cut-off record?
+   */
+  bool hasError() const;
+};
+
+#endif /* GAMELOG_H_ */
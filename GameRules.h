@@ -0,0 +1,140 @@
+/**
+ * @file GameRules.h
+ * @brief Header for the GameRules class template.
+ *
+ * Board size and fleet of a set of rules, fixed at compile time.
+ */
+
+#ifndef GAMERULES_H_
+#define GAMERULES_H_
+
+#include "BitMask.h"
+#include "PlacementTable.h"
+#include <map>
+
+/**
+ * @brief 'Count' ships of 'Length' squares, one entry of a GameRules fleet.
+ */
+template <int Length, int Count> struct ShipCount {
+  static_assert(Length >= 1 && Count >= 1, "A fleet entry needs ships");
+  static constexpr int LENGTH = Length; ///< Squares per ship
+  static constexpr int COUNT = Count;   ///< Ships of this length
+};
+
+/**
+ * @class GameRules
+ * @brief Board size and fleet inventory as compile-time constants.
+ *
+ * For example the German rules (10x10, one ship of 5, two of 4, three of 3
+ * and four of 2) are
+ *
+ *   GameRules<10, 10, ShipCount<5, 1>, ShipCount<4, 2>, ShipCount<3, 3>,
+ *             ShipCount<2, 4>>
+ *
+ * Everything a grid needs - mask width, number of squares, fleet size, the
+ * inventory per length and the table of all placements - is a constant, so
+ * code written against a GameRules type (see FixedOwnGrid) has fixed loop
+ * bounds and arrays that the compiler can unroll.
+ */
+template <int Rows, int Columns, typename... Fleet> class GameRules {
+  static_assert(Rows >= 1 && Rows <= 26, "Rows are the letters A to Z");
+  static_assert(Columns >= 1, "A board needs at least one column");
+  static_assert(sizeof...(Fleet) >= 1, "A fleet needs at least one ship");
+
+  /**
+   * @brief Shortest (or longest, if 'longest') ship of the fleet.
+   */
+  static constexpr int lengthBound(bool longest) {
+    constexpr int lengths[] = {Fleet::LENGTH...};
+    int bound = lengths[0];
+    for (int typeIdx = 1; typeIdx < int(sizeof...(Fleet)); typeIdx++) {
+      bool better = longest ? lengths[typeIdx] > bound
+                            : lengths[typeIdx] < bound;
+      bound = better ? lengths[typeIdx] : bound;
+    }
+    return bound;
+  }
+
+public:
+  static constexpr int ROWS = Rows;               ///< Board height
+  static constexpr int COLUMNS = Columns;         ///< Board width
+  static constexpr int CELLS = Rows * Columns;    ///< Squares on the board
+  static constexpr int WORDS = (CELLS + 63) / 64; ///< Mask width in words
+  static constexpr int MIN_LENGTH = lengthBound(false); ///< Shortest ship
+  static constexpr int MAX_LENGTH = lengthBound(true);  ///< Longest ship
+  static constexpr int FLEET_SIZE = (0 + ... + Fleet::COUNT); ///< Ships
+  static constexpr int FLEET_CELLS =
+      (0 + ... + (Fleet::LENGTH * Fleet::COUNT)); ///< Squares of all ships
+
+  static_assert(MAX_LENGTH <= (Rows > Columns ? Rows : Columns),
+                "Every ship must fit on the board");
+
+  typedef BitMask<WORDS> Mask; ///< One bit per square
+  typedef PlacementTable<Rows, Columns, MIN_LENGTH, MAX_LENGTH>
+      Table; ///< Every placement of every ship length
+
+  /**
+   * @brief Ships allowed per length, as a plain array.
+   */
+  struct Inventory {
+    int counts[MAX_LENGTH + 1]; ///< counts[length], 0 if not in the fleet
+  };
+
+  /**
+   * @brief Build the inventory (meant to be evaluated by the compiler).
+   */
+  static constexpr Inventory makeInventory() {
+    Inventory inventory{};
+    constexpr int lengths[] = {Fleet::LENGTH...};
+    constexpr int counts[] = {Fleet::COUNT...};
+    for (int typeIdx = 0; typeIdx < int(sizeof...(Fleet)); typeIdx++) {
+      inventory.counts[lengths[typeIdx]] += counts[typeIdx];
+    }
+    return inventory;
+  }
+
+  static constexpr Inventory INVENTORY = makeInventory(); ///< Per length
+
+  /**
+   * @brief Ships of a length the fleet has (0 for any other length).
+   */
+  static constexpr int countOf(int length) {
+    return (length >= 0 && length <= MAX_LENGTH) ? INVENTORY.counts[length]
+                                                 : 0;
+  }
+
+  /**
+   * @brief The inventory as OwnGrid takes it.
+   */
+  static std::map<int, int> fleet() {
+    std::map<int, int> ships;
+    for (int length = MIN_LENGTH; length <= MAX_LENGTH; length++) {
+      if (countOf(length) > 0) {
+        ships[length] = countOf(length);
+      }
+    }
+    return ships;
+  }
+};
+
+/**
+ * @brief The rules OwnGrid uses by default: 10x10, 1x5, 2x4, 3x3, 4x2.
+ */
+typedef GameRules<10, 10, ShipCount<5, 1>, ShipCount<4, 2>, ShipCount<3, 3>,
+                  ShipCount<2, 4>>
+    GermanRules;
+
+/**
+ * @brief The Milton Bradley fleet on 10x10: 5, 4, 3, 3 and 2.
+ */
+typedef GameRules<10, 10, ShipCount<5, 1>, ShipCount<4, 1>, ShipCount<3, 2>,
+                  ShipCount<2, 1>>
+    ClassicRules;
+
+/**
+ * @brief A short game on 8x8: 1x4, 2x3, 3x2.
+ */
+typedef GameRules<8, 8, ShipCount<4, 1>, ShipCount<3, 2>, ShipCount<2, 3>>
+    SmallRules;
+
+#endif /* GAMERULES_H_ */
@@ -0,0 +1,388 @@
+/**
+ * @file GameStats.cpp
+ * @brief Implementation of the GameStats class.
+ */
+
+#include "GameStats.h"
+#include <cstdio>
+
+namespace {
+
+/**
+ * Write 'part / whole' with four decimals, or nothing if 'whole' is 0.
+ * Goes through snprintf so the stream's own number format isn't touched.
+ */
+void writeRatio(std::ostream &out, long part, long whole) {
+  if (whole == 0) {
+    return;
+  }
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.4f", double(part) / double(whole));
+  out << text;
+}
+
+} // namespace
+
+GameStats::GameStats(int rows, int columns) {
+  if (rows < 0 || columns < 0) {
+    rows = 0;
+    columns = 0;
+  }
+  this->rows = rows;
+  this->columns = columns;
+  this->cellCount = rows * columns;
+  this->maxLength = (rows > columns) ? rows : columns;
+  this->turnBands = (cellCount + TURN_BAND - 1) / TURN_BAND;
+  if (turnBands < 1) {
+    turnBands = 1;
+  }
+  this->games = 0;
+  this->skipped = 0;
+
+  placement.assign(std::size_t(maxLength + 1) * cellCount, 0);
+  sunkShips.assign(maxLength + 1, 0);
+  sinkShots.assign(maxLength + 1, 0);
+  bandShots.assign(std::size_t(turnBands) * cellCount, 0);
+  bandHits.assign(std::size_t(turnBands) * cellCount, 0);
+  fired[0] = 0;
+  fired[1] = 0;
+}
+
+int GameStats::getRows() const { return rows; }
+
+int GameStats::getColumns() const { return columns; }
+
+long GameStats::getGames() const { return games; }
+
+long GameStats::getSkipped() const { return skipped; }
+
+void GameStats::startGame() {
+  owner.assign(2 * std::size_t(cellCount), -1);
+  shipLength.clear();
+  firstHit.clear();
+  fired[0] = 0;
+  fired[1] = 0;
+}
+
+void GameStats::addShip(int player, const Ship &ship) {
+  int length = ship.length();
+  if (length < 1 || length > maxLength) {
+    return;
+  }
+
+  GridArea area = ship.occupiedCells();
+  for (GridArea::Iterator posIt = area.begin(); posIt != area.end();
+       ++posIt) {
+    int rowIdx = (*posIt).getRow() - 'A';
+    int colIdx = (*posIt).getColumn() - 1;
+    if (rowIdx >= 0 && rowIdx < rows && colIdx >= 0 && colIdx < columns) {
+      int cell = rowIdx * columns + colIdx;
+      placement[std::size_t(length) * cellCount + cell]++;
+      owner[player * cellCount + cell] = int(shipLength.size());
+    }
+  }
+  shipLength.push_back(length);
+  firstHit.push_back(-1);
+}
+
+/**
+ * 'cell' is -1 for a shot off the grid: it still uses up a turn, but there
+ * is no square to count it on.
+ */
+void GameStats::addShot(int shooter, int cell, Shot::Impact impact) {
+  int turn = ++fired[shooter];
+  if (cell < 0 || cell >= cellCount) {
+    return;
+  }
+
+  int band = (turn - 1) / TURN_BAND;
+  band = (band < turnBands) ? band : turnBands - 1;
+  bandShots[std::size_t(band) * cellCount + cell]++;
+  if (impact != Shot::NONE) {
+    bandHits[std::size_t(band) * cellCount + cell]++;
+  }
+
+  int ship = owner[(1 - shooter) * cellCount + cell];
+  if (ship < 0) {
+    return;
+  }
+  if (firstHit[ship] < 0) {
+    firstHit[ship] = turn;
+  }
+  if (impact == Shot::SUNKEN) {
+    sunkShips[shipLength[ship]]++;
+    sinkShots[shipLength[ship]] += turn - firstHit[ship] + 1;
+  }
+}
+
+/**
+ * Uses the impacts stored in the log, so nothing has to be replayed.
+ */
+bool GameStats::addGame(const GameRecord &game) {
+  if (game.getRows() != rows || game.getColumns() != columns) {
+    skipped++;
+    return false;
+  }
+
+  startGame();
+  for (int player = 0; player < 2; player++) {
+    for (int shipIdx = 0; shipIdx < game.getShipCount(player); shipIdx++) {
+      addShip(player, game.getShip(player, shipIdx));
+    }
+  }
+
+  uint32_t shotCount = game.getShotCount();
+  for (uint32_t shotIdx = 0; shotIdx < shotCount; shotIdx++) {
+    GridPosition target = game.getShot(shotIdx).getTargetPosition();
+    int rowIdx = target.getRow() - 'A';
+    int cell = (rowIdx < rows) ? target.toIndex(columns) : -1;
+    addShot(game.getShooter(shotIdx), cell, game.getImpact(shotIdx));
+  }
+  games++;
+  return true;
+}
+
+/**
+ * Reads the squares in place: each one is copied into a small buffer and
+ * handed to GridPosition, so no strings are made.
+ */
+bool GameStats::parseText(const char *text, std::size_t length) {
+  textFleets[0].clear();
+  textFleets[1].clear();
+  textShots.clear();
+
+  int section = 0; // 0, 1 = fleets, 2 = shots
+  GridPosition bow;
+  bool haveBow = false;
+  std::size_t pos = 0;
+  while (pos < length) {
+    char next = text[pos];
+    if (next == ' ' || next == '\t' || next == '\r' || next == '\n') {
+      pos++;
+      continue;
+    }
+    if (next == ';') {
+      if (haveBow || section == 2) {
+        return false;
+      }
+      section++;
+      pos++;
+      continue;
+    }
+
+    char square[8];
+    std::size_t squareLength = 0;
+    while (pos < length && text[pos] != ' ' && text[pos] != '\t' &&
+           text[pos] != '\r' && text[pos] != '\n' && text[pos] != ';') {
+      if (squareLength + 1 >= sizeof(square)) {
+        return false;
+      }
+      square[squareLength++] = text[pos++];
+    }
+    square[squareLength] = '\0';
+
+    GridPosition position(square);
+    if (!position.isValid()) {
+      return false;
+    }
+    if (section == 2) {
+      textShots.push_back(position);
+    } else if (haveBow) {
+      textFleets[section].push_back(Ship(bow, position));
+      haveBow = false;
+    } else {
+      bow = position;
+      haveBow = true;
+    }
+  }
+  return section == 2;
+}
+
+/**
+ * The impacts aren't in the text, so the fleets are placed on two OwnGrids
+ * (which also checks that they are legal) and every shot is fired at them.
+ */
+bool GameStats::addTextGame(const std::string &line) {
+  if (!parseText(line.data(), line.size())) {
+    skipped++;
+    return false;
+  }
+
+  OwnGrid grids[2] = {OwnGrid(rows, columns), OwnGrid(rows, columns)};
+  for (int player = 0; player < 2; player++) {
+    for (std::vector<Ship>::const_iterator shipIt =
+             textFleets[player].begin();
+         shipIt != textFleets[player].end(); ++shipIt) {
+      if (!grids[player].placeShip(*shipIt)) {
+        skipped++;
+        return false;
+      }
+    }
+  }
+
+  startGame();
+  for (int player = 0; player < 2; player++) {
+    for (std::vector<Ship>::const_iterator shipIt =
+             textFleets[player].begin();
+         shipIt != textFleets[player].end(); ++shipIt) {
+      addShip(player, *shipIt);
+    }
+  }
+
+  for (std::size_t shotIdx = 0; shotIdx < textShots.size(); shotIdx++) {
+    int shooter = shotIdx % 2;
+    GridPosition target = textShots[shotIdx];
+    Shot::Impact impact = grids[1 - shooter].takeBlow(Shot(target));
+    int rowIdx = target.getRow() - 'A';
+    int colIdx = target.getColumn() - 1;
+    bool onGrid = rowIdx < rows && colIdx < columns;
+    addShot(shooter, onGrid ? target.toIndex(columns) : -1, impact);
+  }
+  games++;
+  return true;
+}
+
+bool GameStats::merge(const GameStats &other) {
+  if (other.rows != rows || other.columns != columns) {
+    return false;
+  }
+
+  games += other.games;
+  skipped += other.skipped;
+  for (std::size_t idx = 0; idx < placement.size(); idx++) {
+    placement[idx] += other.placement[idx];
+  }
+  for (std::size_t idx = 0; idx < sunkShips.size(); idx++) {
+    sunkShips[idx] += other.sunkShips[idx];
+    sinkShots[idx] += other.sinkShots[idx];
+  }
+  for (std::size_t idx = 0; idx < bandShots.size(); idx++) {
+    bandShots[idx] += other.bandShots[idx];
+    bandHits[idx] += other.bandHits[idx];
+  }
+  return true;
+}
+
+long GameStats::getPlacementCount(int length,
+                                  const GridPosition &position) const {
+  int rowIdx = position.getRow() - 'A';
+  int colIdx = position.getColumn() - 1;
+  if (length < 1 || length > maxLength || rowIdx < 0 || rowIdx >= rows ||
+      colIdx < 0 || colIdx >= columns) {
+    return 0;
+  }
+  return placement[std::size_t(length) * cellCount + rowIdx * columns +
+                   colIdx];
+}
+
+long GameStats::getSunkShips(int length) const {
+  return (length >= 1 && length <= maxLength) ? sunkShips[length] : 0;
+}
+
+double GameStats::getMeanShotsToSink(int length) const {
+  long sunk = getSunkShips(length);
+  return (sunk > 0) ? double(sinkShots[length]) / sunk : 0;
+}
+
+long GameStats::getBandShots(int band, const GridPosition &position) const {
+  int rowIdx = position.getRow() - 'A';
+  int colIdx = position.getColumn() - 1;
+  if (band < 0 || band >= turnBands || rowIdx < 0 || rowIdx >= rows ||
+      colIdx < 0 || colIdx >= columns) {
+    return 0;
+  }
+  return bandShots[std::size_t(band) * cellCount + rowIdx * columns + colIdx];
+}
+
+long GameStats::getBandHits(int band, const GridPosition &position) const {
+  int rowIdx = position.getRow() - 'A';
+  int colIdx = position.getColumn() - 1;
+  if (band < 0 || band >= turnBands || rowIdx < 0 || rowIdx >= rows ||
+      colIdx < 0 || colIdx >= columns) {
+    return 0;
+  }
+  return bandHits[std::size_t(band) * cellCount + rowIdx * columns + colIdx];
+}
+
+/**
+ * Lengths that never showed up are left out, so the file only has the ship
+ * types that were actually used.
+ */
+void GameStats::writePlacementCsv(std::ostream &out) const {
+  out << "length,row";
+  for (int col = 1; col <= columns; col++) {
+    out << ',' << col;
+  }
+  out << '\n';
+
+  for (int length = 1; length <= maxLength; length++) {
+    const long *counts = &placement[std::size_t(length) * cellCount];
+    bool used = false;
+    for (int cell = 0; cell < cellCount && !used; cell++) {
+      used = counts[cell] > 0;
+    }
+    if (!used) {
+      continue;
+    }
+
+    for (int rowIdx = 0; rowIdx < rows; rowIdx++) {
+      out << length << ',' << char('A' + rowIdx);
+      for (int colIdx = 0; colIdx < columns; colIdx++) {
+        out << ',';
+        writeRatio(out, counts[rowIdx * columns + colIdx], 2 * games);
+      }
+      out << '\n';
+    }
+  }
+}
+
+void GameStats::writeSinkCsv(std::ostream &out) const {
+  out << "length,sunk,mean_shots_to_sink\n";
+  for (int length = 1; length <= maxLength; length++) {
+    if (sunkShips[length] > 0) {
+      out << length << ',' << sunkShips[length] << ',';
+      writeRatio(out, sinkShots[length], sunkShips[length]);
+      out << '\n';
+    }
+  }
+}
+
+/**
+ * The last band also holds every later turn (repeated shots can make a
+ * game longer than the number of squares), so it is labelled "91+".
+ */
+void GameStats::writeHitRateCsv(std::ostream &out) const {
+  out << "turns,row";
+  for (int col = 1; col <= columns; col++) {
+    out << ',' << col;
+  }
+  out << '\n';
+
+  for (int band = 0; band < turnBands; band++) {
+    const long *shots = &bandShots[std::size_t(band) * cellCount];
+    const long *hits = &bandHits[std::size_t(band) * cellCount];
+    long total = 0;
+    for (int cell = 0; cell < cellCount; cell++) {
+      total += shots[cell];
+    }
+    if (total == 0) {
+      continue;
+    }
+
+    for (int rowIdx = 0; rowIdx < rows; rowIdx++) {
+      out << band * TURN_BAND + 1;
+      if (band + 1 < turnBands) {
+        out << '-' << (band + 1) * TURN_BAND;
+      } else {
+        out << '+';
+      }
+      out << ',' << char('A' + rowIdx);
+      for (int colIdx = 0; colIdx < columns; colIdx++) {
+        int cell = rowIdx * columns + colIdx;
+        out << ',';
+        writeRatio(out, hits[cell], shots[cell]);
+      }
+      out << '\n';
+    }
+  }
+}
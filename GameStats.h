@@ -0,0 +1,178 @@
+/**
+ * @file GameStats.h
+ * @brief Header for the GameStats class.
+ *
+ * Counts where ships get placed and where shots hit, over many recorded
+ * games.
+ */
+
+#ifndef GAMESTATS_H_
+#define GAMESTATS_H_
+
+#include "GameLog.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @class GameStats
+ * @brief Histograms over many games played on boards of one size.
+ *
+ * Three things are counted:
+ *   - placement: for every ship length, how often each square was covered
+ *     by a ship of that length
+ *   - sinking: how many ships of each length went down, and how many shots
+ *     it took from the first hit on a ship to its sinking
+ *   - hit rate: for every square and every band of TURN_BAND turns, how
+ *     many shots landed there and how many of them hit
+ *
+ * Games can come from a game log (GameRecord) or from a line of text like
+ * "B2 B4 D1 D5 ; A1 A2 ; B3 A1 B2". Its three parts are player 0's
+ * fleet (bow and stern of every ship), player 1's fleet, and the shots, in
+ * turns with player 0 firing first. The impacts of text games are worked
+ * out by placing the fleets on an OwnGrid.
+ *
+ * All counters are plain numbers in fixed-size arrays, so the memory use
+ * doesn't grow with the number of games. Two GameStats of the same size can
+ * be added together with merge(), so each thread can count on its own.
+ */
+class GameStats {
+public:
+  static constexpr int TURN_BAND = 10; ///< Turns per row of the hit rate CSV
+
+private:
+  int rows;        ///< Height of the boards
+  int columns;     ///< Width of the boards
+  int cellCount;   ///< rows * columns
+  int maxLength;   ///< Longest ship that fits, max(rows, columns)
+  int turnBands;   ///< Number of turn bands (later turns join the last)
+  long games;      ///< Games counted
+  long skipped;    ///< Games that were the wrong size or couldn't be read
+
+  std::vector<long> placement;  ///< [length * cellCount + cell]
+  std::vector<long> sunkShips;  ///< [length] ships sunk
+  std::vector<long> sinkShots;  ///< [length] total shots from hit to sink
+  std::vector<long> bandShots;  ///< [band * cellCount + cell] shots fired
+  std::vector<long> bandHits;   ///< [band * cellCount + cell] ... that hit
+
+  // Scratch space for the game being counted
+  std::vector<int> owner;      ///< [player * cellCount + cell] ship, -1 = water
+  std::vector<int> shipLength; ///< Length of every ship of both fleets
+  std::vector<int> firstHit;   ///< Shot number of each ship's first hit
+  int fired[2];                ///< Shots fired by each player so far
+  std::vector<Ship> textFleets[2]; ///< Fleets of the text game being read
+  std::vector<GridPosition> textShots; ///< Shots of the text game
+
+  /**
+   * @brief Clear the scratch space for a new game.
+   */
+  void startGame();
+
+  /**
+   * @brief Count one ship of a player's fleet.
+   */
+  void addShip(int player, const Ship &ship);
+
+  /**
+   * @brief Count one shot.
+   */
+  void addShot(int shooter, int cell, Shot::Impact impact);
+
+  /**
+   * @brief Split a text game into 'textFleets' and 'textShots'.
+   * @return False if a square can't be read or a bow has no stern.
+   */
+  bool parseText(const char *text, std::size_t length);
+
+public:
+  /**
+   * @brief Empty histograms for boards of rows x columns.
+   */
+  GameStats(int rows, int columns);
+
+  /**
+   * @brief Get height of the boards.
+   */
+  int getRows() const;
+
+  /**
+   * @brief Get width of the boards.
+   */
+  int getColumns() const;
+
+  /**
+   * @brief Number of games counted.
+   */
+  long getGames() const;
+
+  /**
+   * @brief Number of games left out (other board size, broken text or an
+   * illegal fleet).
+   */
+  long getSkipped() const;
+
+  /**
+   * @brief Count a game from a game log.
+   * @return False if it was left out.
+   */
+  bool addGame(const GameRecord &game);
+
+  /**
+   * @brief Count a game written as text (see the class description).
+   * @return False if it was left out.
+   */
+  bool addTextGame(const std::string &line);
+
+  /**
+   * @brief Add the counts of another GameStats of the same size.
+   * @return False (and nothing added) if the sizes differ.
+   */
+  bool merge(const GameStats &other);
+
+  /**
+   * @brief How often a ship of 'length' covered the square, over all
+   * counted fleets (two per game).
+   */
+  long getPlacementCount(int length, const GridPosition &position) const;
+
+  /**
+   * @brief Ships of 'length' that were sunk.
+   */
+  long getSunkShips(int length) const;
+
+  /**
+   * @brief Average shots from the first hit on a ship of 'length' until
+   * it sank (the sinking shot included), 0 if none sank.
+   */
+  double getMeanShotsToSink(int length) const;
+
+  /**
+   * @brief Shots that landed on the square during turns
+   * band * TURN_BAND + 1 .. (band + 1) * TURN_BAND.
+   */
+  long getBandShots(int band, const GridPosition &position) const;
+
+  /**
+   * @brief ... and how many of them hit a ship.
+   */
+  long getBandHits(int band, const GridPosition &position) const;
+
+  /**
+   * @brief Placement heatmap as CSV: one line per ship length and row,
+   * "length,row,<share of fleets for every column>".
+   */
+  void writePlacementCsv(std::ostream &out) const;
+
+  /**
+   * @brief Sinking table as CSV: "length,sunk,mean_shots_to_sink".
+   */
+  void writeSinkCsv(std::ostream &out) const;
+
+  /**
+   * @brief Hit rate heatmap as CSV: one line per turn band and row,
+   * "turns,row,<hits / shots for every column>" (empty if no shots).
+   */
+  void writeHitRateCsv(std::ostream &out) const;
+};
+
+#endif /* GAMESTATS_H_ */
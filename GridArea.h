@@ -0,0 +1,124 @@
+/**
+ * @file GridArea.h
+ * @brief Header for the GridArea class.
+ *
+ * A rectangle of grid positions that can be walked with a range-based for
+ * loop without building a container first.
+ */
+
+#ifndef GRIDAREA_H_
+#define GRIDAREA_H_
+
+#include "GridPosition.h"
+#include <cstddef>
+#include <iterator>
+
+/**
+ * @class GridArea
+ * @brief A rectangular block of squares, from a top-left to a bottom-right
+ * corner (both included).
+ *
+ * A ship's occupied area is a 1-wide rectangle and its blocked area is that
+ * rectangle grown by one square on every side, so both can be described by
+ * four numbers. Walking the area visits the squares in the same order as a
+ * std::set<GridPosition> would (top-to-bottom, then left-to-right).
+ */
+class GridArea {
+private:
+  int firstRow;    ///< Top row (as a letter code, may be outside 'A'..'Z')
+  int lastRow;     ///< Bottom row
+  int firstColumn; ///< Left column (may be 0 or past the board edge)
+  int lastColumn;  ///< Right column
+
+public:
+  /**
+   * @class Iterator
+   * @brief Steps through the area row by row, creating each position on the
+   * fly.
+   */
+  class Iterator {
+  private:
+    int row;         ///< Current row
+    int column;      ///< Current column
+    int firstColumn; ///< Where each new row starts
+    int lastColumn;  ///< Where each row ends
+
+  public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef GridPosition value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const GridPosition *pointer;
+    typedef GridPosition reference;
+
+    constexpr Iterator(int row, int column, int firstColumn, int lastColumn)
+        : row(row), column(column), firstColumn(firstColumn),
+          lastColumn(lastColumn) {}
+
+    constexpr GridPosition operator*() const {
+      return GridPosition(char(row), column);
+    }
+
+    constexpr Iterator &operator++() {
+      if (column < lastColumn) {
+        column++;
+      } else {
+        column = firstColumn;
+        row++;
+      }
+      return *this;
+    }
+
+    constexpr Iterator operator++(int) {
+      Iterator previous = *this;
+      ++(*this);
+      return previous;
+    }
+
+    constexpr bool operator==(const Iterator &other) const {
+      return row == other.row && column == other.column;
+    }
+
+    constexpr bool operator!=(const Iterator &other) const {
+      return !(*this == other);
+    }
+  };
+
+  /**
+   * @brief Create the area between two corners (both included).
+   */
+  constexpr GridArea(int firstRow, int firstColumn, int lastRow,
+                     int lastColumn)
+      : firstRow(firstRow), lastRow(lastRow), firstColumn(firstColumn),
+        lastColumn(lastColumn) {}
+
+  constexpr Iterator begin() const {
+    return Iterator(firstRow, firstColumn, firstColumn, lastColumn);
+  }
+
+  constexpr Iterator end() const {
+    return Iterator(lastRow + 1, firstColumn, firstColumn, lastColumn);
+  }
+
+  /**
+   * @brief How many squares the area covers.
+   */
+  constexpr int size() const {
+    return (lastRow - firstRow + 1) * (lastColumn - firstColumn + 1);
+  }
+
+  /**
+   * @brief Is this position inside the area?
+   */
+  constexpr bool contains(const GridPosition &position) const {
+    return position.getRow() >= firstRow && position.getRow() <= lastRow &&
+           position.getColumn() >= firstColumn &&
+           position.getColumn() <= lastColumn;
+  }
+
+  constexpr char getFirstRow() const { return char(firstRow); }
+  constexpr char getLastRow() const { return char(lastRow); }
+  constexpr int getFirstColumn() const { return firstColumn; }
+  constexpr int getLastColumn() const { return lastColumn; }
+};
+
+#endif /* GRIDAREA_H_ */
@@ -9,6 +9,9 @@
 #ifndef GRIDPOSITION_H_
 #define GRIDPOSITION_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <string>
 
 /**
@@ -17,45 +20,150 @@
  *
  * Each position is immutable (once created, it shouldn't change).
  * It's the most basic building block used to place ships and take shots.
+ *
+ * The row letter and the column number are packed into one 16-bit value
+ * (row in the high byte, column in the low byte), so a position is just 2
+ * bytes. Columns outside 0..255 can't be stored and turn into the invalid
+ * column 0.
  */
 class GridPosition {
 private:
-  char row;   ///< Row letter (e.g., 'A', 'B', etc.)
-  int column; ///< Column number (e.g., 1, 2, 3, etc.)
+  uint16_t cell; ///< Row letter (high byte) and column number (low byte)
+
+  /**
+   * @brief Pack a row letter and a column number into one value.
+   */
+  static constexpr uint16_t pack(char row, int column) {
+    return uint16_t((static_cast<unsigned char>(row) << 8) |
+                    ((column >= 0 && column <= 255) ? column : 0));
+  }
+
+  /**
+   * @brief Turn text like "B10" into a packed value.
+   *
+   * Reads the column the same way 'std::istream >> int' would: leading
+   * whitespace and a sign are allowed, and reading stops at the first
+   * non-digit. Text without a number gives column 0, text shorter than two
+   * characters gives the invalid position '@0'.
+   */
+  static constexpr uint16_t parse(const char *text, std::size_t length) {
+    if (length < 2) {
+      return pack('@', 0);
+    }
+
+    std::size_t pos = 1;
+    while (pos < length && (text[pos] == ' ' || text[pos] == '\t' ||
+                            text[pos] == '\n' || text[pos] == '\v' ||
+                            text[pos] == '\f' || text[pos] == '\r')) {
+      pos++;
+    }
+
+    bool negative = false;
+    if (pos < length && (text[pos] == '+' || text[pos] == '-')) {
+      negative = (text[pos] == '-');
+      pos++;
+    }
+
+    if (pos >= length || text[pos] < '0' || text[pos] > '9') {
+      return pack(text[0], 0); // Not a number at all
+    }
+
+    int column = 0;
+    while (pos < length && text[pos] >= '0' && text[pos] <= '9') {
+      // Anything above 255 is out of range anyway, so stop growing there
+      if (column <= 255) {
+        column = column * 10 + (text[pos] - '0');
+      }
+      pos++;
+    }
+
+    return pack(text[0], negative ? -column : column);
+  }
+
+  /**
+   * @brief Length of a C string (std::strlen isn't constexpr).
+   */
+  static constexpr std::size_t textLength(const char *text) {
+    std::size_t length = 0;
+    while (text[length] != '\0') {
+      length++;
+    }
+    return length;
+  }
 
 public:
   /**
    * @brief Default constructor (creates an invalid position '0').
    * Needed so we can create empty GridPositions before assigning them.
    */
-  GridPosition();
+  constexpr GridPosition() : cell(0) {}
 
   /**
    * Basic constructor that just sets the row letter and column number directly.
    */
-  GridPosition(char row, int column);
+  constexpr GridPosition(char row, int column) : cell(pack(row, column)) {}
+
+  /**
+   * @brief Build a position from a literal like "B10", even at compile time.
+   * @param position Text representation of the coordinate.
+   */
+  constexpr GridPosition(const char *position)
+      : cell(parse(position, textLength(position))) {}
 
   /**
    * @brief Build a position from a string like "B10".
    * @param position String representation of the coordinate.
    */
-  GridPosition(std::string position);
+  GridPosition(const std::string &position)
+      : cell(parse(position.data(), position.size())) {}
+
+  /**
+   * @brief Rebuild a position from the value returned by getPacked().
+   */
+  static constexpr GridPosition fromPacked(uint16_t packed) {
+    GridPosition position;
+    position.cell = packed;
+    return position;
+  }
+
+  /**
+   * @brief Rebuild a position from its row-major index on a grid that is
+   * 'columns' wide (the inverse of toIndex()).
+   */
+  static constexpr GridPosition fromIndex(int index, int columns) {
+    return GridPosition(char('A' + index / columns), index % columns + 1);
+  }
 
   /**
    * @brief Is this position actually a legal spot on a board?
    * @return True if row is A-Z and column > 0.
    */
-  bool isValid() const;
+  constexpr bool isValid() const {
+    return getRow() >= 'A' && getRow() <= 'Z' && getColumn() > 0;
+  }
 
   /**
    * @brief Get the row letter.
    */
-  char getRow() const;
+  constexpr char getRow() const { return char(cell >> 8); }
 
   /**
    * @brief Get the column number.
    */
-  int getColumn() const;
+  constexpr int getColumn() const { return cell & 0xFF; }
+
+  /**
+   * @brief Get the packed 16-bit value (row in the high byte).
+   */
+  constexpr uint16_t getPacked() const { return cell; }
+
+  /**
+   * @brief Get the row-major index of this position on a grid that is
+   * 'columns' wide (A1 is 0, A2 is 1, ...). No bounds check is done.
+   */
+  constexpr int toIndex(int columns) const {
+    return (getRow() - 'A') * columns + (getColumn() - 1);
+  }
 
   /**
    * @brief Let the computer treat this object like a string (e.g., "A1").
@@ -65,14 +173,39 @@ public:
   /**
    * @brief Check if this position is the same as another.
    */
-  bool operator==(const GridPosition &other) const;
+  constexpr bool operator==(const GridPosition &other) const {
+    return cell == other.cell;
+  }
+
+  /**
+   * @brief Check if this position is different from another.
+   */
+  constexpr bool operator!=(const GridPosition &other) const {
+    return cell != other.cell;
+  }
 
   /**
    * @brief Comparison tool needed so we can put positions in a 'set' or 'map'.
    *
-   * It sorts coordinates from top-to-bottom and left-to-right.
+   * It sorts coordinates from top-to-bottom and left-to-right. Because the row
+   * sits in the high byte, comparing the packed values does exactly that.
    */
-  bool operator<(const GridPosition &other) const;
+  constexpr bool operator<(const GridPosition &other) const {
+    return cell < other.cell;
+  }
+};
+
+/**
+ * @brief Lets GridPosition be used as a key in unordered containers.
+ *
+ * The packed value is already unique per position, so it is the hash.
+ */
+namespace std {
+template <> struct hash<GridPosition> {
+  size_t operator()(const GridPosition &position) const {
+    return position.getPacked();
+  }
 };
+} // namespace std
 
 #endif /* GRIDPOSITION_H_ */
@@ -0,0 +1,93 @@
+/**
+ * @file LargeOpponentGrid.cpp
+ * @brief Implementation of the LargeOpponentGrid class.
+ *
+ * The same deduction as OpponentGrid.cpp, with a hash table instead of one
+ * byte per square.
+ */
+
+#include "LargeOpponentGrid.h"
+
+LargeOpponentGrid::LargeOpponentGrid(int rows, int columns) {
+  this->rows = rows;
+  this->columns = columns;
+}
+
+int LargeOpponentGrid::getRows() const { return rows; }
+
+int LargeOpponentGrid::getColumns() const { return columns; }
+
+bool LargeOpponentGrid::isShipSegment(int row, int column) const {
+  if (row < 1 || row > rows || column < 1 || column > columns) {
+    return false;
+  }
+  std::unordered_map<uint64_t, unsigned char>::const_iterator stateIt =
+      cellStates.find(LargePosition(row, column).toIndex(columns));
+  return stateIt != cellStates.end() &&
+         (stateIt->second == OpponentGrid::HIT ||
+          stateIt->second == OpponentGrid::SUNK);
+}
+
+/**
+ * Records the shot, and on a sink walks left and right (or, if there is
+ * nothing sideways, up and down) over our hits to find both ends of the
+ * ship. A ship is at most 5 squares long, so that's a handful of lookups.
+ */
+void LargeOpponentGrid::shotResult(const LargePosition &target,
+                                   Shot::Impact impact) {
+  int row = target.getRow();
+  int column = target.getColumn();
+  if (row < 1 || row > rows || column < 1 || column > columns) {
+    return;
+  }
+  cellStates[target.toIndex(columns)] = impact + 1;
+
+  if (impact != Shot::SUNKEN) {
+    return;
+  }
+
+  int firstColumn = column;
+  int lastColumn = column;
+  while (isShipSegment(row, firstColumn - 1)) {
+    firstColumn--;
+  }
+  while (isShipSegment(row, lastColumn + 1)) {
+    lastColumn++;
+  }
+
+  int firstRow = row;
+  int lastRow = row;
+  if (firstColumn == column && lastColumn == column) {
+    while (isShipSegment(firstRow - 1, column)) {
+      firstRow--;
+    }
+    while (isShipSegment(lastRow + 1, column)) {
+      lastRow++;
+    }
+  }
+
+  sunkenShips.push_back(LargeShip(LargePosition(firstRow, firstColumn),
+                                  LargePosition(lastRow, lastColumn)));
+}
+
+OpponentGrid::CellState
+LargeOpponentGrid::getCellState(const LargePosition &position) const {
+  if (position.getRow() < 1 || position.getRow() > rows ||
+      position.getColumn() < 1 || position.getColumn() > columns) {
+    return OpponentGrid::UNKNOWN;
+  }
+  std::unordered_map<uint64_t, unsigned char>::const_iterator stateIt =
+      cellStates.find(position.toIndex(columns));
+  if (stateIt == cellStates.end()) {
+    return OpponentGrid::UNKNOWN;
+  }
+  return OpponentGrid::CellState(stateIt->second);
+}
+
+std::size_t LargeOpponentGrid::getShotCount() const {
+  return cellStates.size();
+}
+
+const std::vector<LargeShip> &LargeOpponentGrid::getSunkenShips() const {
+  return sunkenShips;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file LargeOpponentGrid.h
+ * @brief Header for the LargeOpponentGrid class.
+ *
+ * Our record of the opponent's side of a large board.
+ */
+
+#ifndef LARGEOPPONENTGRID_H_
+#define LARGEOPPONENTGRID_H_
+
+#include "LargeShip.h"
+#include "OpponentGrid.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class LargeOpponentGrid
+ * @brief Works like OpponentGrid, but for boards with any number of rows.
+ *
+ * Only the squares we fired at are stored (in a hash table), so memory grows
+ * with the number of shots, not with the size of the board. Squares we never
+ * fired at are UNKNOWN. Shots off the grid are ignored.
+ */
+class LargeOpponentGrid {
+private:
+  int rows;    ///< Height of the grid
+  int columns; ///< Width of the grid
+
+  /// CellState of every square we fired at, by square index
+  std::unordered_map<uint64_t, unsigned char> cellStates;
+  std::vector<LargeShip> sunkenShips; ///< Ships we've successfully destroyed
+
+  /**
+   * @brief Is this square a ship segment we have already hit or sunk?
+   */
+  bool isShipSegment(int row, int column) const;
+
+public:
+  /**
+   * @brief Create a grid to track an opponent of a certain size.
+   */
+  LargeOpponentGrid(int rows, int columns);
+
+  /**
+   * @brief Get height of the board.
+   */
+  int getRows() const;
+
+  /**
+   * @brief Get width of the board.
+   */
+  int getColumns() const;
+
+  /**
+   * @brief Call this after firing a shot to record what happened.
+   *
+   * On SUNKEN the ship is pieced together from the hits next to the target,
+   * just like OpponentGrid::shotResult() does.
+   */
+  void shotResult(const LargePosition &target, Shot::Impact impact);
+
+  /**
+   * @brief What do we know about this square? UNKNOWN if it's off the grid.
+   */
+  OpponentGrid::CellState getCellState(const LargePosition &position) const;
+
+  /**
+   * @brief Number of different squares we fired at.
+   */
+  std::size_t getShotCount() const;
+
+  /**
+   * @brief Get the list of all opponent ships we've sunk.
+   */
+  const std::vector<LargeShip> &getSunkenShips() const;
+};
+
+#endif /* LARGEOPPONENTGRID_H_ */
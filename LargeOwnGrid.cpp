@@ -0,0 +1,142 @@
+/**
+ * @file LargeOwnGrid.cpp
+ * @brief Implementation of the LargeOwnGrid class.
+ *
+ * The same rules as OwnGrid.cpp, with hash tables instead of bitboards.
+ */
+
+#include "LargeOwnGrid.h"
+
+/**
+ * Creates the grid and sets the initial fleet limits (1x5, 2x4, 3x3, 4x2).
+ */
+LargeOwnGrid::LargeOwnGrid(int rows, int columns) {
+  this->rows = rows;
+  this->columns = columns;
+
+  availableShips[5] = 1;
+  availableShips[4] = 2;
+  availableShips[3] = 3;
+  availableShips[2] = 4;
+
+  // Room for the whole fleet, so placing ships never has to rehash
+  int fleetSize = 0;
+  int fleetSquares = 0;
+  for (std::map<int, int>::const_iterator countIt = availableShips.begin();
+       countIt != availableShips.end(); ++countIt) {
+    fleetSize += countIt->second;
+    fleetSquares += countIt->first * countIt->second;
+  }
+  ships.reserve(fleetSize);
+  shipHits.reserve(fleetSize);
+  cellOwner.reserve(fleetSquares);
+}
+
+int LargeOwnGrid::getRows() const { return rows; }
+
+int LargeOwnGrid::getColumns() const { return columns; }
+
+bool LargeOwnGrid::contains(const LargePosition &position) const {
+  return position.getRow() >= 1 && position.getRow() <= rows &&
+         position.getColumn() >= 1 && position.getColumn() <= columns;
+}
+
+/**
+ * Same checks as OwnGrid::canPlaceShip(). For "no touching" we look at the
+ * ship's squares plus the ring around it (at most 21 squares) and ask the
+ * owner table whether any of them already belongs to a ship.
+ */
+bool LargeOwnGrid::canPlaceShip(const LargeShip &ship) const {
+  if (!ship.isValid()) {
+    return false;
+  }
+
+  std::map<int, int>::const_iterator countIt =
+      availableShips.find(ship.length());
+  if (countIt == availableShips.end() || countIt->second <= 0) {
+    return false;
+  }
+
+  if (!contains(ship.getBow()) || !contains(ship.getStern())) {
+    return false; // Out of bounds
+  }
+
+  for (int row = ship.getFirstRow() - 1; row <= ship.getLastRow() + 1; row++) {
+    for (int col = ship.getFirstColumn() - 1; col <= ship.getLastColumn() + 1;
+         col++) {
+      LargePosition position(row, col);
+      if (contains(position) &&
+          cellOwner.count(position.toIndex(columns)) > 0) {
+        return false; // Too close to another ship!
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Like OwnGrid::placeShip(), squares that were shot at before the ship
+ * arrived count as hits on it right away.
+ */
+bool LargeOwnGrid::placeShip(const LargeShip &ship) {
+  if (!canPlaceShip(ship)) {
+    return false;
+  }
+
+  int slot = ships.size();
+  int earlierHits = 0; // Shots that landed here before the ship was placed
+  for (int row = ship.getFirstRow(); row <= ship.getLastRow(); row++) {
+    for (int col = ship.getFirstColumn(); col <= ship.getLastColumn(); col++) {
+      uint64_t idx = LargePosition(row, col).toIndex(columns);
+      cellOwner[idx] = slot;
+      if (shotAt.count(idx) > 0) {
+        earlierHits++;
+      }
+    }
+  }
+
+  ships.push_back(ship);
+  shipHits.push_back(earlierHits);
+  availableShips[ship.length()]--;
+  return true;
+}
+
+const std::vector<LargeShip> &LargeOwnGrid::getShips() const { return ships; }
+
+/**
+ * One hash insert to remember the shot (it tells us if the square is new),
+ * one hash lookup to find the ship.
+ */
+Shot::Impact LargeOwnGrid::takeBlow(const LargePosition &target) {
+  if (!contains(target)) {
+    return Shot::NONE;
+  }
+
+  uint64_t idx = target.toIndex(columns);
+  bool firstShot = shotAt.insert(idx).second;
+
+  std::unordered_map<uint64_t, int>::const_iterator ownerIt =
+      cellOwner.find(idx);
+  if (ownerIt == cellOwner.end()) {
+    return Shot::NONE;
+  }
+
+  int slot = ownerIt->second;
+  if (firstShot) {
+    shipHits[slot]++;
+  }
+  if (shipHits[slot] == ships[slot].length()) {
+    return Shot::SUNKEN;
+  }
+  return Shot::HIT;
+}
+
+bool LargeOwnGrid::isShotAt(const LargePosition &position) const {
+  return contains(position) && shotAt.count(position.toIndex(columns)) > 0;
+}
+
+std::size_t LargeOwnGrid::getShotCount() const { return shotAt.size(); }
+
+const std::map<int, int> &LargeOwnGrid::getAvailableShips() const {
+  return availableShips;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file LargeOwnGrid.h
+ * @brief Header for the LargeOwnGrid class.
+ *
+ * Our own side of a large (even 1000x1000 or bigger) board.
+ */
+
+#ifndef LARGEOWNGRID_H_
+#define LARGEOWNGRID_H_
+
+#include "LargeShip.h"
+#include "Shot.h"
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @class LargeOwnGrid
+ * @brief Works like OwnGrid, but for boards with any number of rows.
+ *
+ * OwnGrid keeps one bit (and one owner entry) for every square, which is
+ * fine for 10x10 but not for a million squares. This grid only stores the
+ * squares that matter: the ones covered by ships and the ones that were
+ * shot at, in hash tables. So memory grows with the number of ships and
+ * shots, not with the size of the board, and placing a ship or answering a
+ * shot takes the same (amortized constant) time on any board.
+ *
+ * The fleet rules are the same as on a normal board. Shots that land off the
+ * grid miss and are not remembered.
+ */
+class LargeOwnGrid {
+private:
+  int rows;    ///< Total rows
+  int columns; ///< Total columns
+
+  std::vector<LargeShip> ships;      ///< Our placed fleet
+  std::vector<int> shipHits;         ///< Distinct hits taken by each ship
+  std::map<int, int> availableShips; ///< How many of each ship type are left
+
+  // Square index = (row - 1) * columns + (column - 1)
+  std::unordered_map<uint64_t, int> cellOwner; ///< Index into 'ships'
+  std::unordered_set<uint64_t> shotAt; ///< Squares the opponent shot at
+
+  /**
+   * @brief Is this position on the grid?
+   */
+  bool contains(const LargePosition &position) const;
+
+public:
+  /**
+   * @brief Create a grid with specific dimensions and the standard fleet.
+   */
+  LargeOwnGrid(int rows, int columns);
+
+  /**
+   * @brief Get height of the board.
+   */
+  int getRows() const;
+
+  /**
+   * @brief Get width of the board.
+   */
+  int getColumns() const;
+
+  /**
+   * @brief Check if a ship could be placed, without placing it.
+   */
+  bool canPlaceShip(const LargeShip &ship) const;
+
+  /**
+   * @brief Try to place a ship on the board.
+   * @return True if placement was legal and successful.
+   */
+  bool placeShip(const LargeShip &ship);
+
+  /**
+   * @brief Get the list of all our placed ships.
+   */
+  const std::vector<LargeShip> &getShips() const;
+
+  /**
+   * @brief Process a shot from the opponent.
+   *
+   * Shooting the same square twice doesn't count as a second hit.
+   * @return NONE, HIT, or SUNKEN.
+   */
+  Shot::Impact takeBlow(const LargePosition &target);
+
+  /**
+   * @brief Has the opponent shot at this square?
+   */
+  bool isShotAt(const LargePosition &position) const;
+
+  /**
+   * @brief Number of different squares the opponent has shot at.
+   */
+  std::size_t getShotCount() const;
+
+  /**
+   * @brief How many ships of each length (key) are still left to place.
+   */
+  const std::map<int, int> &getAvailableShips() const;
+};
+
+#endif /* LARGEOWNGRID_H_ */
@@ -0,0 +1,105 @@
+/**
+ * @file LargePosition.cpp
+ * @brief Implementation of the LargePosition class.
+ *
+ * Mostly about turning row numbers into letters and back.
+ */
+
+#include "LargePosition.h"
+
+LargePosition::LargePosition() {
+  this->row = 0;
+  this->column = 0;
+}
+
+LargePosition::LargePosition(int row, int column) {
+  this->row = row;
+  this->column = column;
+}
+
+/**
+ * Reads the row letters as a number in "base 26 without a zero": A is 1,
+ * Z is 26, AA is 27. Then the digits of the column follow. Numbers that
+ * would grow past MAX_COORDINATE give an invalid position; that is checked
+ * before multiplying, so the int can't overflow.
+ */
+LargePosition::LargePosition(const std::string &position) {
+  this->row = 0;
+  this->column = 0;
+
+  std::size_t pos = 0;
+  int rowNumber = 0;
+  while (pos < position.size() && position[pos] >= 'A' &&
+         position[pos] <= 'Z') {
+    int letter = position[pos] - 'A' + 1;
+    if (rowNumber > (MAX_COORDINATE - letter) / 26) {
+      return;
+    }
+    rowNumber = rowNumber * 26 + letter;
+    pos++;
+  }
+
+  std::size_t digitsStart = pos;
+  int columnNumber = 0;
+  while (pos < position.size() && position[pos] >= '0' &&
+         position[pos] <= '9') {
+    int digit = position[pos] - '0';
+    if (columnNumber > (MAX_COORDINATE - digit) / 10) {
+      return;
+    }
+    columnNumber = columnNumber * 10 + digit;
+    pos++;
+  }
+
+  if (digitsStart == 0 || pos == digitsStart || pos != position.size()) {
+    return; // No letters, no digits, or something else at the end
+  }
+  this->row = rowNumber;
+  this->column = columnNumber;
+}
+
+bool LargePosition::isValid() const {
+  return row >= 1 && row <= MAX_COORDINATE && column >= 1 &&
+         column <= MAX_COORDINATE;
+}
+
+int LargePosition::getRow() const { return row; }
+
+int LargePosition::getColumn() const { return column; }
+
+uint64_t LargePosition::toIndex(int columns) const {
+  return uint64_t(row - 1) * uint64_t(columns) + uint64_t(column - 1);
+}
+
+/**
+ * Writes the letters from the back: the last letter is (row - 1) % 26, and
+ * what's left over is the row label in front of it.
+ */
+std::string LargePosition::rowLabel(int row) {
+  std::string label;
+  while (row > 0) {
+    row--;
+    label.insert(label.begin(), char('A' + row % 26));
+    row /= 26;
+  }
+  return label;
+}
+
+LargePosition::operator std::string() const {
+  return rowLabel(row) + std::to_string(column);
+}
+
+bool LargePosition::operator==(const LargePosition &other) const {
+  return row == other.row && column == other.column;
+}
+
+bool LargePosition::operator!=(const LargePosition &other) const {
+  return !(*this == other);
+}
+
+bool LargePosition::operator<(const LargePosition &other) const {
+  if (row != other.row) {
+    return row < other.row;
+  }
+  return column < other.column;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file LargePosition.h
+ * @brief Header for the LargePosition class.
+ *
+ * A board coordinate for boards with more than 26 rows.
+ */
+
+#ifndef LARGEPOSITION_H_
+#define LARGEPOSITION_H_
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @class LargePosition
+ * @brief A square on a large board: a row number and a column number.
+ *
+ * GridPosition keeps the row as a single letter, so it stops at row 'Z'.
+ * Here the row is a plain integer (1 is "A"), and it is written with more
+ * letters once the alphabet runs out, like spreadsheet columns:
+ * A..Z, AA..AZ, BA..ZZ, AAA, ... So "AA12" is row 27, column 12.
+ */
+class LargePosition {
+private:
+  int row;    ///< Row number, starting at 1 ("A")
+  int column; ///< Column number, starting at 1
+
+public:
+  static const int MAX_COORDINATE = 1 << 30; ///< Largest row or column
+
+  /**
+   * @brief Default constructor (creates an invalid position).
+   */
+  LargePosition();
+
+  /**
+   * @brief Create a position from a row number and a column number.
+   */
+  LargePosition(int row, int column);
+
+  /**
+   * @brief Build a position from text like "B10" or "AA12".
+   *
+   * The row letters must be upper case. Anything that doesn't look like
+   * letters followed by digits gives an invalid position.
+   */
+  LargePosition(const std::string &position);
+
+  /**
+   * @brief Is this position a legal spot on some board?
+   * @return True if both the row and the column are at least 1.
+   */
+  bool isValid() const;
+
+  /**
+   * @brief Get the row number (1 is "A", 27 is "AA").
+   */
+  int getRow() const;
+
+  /**
+   * @brief Get the column number.
+   */
+  int getColumn() const;
+
+  /**
+   * @brief Get the row-major index of this position on a grid that is
+   * 'columns' wide (A1 is 0, A2 is 1, ...). No bounds check is done.
+   */
+  uint64_t toIndex(int columns) const;
+
+  /**
+   * @brief Turn a row number into its letters ("A", "Z", "AA", ...).
+   */
+  static std::string rowLabel(int row);
+
+  /**
+   * @brief Let the computer treat this object like a string (e.g., "AA12").
+   */
+  operator std::string() const;
+
+  /**
+   * @brief Check if this position is the same as another.
+   */
+  bool operator==(const LargePosition &other) const;
+
+  /**
+   * @brief Check if this position is different from another.
+   */
+  bool operator!=(const LargePosition &other) const;
+
+  /**
+   * @brief Sorts positions from top-to-bottom and left-to-right.
+   */
+  bool operator<(const LargePosition &other) const;
+};
+
+#endif /* LARGEPOSITION_H_ */
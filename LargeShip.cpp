@@ -0,0 +1,55 @@
+/**
+ * @file LargeShip.cpp
+ * @brief Implementation of the LargeShip class.
+ *
+ * The same checks as Ship, only with integer rows.
+ */
+
+#include "LargeShip.h"
+
+LargeShip::LargeShip(const LargePosition &bow, const LargePosition &stern) {
+  this->bow = bow;
+  this->stern = stern;
+}
+
+bool LargeShip::isValid() const {
+  if (!bow.isValid() || !stern.isValid()) {
+    return false;
+  }
+
+  bool isHorizontal = (bow.getRow() == stern.getRow());
+  bool isVertical = (bow.getColumn() == stern.getColumn());
+  if (!isHorizontal && !isVertical) {
+    return false; // No diagonal ships
+  }
+
+  int shipLength = length();
+  return shipLength >= 2 && shipLength <= 5;
+}
+
+LargePosition LargeShip::getBow() const { return bow; }
+
+LargePosition LargeShip::getStern() const { return stern; }
+
+int LargeShip::length() const {
+  return (getLastRow() - getFirstRow()) + (getLastColumn() - getFirstColumn()) +
+         1;
+}
+
+int LargeShip::getFirstRow() const {
+  return (bow.getRow() < stern.getRow()) ? bow.getRow() : stern.getRow();
+}
+
+int LargeShip::getLastRow() const {
+  return (bow.getRow() > stern.getRow()) ? bow.getRow() : stern.getRow();
+}
+
+int LargeShip::getFirstColumn() const {
+  return (bow.getColumn() < stern.getColumn()) ? bow.getColumn()
+                                               : stern.getColumn();
+}
+
+int LargeShip::getLastColumn() const {
+  return (bow.getColumn() > stern.getColumn()) ? bow.getColumn()
+                                               : stern.getColumn();
+}
@@ -0,0 +1,72 @@
+/**
+ * @file LargeShip.h
+ * @brief Header for the LargeShip class.
+ *
+ * A ship on a large board.
+ */
+
+#ifndef LARGESHIP_H_
+#define LARGESHIP_H_
+
+#include "LargePosition.h"
+
+/**
+ * @class LargeShip
+ * @brief The same as a Ship, but with LargePosition ends.
+ *
+ * The rules don't change: a ship is 2 to 5 squares long and lies either
+ * horizontally or vertically.
+ */
+class LargeShip {
+private:
+  LargePosition bow;   ///< The front end of the ship
+  LargePosition stern; ///< The back end of the ship
+
+public:
+  /**
+   * @brief Create a ship between two end points.
+   */
+  LargeShip(const LargePosition &bow, const LargePosition &stern);
+
+  /**
+   * @brief Is the ship straight, 2 to 5 squares long and on some board?
+   */
+  bool isValid() const;
+
+  /**
+   * @brief Get the bow (front) position.
+   */
+  LargePosition getBow() const;
+
+  /**
+   * @brief Get the stern (back) position.
+   */
+  LargePosition getStern() const;
+
+  /**
+   * @brief How many squares the ship covers (only meaningful if valid).
+   */
+  int length() const;
+
+  /**
+   * @brief Top row the ship covers.
+   */
+  int getFirstRow() const;
+
+  /**
+   * @brief Bottom row the ship covers.
+   */
+  int getLastRow() const;
+
+  /**
+   * @brief Left column the ship covers.
+   */
+  int getFirstColumn() const;
+
+  /**
+   * @brief Right column the ship covers.
+   */
+  int getLastColumn() const;
+};
+
+#endif /* LARGESHIP_H_ */
@@ -0,0 +1,191 @@
+/**
+ * @file Metrics.cpp
+ * @brief Implementation of the metrics registry.
+ */
+
+#include "Metrics.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+const char *const COUNTER_NAMES[Metrics::COUNTER_COUNT] = {
+    "place_ok",      "place_invalid_ship", "place_no_inventory",
+    "place_out_of_bounds", "place_too_close",
+    "blow_miss",     "blow_hit",     "blow_sunken",  "blow_repeat",
+    "blow_off_grid", "salvo_shots",  "result_shots", "result_sinks",
+    "view_frames",   "view_live_changes"};
+
+const char *const HISTOGRAM_NAMES[Metrics::HISTOGRAM_COUNT] = {
+    "sink_deduction_ns", "place_ship_ns", "view_render_ns", "view_live_ns"};
+
+/**
+ * Every live thread's block, plus what the finished threads left behind.
+ */
+struct Registry {
+  std::mutex lock;                    ///< Guards everything below
+  std::vector<Metrics::Block *> live; ///< Blocks of running threads
+  Metrics::Snapshot retired;          ///< Sum of finished threads
+};
+
+/**
+ * Made on first use, so it exists before any thread registers with it.
+ */
+Registry &registry() {
+  static Registry instance;
+  return instance;
+}
+
+/**
+ * Add 'value' to 'sum' (a relaxed read is enough: we only need a recent
+ * value, not a consistent one).
+ */
+void addTo(uint64_t &sum, const std::atomic<uint64_t> &value) {
+  sum += value.load(std::memory_order_relaxed);
+}
+
+/**
+ * Add one block to a snapshot.
+ */
+void addBlock(Metrics::Snapshot &sum, const Metrics::Block &block) {
+  for (int counter = 0; counter < Metrics::COUNTER_COUNT; counter++) {
+    addTo(sum.counters[counter], block.counters[counter]);
+  }
+  for (int histogram = 0; histogram < Metrics::HISTOGRAM_COUNT; histogram++) {
+    for (int bucket = 0; bucket < Metrics::BUCKETS; bucket++) {
+      addTo(sum.buckets[histogram][bucket], block.buckets[histogram][bucket]);
+    }
+    addTo(sum.totalNanos[histogram], block.totalNanos[histogram]);
+  }
+}
+
+/**
+ * One per thread: registers the thread's block when the thread first
+ * records something, and hands the numbers over when the thread ends.
+ */
+struct ThreadHandle {
+  Metrics::Block block; ///< This thread's counters
+
+  ThreadHandle() : block() {
+    Registry &shared = registry();
+    std::lock_guard<std::mutex> guard(shared.lock);
+    shared.live.push_back(&block);
+  }
+
+  ~ThreadHandle() {
+    Registry &shared = registry();
+    std::lock_guard<std::mutex> guard(shared.lock);
+    addBlock(shared.retired, block);
+    shared.live.erase(
+        std::find(shared.live.begin(), shared.live.end(), &block));
+  }
+};
+
+} // namespace
+
+Metrics::Block &Metrics::localBlock() {
+  thread_local ThreadHandle handle;
+  return handle.block;
+}
+
+const char *Metrics::counterName(Counter counter) {
+  return COUNTER_NAMES[counter];
+}
+
+const char *Metrics::histogramName(Histogram histogram) {
+  return HISTOGRAM_NAMES[histogram];
+}
+
+uint64_t Metrics::Snapshot::getSamples(Histogram histogram) const {
+  uint64_t samples = 0;
+  for (int bucket = 0; bucket < BUCKETS; bucket++) {
+    samples += buckets[histogram][bucket];
+  }
+  return samples;
+}
+
+double Metrics::Snapshot::getMeanNanos(Histogram histogram) const {
+  uint64_t samples = getSamples(histogram);
+  return (samples > 0) ? double(totalNanos[histogram]) / samples : 0;
+}
+
+/**
+ * Walks the buckets until 'share' of the samples are behind us. The answer
+ * is only as exact as the buckets: within a factor of 2.
+ */
+uint64_t Metrics::Snapshot::getPercentileNanos(Histogram histogram,
+                                               double share) const {
+  uint64_t samples = getSamples(histogram);
+  uint64_t seen = 0;
+  for (int bucket = 0; bucket < BUCKETS; bucket++) {
+    seen += buckets[histogram][bucket];
+    if (samples > 0 && seen >= share * samples) {
+      return (bucket == 0) ? 0 : (uint64_t(1) << bucket) - 1;
+    }
+  }
+  return 0;
+}
+
+Metrics::Snapshot Metrics::snapshot() {
+  Snapshot sum = Snapshot();
+  if (!ENABLED) {
+    return sum;
+  }
+
+  Registry &shared = registry();
+  std::lock_guard<std::mutex> guard(shared.lock);
+  sum = shared.retired;
+  for (std::vector<Block *>::const_iterator blockIt = shared.live.begin();
+       blockIt != shared.live.end(); ++blockIt) {
+    addBlock(sum, **blockIt);
+  }
+  return sum;
+}
+
+void Metrics::reset() {
+  if (!ENABLED) {
+    return;
+  }
+
+  Registry &shared = registry();
+  std::lock_guard<std::mutex> guard(shared.lock);
+  shared.retired = Snapshot();
+  for (std::vector<Block *>::const_iterator blockIt = shared.live.begin();
+       blockIt != shared.live.end(); ++blockIt) {
+    Block &block = **blockIt;
+    for (int counter = 0; counter < COUNTER_COUNT; counter++) {
+      block.counters[counter].store(0, std::memory_order_relaxed);
+    }
+    for (int histogram = 0; histogram < HISTOGRAM_COUNT; histogram++) {
+      for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        block.buckets[histogram][bucket].store(0, std::memory_order_relaxed);
+      }
+      block.totalNanos[histogram].store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+void Metrics::dump(std::ostream &out, const Snapshot &data) {
+  if (!ENABLED) {
+    out << "metrics: not built in (compile with -DBATTLESHIP_METRICS)\n";
+    return;
+  }
+
+  for (int counter = 0; counter < COUNTER_COUNT; counter++) {
+    if (data.counters[counter] > 0) {
+      out << COUNTER_NAMES[counter] << ": " << data.counters[counter]
+          << '\n';
+    }
+  }
+  for (int histogram = 0; histogram < HISTOGRAM_COUNT; histogram++) {
+    Histogram which = Histogram(histogram);
+    uint64_t samples = data.getSamples(which);
+    if (samples > 0) {
+      out << HISTOGRAM_NAMES[histogram] << ": " << samples << " samples, mean "
+          << uint64_t(data.getMeanNanos(which)) << ", p50 <= "
+          << data.getPercentileNanos(which, 0.5) << ", p99 <= "
+          << data.getPercentileNanos(which, 0.99) << '\n';
+    }
+  }
+}
@@ -0,0 +1,225 @@
+/**
+ * @file Metrics.h
+ * @brief Counters and latency histograms for the hot paths of the game.
+ *
+ * Switched off unless the program is built with -DBATTLESHIP_METRICS.
+ */
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief An opt-in registry of counters and histograms.
+ *
+ * Every thread records into its own block of counters, so recording is a
+ * plain load, add and store (no lock, no atomic read-modify-write, no cache
+ * line shared with other threads). snapshot() adds up the blocks of all
+ * threads, including the ones that have already finished.
+ *
+ * Histograms have log2 buckets: bucket 0 holds 0 ns, bucket b holds
+ * 2^(b-1) .. 2^b - 1 ns, and the last bucket holds everything longer.
+ *
+ * Without BATTLESHIP_METRICS, ENABLED is false and add(), record() and
+ * Timer have empty bodies, so the calls (and Timer's clock reads) vanish
+ * even in a debug build. snapshot() and dump() still exist and report
+ * zeros, so code using them builds either way.
+ */
+namespace Metrics {
+
+#ifdef BATTLESHIP_METRICS
+constexpr bool ENABLED = true; ///< Built with metrics
+#else
+constexpr bool ENABLED = false; ///< Built without metrics
+#endif
+
+/**
+ * @brief The things that are counted.
+ */
+enum Counter {
+  PLACE_OK,             ///< OwnGrid::placeShip() placed the ship
+  PLACE_INVALID_SHIP,   ///< ... refused: not straight or bad length
+  PLACE_NO_INVENTORY,   ///< ... refused: no ship of that length left
+  PLACE_OUT_OF_BOUNDS,  ///< ... refused: not on the grid
+  PLACE_TOO_CLOSE,      ///< ... refused: touches or overlaps a ship
+  BLOW_MISS,            ///< OwnGrid::takeBlow() answered NONE
+  BLOW_HIT,             ///< ... answered HIT
+  BLOW_SUNKEN,          ///< ... answered SUNKEN
+  BLOW_REPEAT,          ///< ... the square had been shot at before
+  BLOW_OFF_GRID,        ///< ... the shot was off the grid
+  SALVO_SHOTS,          ///< Shots taken through OwnGrid::takeBlows()
+  RESULT_SHOTS,         ///< Results given to OpponentGrid
+  RESULT_SINKS,         ///< ... of which were sinks (deduction ran)
+  VIEW_FRAMES,          ///< Frames drawn by ConsoleView
+  VIEW_LIVE_CHANGES,    ///< Symbols redrawn by ConsoleView's live view
+  COUNTER_COUNT         ///< Number of counters (not a counter)
+};
+
+/**
+ * @brief The things that are timed.
+ */
+enum Histogram {
+  SINK_DEDUCTION_NS, ///< Rebuilding a sunk ship in OpponentGrid::shotResult()
+  PLACE_SHIP_NS,     ///< OwnGrid::placeShip()
+  VIEW_RENDER_NS,    ///< ConsoleView::renderTo()
+  VIEW_LIVE_NS,      ///< ConsoleView::renderLiveTo()
+  HISTOGRAM_COUNT    ///< Number of histograms (not a histogram)
+};
+
+constexpr int BUCKETS = 40; ///< Histogram buckets (the last is open-ended)
+
+/**
+ * @brief One thread's counters.
+ */
+struct Block {
+  std::atomic<uint64_t> counters[COUNTER_COUNT];        ///< Per counter
+  std::atomic<uint64_t> buckets[HISTOGRAM_COUNT][BUCKETS]; ///< Per bucket
+  std::atomic<uint64_t> totalNanos[HISTOGRAM_COUNT];    ///< Sum of samples
+};
+
+/**
+ * @brief All counters at one moment, added up over all threads.
+ */
+struct Snapshot {
+  uint64_t counters[COUNTER_COUNT];         ///< Per counter
+  uint64_t buckets[HISTOGRAM_COUNT][BUCKETS]; ///< Per bucket
+  uint64_t totalNanos[HISTOGRAM_COUNT];     ///< Sum of samples
+
+  /**
+   * @brief Number of samples in a histogram.
+   */
+  uint64_t getSamples(Histogram histogram) const;
+
+  /**
+   * @brief Average sample in nanoseconds (0 without samples).
+   */
+  double getMeanNanos(Histogram histogram) const;
+
+  /**
+   * @brief Upper end of the bucket holding the given share of the samples
+   * (e.g. 0.99), in nanoseconds.
+   */
+  uint64_t getPercentileNanos(Histogram histogram, double share) const;
+};
+
+/**
+ * @brief The calling thread's block (registered on first use).
+ */
+Block &localBlock();
+
+/**
+ * @brief Name of a counter, as printed by dump().
+ */
+const char *counterName(Counter counter);
+
+/**
+ * @brief Name of a histogram, as printed by dump().
+ */
+const char *histogramName(Histogram histogram);
+
+/**
+ * @brief Bucket of a sample: 0 for 0 ns, else 1 + floor(log2(nanos)).
+ */
+inline int bucketOf(uint64_t nanos) {
+  int bucket = (nanos == 0) ? 0 : 64 - __builtin_clzll(nanos);
+  return (bucket < BUCKETS) ? bucket : BUCKETS - 1;
+}
+
+/**
+ * @brief Add 'amount' to a counter of the calling thread.
+ *
+ * Only this thread writes its block, so a relaxed load and store is enough;
+ * the atomics only make sure snapshot() reads whole numbers.
+ */
+inline void add(Counter counter, uint64_t amount = 1) {
+#ifdef BATTLESHIP_METRICS
+  std::atomic<uint64_t> &value = localBlock().counters[counter];
+  value.store(value.load(std::memory_order_relaxed) + amount,
+              std::memory_order_relaxed);
+#else
+  (void)counter;
+  (void)amount;
+#endif
+}
+
+/**
+ * @brief Add one sample to a histogram of the calling thread.
+ */
+inline void record(Histogram histogram, uint64_t nanos) {
+#ifdef BATTLESHIP_METRICS
+  Block &block = localBlock();
+  std::atomic<uint64_t> &bucket = block.buckets[histogram][bucketOf(nanos)];
+  std::atomic<uint64_t> &total = block.totalNanos[histogram];
+  bucket.store(bucket.load(std::memory_order_relaxed) + 1,
+               std::memory_order_relaxed);
+  total.store(total.load(std::memory_order_relaxed) + nanos,
+              std::memory_order_relaxed);
+#else
+  (void)histogram;
+  (void)nanos;
+#endif
+}
+
+/**
+ * @class Timer
+ * @brief Times its own lifetime into a histogram.
+ */
+class Timer {
+#ifdef BATTLESHIP_METRICS
+private:
+  Histogram histogram;                          ///< Where the time goes
+  std::chrono::steady_clock::time_point start; ///< When it was created
+
+public:
+  /**
+   * @brief Start timing.
+   */
+  explicit Timer(Histogram histogram) {
+    this->histogram = histogram;
+    this->start = std::chrono::steady_clock::now();
+  }
+
+  /**
+   * @brief Record the time since the constructor.
+   */
+  ~Timer() {
+    std::chrono::nanoseconds elapsed =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start);
+    record(histogram, uint64_t(elapsed.count()));
+  }
+#else
+public:
+  /**
+   * @brief Does nothing without metrics.
+   */
+  explicit Timer(Histogram) {}
+#endif
+
+  Timer(const Timer &) = delete;
+  Timer &operator=(const Timer &) = delete;
+};
+
+/**
+ * @brief Add up the blocks of all threads (zeros without metrics).
+ */
+Snapshot snapshot();
+
+/**
+ * @brief Set every counter of every thread back to 0. Only exact while no
+ * other thread is recording.
+ */
+void reset();
+
+/**
+ * @brief Print every counter and histogram that isn't 0, one per line.
+ */
+void dump(std::ostream &out, const Snapshot &data);
+
+} // namespace Metrics
+
+#endif /* METRICS_H_ */
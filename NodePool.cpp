@@ -0,0 +1,78 @@
+/**
+ * @file NodePool.cpp
+ * @brief Implementation of the NodePool class.
+ */
+
+#include "NodePool.h"
+#include <functional>
+
+namespace {
+
+/**
+ * Blocks are aligned like anything malloc() returns, and BLOCK_BYTES is a
+ * multiple of that, so every block in the slab is aligned too.
+ */
+const std::size_t BLOCK_ALIGN = alignof(std::max_align_t);
+
+} // namespace
+
+/**
+ * The free list is threaded through the blocks themselves: the first bytes
+ * of a free block hold the address of the next one.
+ */
+NodePool::NodePool(std::size_t blocks, std::pmr::memory_resource *upstream) {
+  this->upstream = upstream;
+  this->blockCount = blocks;
+  this->slab = 0;
+  this->freeList = 0;
+
+  if (blocks == 0) {
+    return;
+  }
+  slab = static_cast<unsigned char *>(
+      upstream->allocate(blocks * BLOCK_BYTES, BLOCK_ALIGN));
+  for (std::size_t blockIdx = blocks; blockIdx > 0; blockIdx--) {
+    void *block = slab + (blockIdx - 1) * BLOCK_BYTES;
+    *static_cast<void **>(block) = freeList;
+    freeList = block;
+  }
+}
+
+NodePool::~NodePool() {
+  if (slab != 0) {
+    upstream->deallocate(slab, blockCount * BLOCK_BYTES, BLOCK_ALIGN);
+  }
+}
+
+std::size_t NodePool::getBlockCount() const { return blockCount; }
+
+void *NodePool::do_allocate(std::size_t bytes, std::size_t alignment) {
+  if (bytes > BLOCK_BYTES || alignment > BLOCK_ALIGN || freeList == 0) {
+    return upstream->allocate(bytes, alignment);
+  }
+  void *block = freeList;
+  freeList = *static_cast<void **>(block);
+  return block;
+}
+
+/**
+ * std::less gives a total order even for pointers into different objects,
+ * so it can tell if a block came from the slab.
+ */
+void NodePool::do_deallocate(void *memory, std::size_t bytes,
+                             std::size_t alignment) {
+  unsigned char *block = static_cast<unsigned char *>(memory);
+  std::less<unsigned char *> before;
+  if (slab == 0 || before(block, slab) ||
+      !before(block, slab + blockCount * BLOCK_BYTES)) {
+    upstream->deallocate(memory, bytes, alignment);
+    return;
+  }
+  *static_cast<void **>(memory) = freeList;
+  freeList = memory;
+}
+
+bool NodePool::do_is_equal(const std::pmr::memory_resource &other) const
+    noexcept {
+  return this == &other;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file NodePool.h
+ * @brief Header for the NodePool class.
+ *
+ * A recycling bin for the nodes of one std::pmr::set or std::pmr::map.
+ */
+
+#ifndef NODEPOOL_H_
+#define NODEPOOL_H_
+
+#include <cstddef>
+#include <memory_resource>
+
+/**
+ * @class NodePool
+ * @brief A fixed number of small blocks, handed out and taken back in
+ * constant time.
+ *
+ * A set or map asks for one small block per element and gives it back when
+ * the element is erased. A NodePool cuts all its blocks out of one slab in
+ * the constructor and keeps the free ones on a list, so inserting, erasing,
+ * clear() and inserting again never go to the memory resource behind it.
+ *
+ * Requests that are too big, or that come when all blocks are in use, are
+ * passed on to that resource, so a container never runs out of memory.
+ *
+ * The pool must outlive the container that uses it.
+ */
+class NodePool : public std::pmr::memory_resource {
+private:
+  std::pmr::memory_resource *upstream; ///< Where the slab comes from
+  std::size_t blockCount;              ///< Blocks in the slab
+  unsigned char *slab;                 ///< All the blocks, or null
+  void *freeList; ///< First free block; each one points to the next
+
+public:
+  /**
+   * @brief Size of one block: a tree node with a small key (such as a
+   * GridPosition and a Shot::Impact) fits into it.
+   */
+  static constexpr std::size_t BLOCK_BYTES = 48;
+
+  /**
+   * @brief Allocate the slab.
+   * @param blocks How many blocks to keep ready, e.g. one per square.
+   * @param upstream Where the slab and any extra blocks come from.
+   */
+  NodePool(std::size_t blocks, std::pmr::memory_resource *upstream);
+
+  /**
+   * @brief Give the slab back.
+   */
+  ~NodePool();
+
+  NodePool(const NodePool &) = delete;
+  NodePool &operator=(const NodePool &) = delete;
+
+  /**
+   * @brief Number of blocks in the slab.
+   */
+  std::size_t getBlockCount() const;
+
+protected:
+  /**
+   * @brief Take a block off the free list, or ask the upstream resource.
+   */
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+  /**
+   * @brief Put a block back on the free list, or give it back upstream.
+   */
+  void do_deallocate(void *memory, std::size_t bytes,
+                     std::size_t alignment) override;
+
+  /**
+   * @brief Only the pool itself can free its blocks.
+   */
+  bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override;
+};
+
+#endif /* NODEPOOL_H_ */
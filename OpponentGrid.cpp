@@ -7,51 +7,242 @@
  */
 
 #include "OpponentGrid.h"
-#include <set>
+#include "Metrics.h"
+#include "Trace.h"
+#include <algorithm>
 
-OpponentGrid::OpponentGrid() {
+namespace {
+
+bool testBit(const std::pmr::vector<uint64_t> &mask, int index) {
+  return (mask[index >> 6] >> (index & 63)) & 1;
+}
+
+void writeBit(std::pmr::vector<uint64_t> &mask, int index, bool value) {
+  uint64_t bit = uint64_t(1) << (index & 63);
+  if (value) {
+    mask[index >> 6] |= bit;
+  } else {
+    mask[index >> 6] &= ~bit;
+  }
+}
+
+} // namespace
+
+OpponentGrid::OpponentGrid()
+    : shotNodes(0, std::pmr::get_default_resource()), shots(&shotNodes) {
   this->rows = 0;
   this->columns = 0;
 }
 
-OpponentGrid::OpponentGrid(int rows, int columns) {
+OpponentGrid::OpponentGrid(int rows, int columns,
+                           std::pmr::memory_resource *resource)
+    : cellStates(resource),
+      shotNodes((rows > 0 && columns > 0) ? rows * columns : 0, resource),
+      shots(&shotNodes), sunkenShips(resource), knownEmptyMask(resource),
+      unresolvedHitMask(resource), resultHistory(resource),
+      maskChanges(resource) {
   this->rows = rows;
   this->columns = columns;
+
+  int cellCount = (rows > 0 && columns > 0) ? rows * columns : 0;
+  cellStates.assign(cellCount, UNKNOWN);
+  knownEmptyMask.assign((cellCount + 63) / 64, 0);
+  unresolvedHitMask.assign((cellCount + 63) / 64, 0);
+  resultHistory.reserve(cellCount);
+  // In a real game a sink flips each bit of a square at most once
+  maskChanges.reserve(2 * cellCount);
+}
+
+/**
+ * Like OwnGrid's copy: the shot map gets a pool of its own and the undo
+ * stacks get the same room the original has.
+ */
+OpponentGrid::OpponentGrid(const OpponentGrid &other)
+    : cellStates(other.cellStates),
+      shotNodes(other.shotNodes.getBlockCount(),
+                std::pmr::get_default_resource()),
+      shots(other.shots.begin(), other.shots.end(), &shotNodes),
+      sunkenShips(other.sunkenShips), knownEmptyMask(other.knownEmptyMask),
+      unresolvedHitMask(other.unresolvedHitMask),
+      resultHistory(other.resultHistory), maskChanges(other.maskChanges) {
+  this->rows = other.rows;
+  this->columns = other.columns;
+  resultHistory.reserve(other.resultHistory.capacity());
+  maskChanges.reserve(other.maskChanges.capacity());
+}
+
+OpponentGrid &OpponentGrid::operator=(const OpponentGrid &other) {
+  if (this == &other) {
+    return *this;
+  }
+  rows = other.rows;
+  columns = other.columns;
+  cellStates = other.cellStates;
+  shots = other.shots;
+  sunkenShips = other.sunkenShips;
+  knownEmptyMask = other.knownEmptyMask;
+  unresolvedHitMask = other.unresolvedHitMask;
+  resultHistory = other.resultHistory;
+  maskChanges = other.maskChanges;
+  return *this;
+}
+
+/**
+ * clear() and fill() keep the memory the vectors already have, and the map
+ * gives its nodes back to its pool.
+ */
+void OpponentGrid::reset() {
+  std::fill(cellStates.begin(), cellStates.end(), UNKNOWN);
+  std::fill(knownEmptyMask.begin(), knownEmptyMask.end(), 0);
+  std::fill(unresolvedHitMask.begin(), unresolvedHitMask.end(), 0);
+  shots.clear();
+  sunkenShips.clear();
+  resultHistory.clear();
+  maskChanges.clear();
 }
 
 int OpponentGrid::getRows() const { return rows; }
 
 int OpponentGrid::getColumns() const { return columns; }
 
+/**
+ * Returns what we know about a square: a quick array read for squares on the
+ * grid, and UNKNOWN for anything else.
+ */
+OpponentGrid::CellState
+OpponentGrid::getCellState(const GridPosition &position) const {
+  int rowIdx = position.getRow() - 'A';
+  int colIdx = position.getColumn() - 1;
+
+  if (rowIdx < 0 || rowIdx >= rows || colIdx < 0 || colIdx >= columns) {
+    return UNKNOWN;
+  }
+  return CellState(cellStates[rowIdx * columns + colIdx]);
+}
+
+/**
+ * A square belongs to a ship if we got a HIT or SUNKEN there. Shots that
+ * landed off the grid are looked up in the shot map.
+ */
+bool OpponentGrid::isShipSegment(const GridPosition &position) const {
+  int rowIdx = position.getRow() - 'A';
+  int colIdx = position.getColumn() - 1;
+
+  if (rowIdx >= 0 && rowIdx < rows && colIdx >= 0 && colIdx < columns) {
+    unsigned char state = cellStates[rowIdx * columns + colIdx];
+    return state == HIT || state == SUNK;
+  }
+
+  std::pmr::map<GridPosition, Shot::Impact>::const_iterator strayIt =
+      shots.find(position);
+  return strayIt != shots.end() &&
+         (strayIt->second == Shot::HIT || strayIt->second == Shot::SUNKEN);
+}
+
+/**
+ * A miss is water, a hit is unresolved until its ship sinks. A square we got
+ * SUNKEN for is neither; markSunk() takes care of the rest of that ship.
+ */
+void OpponentGrid::markCell(int cell, Shot::Impact impact) {
+  writeBit(knownEmptyMask, cell, impact == Shot::NONE);
+  writeBit(unresolvedHitMask, cell, impact == Shot::HIT);
+}
+
+/**
+ * The squares of the ship are resolved now. Every other square of its
+ * blocked area (the ring around it) can't hold a ship, because ships never
+ * touch - unless we have a hit there, which we leave alone.
+ *
+ * Only bits that really change are written and remembered, so an undo can
+ * flip exactly those back; a ring often overlaps older misses and rings.
+ */
+int OpponentGrid::markSunk(const Ship &ship) {
+  int changes = 0;
+  GridArea shipCells = ship.occupiedCells();
+  for (GridArea::Iterator posIt = shipCells.begin(); posIt != shipCells.end();
+       ++posIt) {
+    int rowIdx = (*posIt).getRow() - 'A';
+    int colIdx = (*posIt).getColumn() - 1;
+    if (rowIdx >= 0 && rowIdx < rows && colIdx >= 0 && colIdx < columns) {
+      int cell = rowIdx * columns + colIdx;
+      if (testBit(unresolvedHitMask, cell)) {
+        writeBit(unresolvedHitMask, cell, false);
+        MaskChange change = {cell, false};
+        maskChanges.push_back(change);
+        changes++;
+      }
+    }
+  }
+
+  GridArea halo = ship.blockedCells();
+  for (GridArea::Iterator posIt = halo.begin(); posIt != halo.end(); ++posIt) {
+    int rowIdx = (*posIt).getRow() - 'A';
+    int colIdx = (*posIt).getColumn() - 1;
+    if (rowIdx >= 0 && rowIdx < rows && colIdx >= 0 && colIdx < columns) {
+      int cell = rowIdx * columns + colIdx;
+      if ((cellStates[cell] == UNKNOWN || cellStates[cell] == MISS) &&
+          !testBit(knownEmptyMask, cell)) {
+        writeBit(knownEmptyMask, cell, true);
+        MaskChange change = {cell, true};
+        maskChanges.push_back(change);
+        changes++;
+      }
+    }
+  }
+  return changes;
+}
+
 /**
  * Records the result of a shot we fired.
  * If we sink a ship, we run a search to find out exactly where
  * that ship was based on our previous 'HIT' records.
  */
 void OpponentGrid::shotResult(const Shot &shot, Shot::Impact impact) {
-  GridPosition target = shot.getTargetPosition();
+  Trace::Span span("OpponentGrid::shotResult");
+  const GridPosition &target = shot.getTargetPosition();
+  int rowIdx = target.getRow() - 'A';
+  int colIdx = target.getColumn() - 1;
+
+  ResultRecord record = {target, -1, UNKNOWN, impact == Shot::SUNKEN,
+                         false, false, 0};
+  if (rowIdx >= 0 && rowIdx < rows && colIdx >= 0 && colIdx < columns) {
+    record.cell = rowIdx * columns + colIdx;
+    record.previous = cellStates[record.cell];
+    record.wasKnownEmpty = testBit(knownEmptyMask, record.cell);
+    record.wasUnresolvedHit = testBit(unresolvedHitMask, record.cell);
+    cellStates[record.cell] = impact + 1;
+    markCell(record.cell, impact);
+  } else {
+    std::pmr::map<GridPosition, Shot::Impact>::const_iterator strayIt =
+        shots.find(target);
+    if (strayIt != shots.end()) {
+      record.previous = strayIt->second + 1;
+    }
+  }
   shots[target] = impact;
+  resultHistory.push_back(record);
+  Metrics::add(Metrics::RESULT_SHOTS);
 
   // If we just sank a ship, we need to 'find' all its parts!
   if (impact == Shot::SUNKEN) {
-    std::set<GridPosition> shipPositions;
-    shipPositions.insert(
-        target); // The square we just hit is definitely part of it
-
+    Metrics::add(Metrics::RESULT_SINKS);
+    Metrics::Timer timer(Metrics::SINK_DEDUCTION_NS);
     char shipRow = target.getRow();   // Row of the ship
     int shipCol = target.getColumn(); // Column of the ship
 
+    // The square we just hit is definitely part of it. We only need the two
+    // ends of the ship, so we just widen them while we search.
+    GridPosition bow = target;
+    GridPosition stern = target;
+
     bool isHorizontal = false;
 
     // 1. Look to the LEFT for more hits/sunk markers belonging to this ship
     for (int col = shipCol - 1; col >= 1; col--) {
       GridPosition leftPos(shipRow, col); // Position to the left
-      std::map<GridPosition, Shot::Impact>::iterator shotFindIt =
-          shots.find(leftPos);
 
-      if (shotFindIt != shots.end() && (shotFindIt->second == Shot::HIT ||
-                                        shotFindIt->second == Shot::SUNKEN)) {
-        shipPositions.insert(leftPos);
+      if (isShipSegment(leftPos)) {
+        bow = leftPos;
         isHorizontal =
             true; // If we found stuff left or right, it's a horizontal ship
       } else {
@@ -62,12 +253,9 @@ void OpponentGrid::shotResult(const Shot &shot, Shot::Impact impact) {
     // 2. Look to the RIGHT
     for (int col = shipCol + 1; col <= columns; col++) {
       GridPosition rightPos(shipRow, col);
-      std::map<GridPosition, Shot::Impact>::iterator shotFindIt =
-          shots.find(rightPos);
 
-      if (shotFindIt != shots.end() && (shotFindIt->second == Shot::HIT ||
-                                        shotFindIt->second == Shot::SUNKEN)) {
-        shipPositions.insert(rightPos);
+      if (isShipSegment(rightPos)) {
+        stern = rightPos;
         isHorizontal = true;
       } else {
         break;
@@ -79,12 +267,9 @@ void OpponentGrid::shotResult(const Shot &shot, Shot::Impact impact) {
       // Look UP
       for (char row = shipRow - 1; row >= 'A'; row--) {
         GridPosition upPos(row, shipCol);
-        std::map<GridPosition, Shot::Impact>::iterator shotFindIt =
-            shots.find(upPos);
 
-        if (shotFindIt != shots.end() && (shotFindIt->second == Shot::HIT ||
-                                          shotFindIt->second == Shot::SUNKEN)) {
-          shipPositions.insert(upPos);
+        if (isShipSegment(upPos)) {
+          bow = upPos;
         } else {
           break;
         }
@@ -93,36 +278,140 @@ void OpponentGrid::shotResult(const Shot &shot, Shot::Impact impact) {
       // Look DOWN
       char maxRow = 'A' + rows - 1;
       for (char row = shipRow + 1; row <= maxRow; row++) {
-        GridPosition downPos(row, shipCol);
-        std::map<GridPosition, Shot::Impact>::iterator shotFindIt =
-            shots.find(downPos); // here we are searching for the ship
-
-        if (shotFindIt != shots.end() && (shotFindIt->second == Shot::HIT ||
-                                          shotFindIt->second == Shot::SUNKEN)) {
-          shipPositions.insert(
-              downPos); // here we are inserting the ships positions
+        GridPosition downPos(row, shipCol); // here we are searching for the ship
+
+        if (isShipSegment(downPos)) {
+          stern = downPos;
         } else {
           break;
         }
       }
     }
 
-    // Now that we've found all the coordinates, we can 'reconstruct' the ship.
-    // The set is sorted, so the first and last items are the bow and stern!
-    if (!shipPositions.empty()) {
-      GridPosition bow = *shipPositions.begin();
-      GridPosition stern = *shipPositions.rbegin();
+    // Now that we've found both ends, we can 'reconstruct' the ship.
+    Ship sunkenShip(bow, stern);
+    sunkenShips.push_back(sunkenShip);
+    resultHistory.back().sinkChanges = markSunk(sunkenShip);
+  }
+}
+
+/**
+ * Misses and plain hits only write one byte each. Only a sink has to look
+ * at the squares around it, so those go through shotResult().
+ */
+std::size_t OpponentGrid::shotResults(Span<const Shot> shots,
+                                      Span<const Shot::Impact> impacts) {
+  std::size_t count =
+      (shots.size() < impacts.size()) ? shots.size() : impacts.size();
+
+  for (std::size_t shotIdx = 0; shotIdx < count; shotIdx++) {
+    const GridPosition &target = shots[shotIdx].getTargetPosition();
+    int rowIdx = target.getRow() - 'A';
+    int colIdx = target.getColumn() - 1;
 
-      Ship sunkenShip(bow, stern);
-      sunkenShips.push_back(sunkenShip);
+    if (impacts[shotIdx] == Shot::SUNKEN || rowIdx < 0 || rowIdx >= rows ||
+        colIdx < 0 || colIdx >= columns) {
+      shotResult(shots[shotIdx], impacts[shotIdx]);
+      continue;
     }
+
+    int cell = rowIdx * columns + colIdx;
+    ResultRecord record = {target, cell, cellStates[cell], false,
+                           testBit(knownEmptyMask, cell),
+                           testBit(unresolvedHitMask, cell), 0};
+    resultHistory.push_back(record);
+    cellStates[cell] = impacts[shotIdx] + 1;
+    markCell(cell, impacts[shotIdx]);
+    this->shots[target] = impacts[shotIdx];
+    Metrics::add(Metrics::RESULT_SHOTS);
   }
+  return count;
 }
 
-const std::map<GridPosition, Shot::Impact> &OpponentGrid::getShotsAt() const {
+/**
+ * Puts the square and its map entry back the way they were and drops the sunk
+ * ship if this shot added one - it is always the last one in the list.
+ * The mask bits that sink flipped are on top of 'maskChanges'; they are
+ * flipped back first, then the square gets its own bits back.
+ */
+bool OpponentGrid::undoShotResult() {
+  if (resultHistory.empty()) {
+    return false;
+  }
+  ResultRecord record = resultHistory.back();
+  resultHistory.pop_back();
+
+  for (int changeIdx = 0; changeIdx < record.sinkChanges; changeIdx++) {
+    MaskChange change = maskChanges.back();
+    maskChanges.pop_back();
+    if (change.knownEmpty) {
+      writeBit(knownEmptyMask, change.cell, false);
+    } else {
+      writeBit(unresolvedHitMask, change.cell, true);
+    }
+  }
+
+  if (record.cell >= 0) {
+    cellStates[record.cell] = record.previous;
+    writeBit(knownEmptyMask, record.cell, record.wasKnownEmpty);
+    writeBit(unresolvedHitMask, record.cell, record.wasUnresolvedHit);
+  }
+  if (record.previous == UNKNOWN) {
+    shots.erase(record.target);
+  } else {
+    shots[record.target] = Shot::Impact(record.previous - 1);
+  }
+
+  if (record.addedShip) {
+    sunkenShips.pop_back();
+  }
+  return true;
+}
+
+const std::pmr::map<GridPosition, Shot::Impact> &
+OpponentGrid::getShotsAt() const {
   return shots;
 } // here we are returning the shots
 
-const std::vector<Ship> &OpponentGrid::getSunkenShips() const {
-  return sunkenShips;
+const std::pmr::vector<unsigned char> &OpponentGrid::getCellStates() const {
+  return cellStates;
+}
+
+std::vector<Ship> OpponentGrid::getSunkenShips() const {
+  return std::vector<Ship>(sunkenShips.begin(), sunkenShips.end());
 } // here we are returning the sunken ships
+
+Span<const Ship> OpponentGrid::getSunkenShipView() const {
+  return sunkenShips;
+}
+
+/**
+ * Off the grid nothing is known, so both answers are false there.
+ */
+bool OpponentGrid::isKnownEmpty(const GridPosition &position) const {
+  int rowIdx = position.getRow() - 'A';
+  int colIdx = position.getColumn() - 1;
+
+  if (rowIdx < 0 || rowIdx >= rows || colIdx < 0 || colIdx >= columns) {
+    return false;
+  }
+  return testBit(knownEmptyMask, rowIdx * columns + colIdx);
+}
+
+bool OpponentGrid::isUnresolvedHit(const GridPosition &position) const {
+  int rowIdx = position.getRow() - 'A';
+  int colIdx = position.getColumn() - 1;
+
+  if (rowIdx < 0 || rowIdx >= rows || colIdx < 0 || colIdx >= columns) {
+    return false;
+  }
+  return testBit(unresolvedHitMask, rowIdx * columns + colIdx);
+}
+
+const std::pmr::vector<uint64_t> &OpponentGrid::getKnownEmptyMask() const {
+  return knownEmptyMask;
+}
+
+const std::pmr::vector<uint64_t> &OpponentGrid::getUnresolvedHitMask() const {
+  return unresolvedHitMask;
+}
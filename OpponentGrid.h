@@ -10,9 +10,13 @@
 #define OPPONENTGRID_H_
 
 #include "GridPosition.h"
+#include "NodePool.h"
 #include "Ship.h"
 #include "Shot.h"
+#include "Span.h"
 #include <map>
+#include <cstdint>
+#include <memory_resource>
 #include <vector>
 
 /**
@@ -21,14 +25,85 @@
  *
  * Since we can't see their ships, we record 'HIT' or 'MISS' for every square
  * we attack. When we sink a ship, we try to reconstruct its full position.
+ *
+ * Ships never touch, so once a ship is sunk every square around it must be
+ * water. The grid keeps that in a "known empty" mask (misses plus the
+ * squares around sunk ships), next to a mask of the hits that don't belong
+ * to a sunk ship yet. Targeting code can skip impossible squares with one
+ * bit test.
+ *
+ * Like OwnGrid, it handles at most 26 rows; see LargeOpponentGrid for more.
+ * Its containers also use the memory resource given to the constructor, and
+ * the nodes of the shot map come from a NodePool with one block per square.
  */
 class OpponentGrid {
+public:
+  /**
+   * @brief What we know about a single square of the opponent's grid.
+   *
+   * For squares we fired at, the value is always the shot's Impact plus one.
+   */
+  enum CellState {
+    UNKNOWN, ///< We haven't fired here yet
+    MISS,    ///< Our shot hit water
+    HIT,     ///< Our shot hit a ship segment
+    SUNK     ///< Our shot sank a ship here
+  };
+
 private:
   int rows;    ///< Height of the grid
   int columns; ///< Width of the grid
 
-  std::map<GridPosition, Shot::Impact> shots; ///< History of our attacks
-  std::vector<Ship> sunkenShips; ///< Ships we've successfully destroyed
+  std::pmr::vector<unsigned char> cellStates; ///< One CellState per square
+  NodePool shotNodes; ///< Nodes for 'shots', one per square (declared first)
+  std::pmr::map<GridPosition, Shot::Impact> shots; ///< Every shot, sorted
+  std::pmr::vector<Ship> sunkenShips; ///< Ships we've successfully destroyed
+
+  // One bit per square (row-major), in 64-bit words
+  std::pmr::vector<uint64_t> knownEmptyMask; ///< Misses and sunk ship halos
+  std::pmr::vector<uint64_t> unresolvedHitMask; ///< Hits not on a sunk ship
+
+  /**
+   * @brief What one shotResult() changed, so undoShotResult() can put it
+   * back.
+   */
+  struct ResultRecord {
+    GridPosition target;    ///< Where the shot went
+    int cell;               ///< Square index, or -1 for a shot off the grid
+    unsigned char previous; ///< CellState before (UNKNOWN: no map entry)
+    bool addedShip;         ///< True if a sunk ship was appended
+    bool wasKnownEmpty;     ///< The square's known empty bit before
+    bool wasUnresolvedHit;  ///< The square's unresolved hit bit before
+    int sinkChanges;        ///< Entries the sink pushed onto 'maskChanges'
+  };
+  std::pmr::vector<ResultRecord> resultHistory; ///< Undo stack, newest last
+
+  /**
+   * @brief A mask bit markSunk() flipped: a ring square that became known
+   * empty, or a ship square whose hit was resolved.
+   */
+  struct MaskChange {
+    int cell;        ///< Square index
+    bool knownEmpty; ///< True: known empty bit set; false: hit bit cleared
+  };
+  std::pmr::vector<MaskChange> maskChanges; ///< Undo stack for the sinks
+
+  /**
+   * @brief Is this square a ship segment we have already hit or sunk?
+   */
+  bool isShipSegment(const GridPosition &position) const;
+
+  /**
+   * @brief Set both mask bits of a square we just got 'impact' for.
+   */
+  void markCell(int cell, Shot::Impact impact);
+
+  /**
+   * @brief Mark a sunk ship's squares as resolved and the water around it
+   * as known empty.
+   * @return How many bits it flipped (each one pushed onto 'maskChanges').
+   */
+  int markSunk(const Ship &ship);
 
 public:
   /**
@@ -38,8 +113,29 @@ public:
 
   /**
    * @brief Create a grid to track an opponent of a certain size.
+   * @param resource Where the grid's containers get their memory.
+   */
+  OpponentGrid(int rows, int columns,
+               std::pmr::memory_resource *resource =
+                   std::pmr::get_default_resource());
+
+  /**
+   * @brief Copy a tracker, shots, sunk ships, undo history and all, onto the
+   * normal heap.
+   */
+  OpponentGrid(const OpponentGrid &other);
+
+  /**
+   * @brief Copy another tracker's state into this one. This tracker keeps
+   * its own memory resource.
+   */
+  OpponentGrid &operator=(const OpponentGrid &other);
+
+  /**
+   * @brief Forget every shot and sunk ship, keeping the memory of all
+   * containers.
    */
-  OpponentGrid(int rows, int columns);
+  void reset();
 
   /**
    * @brief Get height of the board.
@@ -58,15 +154,80 @@ public:
    */
   void shotResult(const Shot &shot, Shot::Impact impact);
 
+  /**
+   * @brief Take back the most recent shotResult(), including the sunk ship
+   * it may have added.
+   *
+   * Never allocates memory. Taking back a sink only touches the squares of
+   * that ship and its ring.
+   * @return False if there was nothing left to undo.
+   */
+  bool undoShotResult();
+
+  /**
+   * @brief Record the results of a whole salvo, exactly as if shotResult()
+   * was called for each shot in order.
+   * @return Number of results recorded (the shorter of the two spans).
+   */
+  std::size_t shotResults(Span<const Shot> shots,
+                          Span<const Shot::Impact> impacts);
+
   /**
    * @brief Get all shots we've fired so far.
+   *
+   * Every result is put into the map as it is recorded, so this only hands
+   * out a reference. Code that reads the tracker often should use
+   * getCellState() or getCellStates() instead, which need no tree lookup.
    */
-  const std::map<GridPosition, Shot::Impact> &getShotsAt() const;
+  const std::pmr::map<GridPosition, Shot::Impact> &getShotsAt() const;
+
+  /**
+   * @brief What do we know about this square? UNKNOWN if it's off the grid.
+   */
+  CellState getCellState(const GridPosition &position) const;
+
+  /**
+   * @brief All square states in row-major order (index = rowIdx * columns +
+   * colIdx), stored as one CellState per byte.
+   */
+  const std::pmr::vector<unsigned char> &getCellStates() const;
 
   /**
    * @brief Get the list of all opponent ships we've sunk.
+   *
+   * This is a copy; getSunkenShipView() gives the same ships without one.
+   */
+  std::vector<Ship> getSunkenShips() const;
+
+  /**
+   * @brief All opponent ships we've sunk, in the order they sank.
+   *
+   * A view of the grid's own list, so nothing is copied. It stays valid
+   * until the next shot result, undo or reset().
+   */
+  Span<const Ship> getSunkenShipView() const;
+
+  /**
+   * @brief Can this square be nothing but water? True for misses and for
+   * the squares around a sunk ship (ships never touch). False off the grid.
+   */
+  bool isKnownEmpty(const GridPosition &position) const;
+
+  /**
+   * @brief Is this square a hit that doesn't belong to a sunk ship yet?
+   */
+  bool isUnresolvedHit(const GridPosition &position) const;
+
+  /**
+   * @brief The known empty squares as a bit mask (bit cellIdx of word
+   * cellIdx / 64, cellIdx = rowIdx * columns + colIdx).
+   */
+  const std::pmr::vector<uint64_t> &getKnownEmptyMask() const;
+
+  /**
+   * @brief The unresolved hits, laid out like getKnownEmptyMask().
    */
-  const std::vector<Ship> &getSunkenShips() const;
+  const std::pmr::vector<uint64_t> &getUnresolvedHitMask() const;
 };
 
 #endif /* OPPONENTGRID_H_ */
@@ -7,29 +7,142 @@
  */
 
 #include "OwnGrid.h"
+#include "Metrics.h"
+#include "PlacementTable.h"
+#include "Trace.h"
+#include <algorithm>
+
+namespace {
+
+/**
+ * Default rules: 1x Carrier(5), 2x Battleships(4), 3x Destroyers(3), 4x
+ * Submarines(2). Built once and copied into every grid.
+ */
+const std::map<int, int> &standardFleet() {
+  static const std::map<int, int> fleet = {{5, 1}, {4, 2}, {3, 3}, {2, 4}};
+  return fleet;
+}
+
+} // namespace
 
 /**
  * Default Constructor.
  * Sets default 10x10 size.
  */
-OwnGrid::OwnGrid() {
+OwnGrid::OwnGrid()
+    : shotNodes(0, std::pmr::get_default_resource()), shotAt(&shotNodes) {
   this->rows = 0;
   this->columns = 0;
 }
 
 /**
- * Creates the grid and sets the initial fleet limits.
- * Default rules: 1x Carrier(5), 2x Battleships(4), 3x Destroyers(3), 4x
- * Submarines(2).
+ * Creates the grid with the default fleet limits.
  */
-OwnGrid::OwnGrid(int rows, int columns) {
+OwnGrid::OwnGrid(int rows, int columns, std::pmr::memory_resource *resource)
+    : OwnGrid(rows, columns, standardFleet(), resource) {}
+
+/**
+ * Creates the grid and sets the initial fleet limits. The containers have
+ * to get their resource when they are built, hence the initializer list.
+ */
+OwnGrid::OwnGrid(int rows, int columns, const std::map<int, int> &fleet,
+                 std::pmr::memory_resource *resource)
+    : ships(resource), availableShips(resource), shotLog(resource),
+      shotNodes((rows > 0 && columns > 0) ? rows * columns : 0, resource),
+      shotAt(&shotNodes), occupiedMask(resource), blockedMask(resource),
+      shotMask(resource), cellOwner(resource), shipHits(resource),
+      blowHistory(resource) {
   this->rows = rows;
   this->columns = columns;
+  this->availableShips.insert(fleet.begin(), fleet.end());
+
+  // One bit per cell, rounded up to whole 64-bit words
+  int cellCount = (rows > 0 && columns > 0) ? rows * columns : 0;
+  int wordCount = (cellCount + 63) / 64;
+  occupiedMask.assign(wordCount, 0);
+  blockedMask.assign(wordCount, 0);
+  shotMask.assign(wordCount, 0);
+  cellOwner.assign(cellCount, -1);
+
+  // Reserve everything up front so placing ships and taking shots never
+  // has to grow a container in the middle of a game
+  int fleetSize = 0;
+  for (std::map<int, int>::const_iterator countIt = availableShips.begin();
+       countIt != availableShips.end(); ++countIt) {
+    fleetSize += countIt->second;
+  }
+  ships.reserve(fleetSize);
+  shipHits.reserve(fleetSize);
+  shotLog.reserve(cellCount);
+  blowHistory.reserve(cellCount);
+}
 
-  availableShips[5] = 1;
-  availableShips[4] = 2;
-  availableShips[3] = 3;
-  availableShips[2] = 4;
+/**
+ * The pmr containers copy onto the default resource by themselves. The shot
+ * set gets a pool of its own, and the lists get the same room the original
+ * has, so the copy can keep playing without growing them.
+ */
+OwnGrid::OwnGrid(const OwnGrid &other)
+    : ships(other.ships), availableShips(other.availableShips),
+      shotLog(other.shotLog),
+      shotNodes(other.shotNodes.getBlockCount(),
+                std::pmr::get_default_resource()),
+      shotAt(other.shotAt.begin(), other.shotAt.end(), &shotNodes),
+      occupiedMask(other.occupiedMask), blockedMask(other.blockedMask),
+      shotMask(other.shotMask), cellOwner(other.cellOwner),
+      shipHits(other.shipHits), blowHistory(other.blowHistory) {
+  this->rows = other.rows;
+  this->columns = other.columns;
+  ships.reserve(other.ships.capacity());
+  shipHits.reserve(other.shipHits.capacity());
+  shotLog.reserve(other.shotLog.capacity());
+  blowHistory.reserve(other.blowHistory.capacity());
+}
+
+/**
+ * Assigning a pmr container keeps its own memory resource, so every
+ * container (the shot set included) stays where it is.
+ */
+OwnGrid &OwnGrid::operator=(const OwnGrid &other) {
+  if (this == &other) {
+    return *this;
+  }
+  rows = other.rows;
+  columns = other.columns;
+  ships = other.ships;
+  availableShips = other.availableShips;
+  shotLog = other.shotLog;
+  shotAt = other.shotAt;
+  occupiedMask = other.occupiedMask;
+  blockedMask = other.blockedMask;
+  shotMask = other.shotMask;
+  cellOwner = other.cellOwner;
+  shipHits = other.shipHits;
+  blowHistory = other.blowHistory;
+  return *this;
+}
+
+/**
+ * Every placed ship goes back into the inventory (its length is already a
+ * key of the map, so no node is allocated). clear() and fill() keep the
+ * memory of the vectors.
+ */
+void OwnGrid::reset() {
+  for (std::pmr::vector<Ship>::const_iterator shipIt = ships.begin();
+       shipIt != ships.end(); ++shipIt) {
+    availableShips[shipIt->length()]++;
+  }
+  ships.clear();
+  shipHits.clear();
+
+  shotLog.clear();
+  shotAt.clear();
+  blowHistory.clear();
+
+  std::fill(occupiedMask.begin(), occupiedMask.end(), 0);
+  std::fill(blockedMask.begin(), blockedMask.end(), 0);
+  std::fill(shotMask.begin(), shotMask.end(), 0);
+  std::fill(cellOwner.begin(), cellOwner.end(), -1);
 }
 
 int OwnGrid::getRows() const { return rows; }
@@ -37,100 +150,369 @@ int OwnGrid::getRows() const { return rows; }
 int OwnGrid::getColumns() const { return columns; }
 
 /**
- * The logic for placing a ship on the grid.
+ * Maps a position to its bit in the masks (row-major order).
+ * Anything outside the grid gets -1.
+ */
+int OwnGrid::cellIndex(const GridPosition &position) const {
+  int rowIdx = position.getRow() - 'A';
+  int colIdx = position.getColumn() - 1;
+
+  if (rowIdx < 0 || rowIdx >= rows || colIdx < 0 || colIdx >= columns) {
+    return -1;
+  }
+  return position.toIndex(columns);
+}
+
+bool OwnGrid::testBit(const std::pmr::vector<uint64_t> &mask, int index) {
+  return (mask[index >> 6] >> (index & 63)) & 1;
+}
+
+void OwnGrid::setBit(std::pmr::vector<uint64_t> &mask, int index) {
+  mask[index >> 6] |= uint64_t(1) << (index & 63);
+}
+
+void OwnGrid::clearBit(std::pmr::vector<uint64_t> &mask, int index) {
+  mask[index >> 6] &= ~(uint64_t(1) << (index & 63));
+}
+
+/**
+ * The logic for checking a ship placement.
  * It checks a lot of rules to make sure the placement is legal.
+ *
+ * Instead of comparing sets of positions, we keep a 'blocked' bitmask that
+ * already contains every placed ship plus its 1-square buffer. So each check
+ * is just a bit test per ship segment.
  */
-bool OwnGrid::placeShip(const Ship &ship) {
+OwnGrid::PlacementResult OwnGrid::checkPlacement(const Ship &ship) const {
   // 1. Is the ship even valid (straight, right size)?
   if (!ship.isValid()) {
-    return false;
+    return INVALID_SHIP;
   }
 
   // 2. Do we have any of this type of ship left to place?
-  int shipLength = ship.length();
-  std::map<int, int>::iterator countIt = availableShips.find(shipLength);
+  std::map<int, int>::const_iterator countIt =
+      availableShips.find(ship.length());
 
   if (countIt == availableShips.end() || countIt->second <= 0) {
-    return false;
+    return NO_INVENTORY;
   }
 
-  std::set<GridPosition> newShipArea = ship.occupiedArea();
-
   // 3. Does it fit within the board's dimensions?
-  for (std::set<GridPosition>::const_iterator posIt = newShipArea.begin();
-       posIt != newShipArea.end(); ++posIt) {
-    const GridPosition &currentPos = *posIt;
+  // A straight ship is inside the board if both of its ends are.
+  if (cellIndex(ship.getBow()) < 0 || cellIndex(ship.getStern()) < 0) {
+    return OUT_OF_BOUNDS;
+  }
 
-    char maxRow = 'A' + rows - 1;
-    if (currentPos.getRow() < 'A' || currentPos.getRow() > maxRow) {
-      return false; // Row out of bounds
+  // 4. Does it touch or overlap any existing ships?
+  if (rows == STANDARD_PLACEMENTS.ROWS &&
+      columns == STANDARD_PLACEMENTS.COLUMNS) {
+    // On the standard board the compiler already built this ship's mask
+    const PlacementTable<10, 10>::Placement &placement =
+        STANDARD_PLACEMENTS[STANDARD_PLACEMENTS.indexOf(ship)];
+    for (int wordIdx = 0; wordIdx < STANDARD_PLACEMENTS.WORDS; wordIdx++) {
+      if (blockedMask[wordIdx] & placement.occupied.word(wordIdx)) {
+        return TOO_CLOSE; // Too close to another ship!
+      }
     }
+    return PLACEMENT_OK;
+  }
 
-    if (currentPos.getColumn() < 1 || currentPos.getColumn() > columns) {
-      return false; // Column out of bounds
+  GridArea occupied = ship.occupiedCells();
+  for (GridArea::Iterator posIt = occupied.begin(); posIt != occupied.end();
+       ++posIt) {
+    if (testBit(blockedMask, (*posIt).toIndex(columns))) {
+      return TOO_CLOSE; // Too close to another ship!
     }
   }
+  return PLACEMENT_OK;
+}
 
-  // 4. Does it touch or overlap any existing ships?
-  // We check against the 'blockedArea' of all currently placed ships.
-  for (std::vector<Ship>::const_iterator shipIt = ships.begin();
-       shipIt != ships.end(); ++shipIt) {
-    const Ship &existingShip = *shipIt;
-    std::set<GridPosition> blockedArea = existingShip.blockedArea();
+bool OwnGrid::canPlaceShip(const Ship &ship) const {
+  return checkPlacement(ship) == PLACEMENT_OK;
+}
+
+/**
+ * Places a ship if canPlaceShip() allows it, then marks the ship and its
+ * buffer zone (clipped to the board) so later ships can check against it.
+ */
+bool OwnGrid::placeShip(const Ship &ship) {
+  Trace::Span span("OwnGrid::placeShip");
+  Metrics::Timer timer(Metrics::PLACE_SHIP_NS);
+  // One counter per answer, in the order of PlacementResult
+  static const Metrics::Counter COUNTERS[] = {
+      Metrics::PLACE_OK, Metrics::PLACE_INVALID_SHIP,
+      Metrics::PLACE_NO_INVENTORY, Metrics::PLACE_OUT_OF_BOUNDS,
+      Metrics::PLACE_TOO_CLOSE};
+  PlacementResult check = checkPlacement(ship);
+  Metrics::add(COUNTERS[check]);
+  if (check != PLACEMENT_OK) {
+    return false;
+  }
+
+  // If we got here, the placement is legal!
+  int slot = ships.size();
+  int earlierHits = 0; // Shots that landed here before the ship was placed
+  GridArea occupied = ship.occupiedCells();
+  for (GridArea::Iterator posIt = occupied.begin(); posIt != occupied.end();
+       ++posIt) {
+    int idx = (*posIt).toIndex(columns);
+    setBit(occupiedMask, idx);
+    cellOwner[idx] = slot;
+    if (testBit(shotMask, idx)) {
+      earlierHits++;
+    }
+  }
 
-    for (std::set<GridPosition>::const_iterator posIt = newShipArea.begin();
-         posIt != newShipArea.end(); ++posIt) {
-      if (blockedArea.count(*posIt) > 0) {
-        return false; // Too close to another ship!
+  if (rows == STANDARD_PLACEMENTS.ROWS &&
+      columns == STANDARD_PLACEMENTS.COLUMNS) {
+    const PlacementTable<10, 10>::Placement &placement =
+        STANDARD_PLACEMENTS[STANDARD_PLACEMENTS.indexOf(ship)];
+    for (int wordIdx = 0; wordIdx < STANDARD_PLACEMENTS.WORDS; wordIdx++) {
+      blockedMask[wordIdx] |= placement.halo.word(wordIdx);
+    }
+  } else {
+    GridArea blocked = ship.blockedCells();
+    for (GridArea::Iterator posIt = blocked.begin(); posIt != blocked.end();
+         ++posIt) {
+      int idx = cellIndex(*posIt);
+      if (idx >= 0) {
+        setBit(blockedMask, idx);
       }
     }
   }
 
-  // If we got here, the placement is legal!
   ships.push_back(ship);
-  availableShips[shipLength]--; // Use up one from our 'inventory'
+  shipHits.push_back(earlierHits);
+  availableShips[ship.length()]--; // Use up one from our 'inventory'
 
   return true;
 }
 
-std::vector<Ship> OwnGrid::getShips() const { return ships; }
+std::vector<Ship> OwnGrid::getShips() const {
+  return std::vector<Ship>(ships.begin(), ships.end());
+}
+
+Span<const Ship> OwnGrid::getShipView() const { return ships; }
+
+int OwnGrid::getShipCount() const { return ships.size(); }
 
 /**
  * Handles what happens when a shot lands on your grid.
  * It records the shot and checks if it hit or sank anything.
+ *
+ * Every cell knows which ship (if any) sits on it, and every ship keeps a
+ * running count of its hits, so we never have to search the fleet.
  */
 Shot::Impact OwnGrid::takeBlow(const Shot &shot) {
-  GridPosition target = shot.getTargetPosition();
-  shotAt.insert(target); // Record where they shot
+  Trace::Span span("OwnGrid::takeBlow");
+  const GridPosition &target = shot.getTargetPosition();
+  int idx = cellIndex(target);
 
-  // we look through our fleet to see if they hit anything
-  for (std::vector<Ship>::const_iterator shipIt = ships.begin();
-       shipIt != ships.end(); ++shipIt) {
-    const Ship &ship = *shipIt;
-    std::set<GridPosition> occupied = ship.occupiedArea();
-
-    if (occupied.count(target) > 0) {
-      // shot hit a ship. Now we check if that whole ship is now destroyed.
-      int hitCount = 0; // Count of hits on this ship
-
-      // here we count how many hits we have on this ship
-      for (std::set<GridPosition>::const_iterator posIt = occupied.begin();
-           posIt != occupied.end(); ++posIt) {
-        if (shotAt.count(*posIt) > 0) {
-          hitCount++;
-        }
+  if (idx < 0) {
+    // Off the grid: we still remember it, but there is nothing to hit
+    shotLog.push_back(target);
+    bool newSquare = shotAt.insert(target).second;
+    recordBlow(-1, true, newSquare);
+    Metrics::add(Metrics::BLOW_OFF_GRID);
+    return Shot::NONE;
+  }
+
+  // A repeated shot is remembered only once and can't damage a ship twice
+  bool firstShot = !testBit(shotMask, idx);
+  if (firstShot) {
+    setBit(shotMask, idx);
+    shotLog.push_back(target); // Record where they shot
+    shotAt.insert(target);
+  } else {
+    Metrics::add(Metrics::BLOW_REPEAT);
+  }
+  recordBlow(idx, firstShot, firstShot);
+
+  int slot = cellOwner[idx];
+  if (slot < 0) {
+    Metrics::add(Metrics::BLOW_MISS);
+    return Shot::NONE; // return miss
+  }
+
+  if (firstShot) {
+    shipHits[slot]++;
+  }
+
+  // If all the cells are hits, the ship is sunk
+  if (shipHits[slot] == ships[slot].length()) {
+    Metrics::add(Metrics::BLOW_SUNKEN);
+    return Shot::SUNKEN;
+  }
+  Metrics::add(Metrics::BLOW_HIT);
+  return Shot::HIT;
+}
+
+/**
+ * Works through the salvo in blocks of up to 64 shots.
+ *
+ * 1. Turn every target into its square index. This is plain arithmetic with
+ *    no branches per shot, so the compiler can vectorize it.
+ * 2. Resolve the shots in firing order. This stays a plain loop, because a
+ *    shot can depend on an earlier one of the same salvo. Misses are a
+ *    single bit test against occupiedMask. For hits we look up the owner,
+ *    and the shot mask tells us if the square was already hit - also by an
+ *    earlier shot of the same salvo, because the bit is set right away.
+ *    Repeated shots only add to the count on the newest undo record (see
+ *    recordBlow()), so a salvo never outgrows the room reserved up front.
+ *
+ * The answers are counted for the metrics just like takeBlow() counts them,
+ * but in local variables that are added once at the end.
+ */
+std::size_t OwnGrid::takeBlows(Span<const Shot> shots,
+                               Span<Shot::Impact> impacts) {
+  std::size_t count =
+      (shots.size() < impacts.size()) ? shots.size() : impacts.size();
+  if (count == 0) {
+    return 0;
+  }
+  Metrics::add(Metrics::SALVO_SHOTS, count);
+
+  uint64_t offGrid = 0;
+  uint64_t repeats = 0;
+  uint64_t misses = 0;
+  uint64_t hits = 0;
+  uint64_t sunken = 0;
+
+  const int BLOCK = 64;
+  int cells[BLOCK];
+  for (std::size_t start = 0; start < count; start += BLOCK) {
+    int blockSize = (count - start < std::size_t(BLOCK)) ? int(count - start)
+                                                         : BLOCK;
+
+    // 1. Square index of every shot, -1 if it's off the grid
+    for (int shotIdx = 0; shotIdx < blockSize; shotIdx++) {
+      const GridPosition &target = shots[start + shotIdx].getTargetPosition();
+      int rowIdx = target.getRow() - 'A';
+      int colIdx = target.getColumn() - 1;
+      bool onGrid = (unsigned(rowIdx) < unsigned(rows)) &
+                    (unsigned(colIdx) < unsigned(columns));
+      cells[shotIdx] = onGrid ? rowIdx * columns + colIdx : -1;
+    }
+
+    // 2. Resolve them in order
+    for (int shotIdx = 0; shotIdx < blockSize; shotIdx++) {
+      int idx = cells[shotIdx];
+      Shot::Impact &impact = impacts[start + shotIdx];
+
+      if (idx < 0) {
+        const GridPosition &target = shots[start + shotIdx].getTargetPosition();
+        shotLog.push_back(target);
+        bool newSquare = shotAt.insert(target).second;
+        recordBlow(-1, true, newSquare);
+        impact = Shot::NONE;
+        offGrid++;
+        continue;
+      }
+
+      bool firstShot = !testBit(shotMask, idx);
+      if (firstShot) {
+        setBit(shotMask, idx);
+        shotLog.push_back(shots[start + shotIdx].getTargetPosition());
+        shotAt.insert(shots[start + shotIdx].getTargetPosition());
       }
-      // If all the cells are hits, the ship is sunk
-      if (hitCount == ship.length()) {
-        return Shot::SUNKEN;
-      } else {
-        return Shot::HIT;
+      recordBlow(idx, firstShot, firstShot);
+      repeats += firstShot ? 0 : 1;
+
+      if (!testBit(occupiedMask, idx)) {
+        impact = Shot::NONE;
+        misses++;
+        continue;
       }
+
+      int slot = cellOwner[idx];
+      shipHits[slot] += firstShot ? 1 : 0;
+      impact = (shipHits[slot] == ships[slot].length()) ? Shot::SUNKEN
+                                                        : Shot::HIT;
+      sunken += (impact == Shot::SUNKEN) ? 1 : 0;
+      hits += (impact == Shot::HIT) ? 1 : 0;
+    }
+  }
+
+  Metrics::add(Metrics::BLOW_OFF_GRID, offGrid);
+  Metrics::add(Metrics::BLOW_REPEAT, repeats);
+  Metrics::add(Metrics::BLOW_MISS, misses);
+  Metrics::add(Metrics::BLOW_HIT, hits);
+  Metrics::add(Metrics::BLOW_SUNKEN, sunken);
+  return count;
+}
+
+/**
+ * A repeated shot changes nothing, so it doesn't need a record of its own.
+ * That way the undo stack never holds more records than the shot log has
+ * entries, and the room the constructor reserved (one per square) is
+ * enough for any number of repeats. Only shots off the grid, which are
+ * logged every time, can make both lists grow.
+ */
+void OwnGrid::recordBlow(int cell, bool newShot, bool newSquare) {
+  if (!newShot && !blowHistory.empty()) {
+    blowHistory.back().repeats++;
+    return;
+  }
+  blowHistory.push_back(BlowRecord{cell, newShot, newSquare, 0});
+}
+
+/**
+ * Undoes exactly what takeBlow() did: the shot log entry, the shot set
+ * entry, the shot bit and the ship's hit counter. A shot that was repeated
+ * changed nothing, so it only comes off the newest record's count.
+ *
+ * Shots off the grid are logged every time, but only the first shot at a
+ * square put it into the set. Undo runs newest first, so by the time that
+ * record comes back up, the later shots at the square are already gone.
+ */
+bool OwnGrid::undoBlow() {
+  if (blowHistory.empty()) {
+    return false;
+  }
+  if (blowHistory.back().repeats > 0) {
+    blowHistory.back().repeats--;
+    return true;
+  }
+  BlowRecord record = blowHistory.back();
+  blowHistory.pop_back();
+
+  if (!record.newShot) {
+    return true;
+  }
+
+  if (record.newSquare) {
+    shotAt.erase(shotLog.back());
+  }
+  shotLog.pop_back();
+
+  if (record.cell >= 0) {
+    clearBit(shotMask, record.cell);
+    int slot = cellOwner[record.cell];
+    if (slot >= 0) {
+      shipHits[slot]--;
     }
   }
+  return true;
+}
 
-  // return miss
-  return Shot::NONE;
+const std::pmr::map<int, int> &OwnGrid::getAvailableShips() const {
+  return availableShips;
 }
 
-const std::set<GridPosition> &OwnGrid::getShotAt() const { return shotAt; }
+const std::pmr::vector<uint64_t> &OwnGrid::getBlockedMask() const {
+  return blockedMask;
+}
+
+const std::pmr::vector<uint64_t> &OwnGrid::getOccupiedMask() const {
+  return occupiedMask;
+}
+
+const std::pmr::vector<uint64_t> &OwnGrid::getShotMask() const {
+  return shotMask;
+}
+
+Span<const GridPosition> OwnGrid::getShotLog() const { return shotLog; }
+
+const std::pmr::set<GridPosition> &OwnGrid::getShotAt() const {
+  return shotAt;
+}
@@ -9,9 +9,13 @@
 #ifndef OWNGRID_H_
 #define OWNGRID_H_
 
+#include "NodePool.h"
 #include "Ship.h"
 #include "Shot.h"
+#include "Span.h"
+#include <cstdint>
 #include <map>
+#include <memory_resource>
 #include <set>
 #include <vector>
 
@@ -21,15 +25,91 @@
  *
  * Tracks your ships and where you've been hit. It enforces rules
  * for ship placement.
+ *
+ * Rows are single letters, so a grid has at most 26 rows. Taller boards
+ * need LargeOwnGrid.
+ *
+ * All containers take their memory from the std::pmr::memory_resource given
+ * to the constructor (the normal heap if none is given). A copy of a grid
+ * always uses the normal heap.
+ *
+ * The nodes of the shot set come from a NodePool with one block per square,
+ * so taking shots, undoing them and reset() never allocate either.
  */
 class OwnGrid {
 private:
   int rows;    ///< Total rows (usually 10)
   int columns; ///< Total columns (usually 10)
 
-  std::vector<Ship> ships;           ///< Our placed fleet
-  std::set<GridPosition> shotAt;     ///< Where the opponent shot us
-  std::map<int, int> availableShips; ///< How many of each ship type are left
+  std::pmr::vector<Ship> ships;           ///< Our placed fleet
+  std::pmr::map<int, int> availableShips; ///< Ships of each length left
+
+  std::pmr::vector<GridPosition> shotLog; ///< Every new shot, in arrival order
+  NodePool shotNodes; ///< Nodes for shotAt, one per square (declared first)
+  std::pmr::set<GridPosition> shotAt; ///< Every square in shotLog, sorted
+
+  // Bitboard engine: one bit per cell, cell index = rowIdx * columns + colIdx.
+  // Both masks are sized once in the constructor and never grow.
+  std::pmr::vector<uint64_t> occupiedMask; ///< Cells covered by a placed ship
+  std::pmr::vector<uint64_t> blockedMask;  ///< Cells covered by ship or halo
+  std::pmr::vector<uint64_t> shotMask;     ///< Cells already shot at
+
+  std::pmr::vector<int> cellOwner; ///< Index into 'ships' per cell, -1 = water
+  std::pmr::vector<int> shipHits;  ///< Distinct hits taken by each ship so far
+
+  /**
+   * @brief What one takeBlow() changed, so undoBlow() can put it back.
+   */
+  struct BlowRecord {
+    int cell;       ///< Square index, or -1 for a shot off the grid
+    bool newShot;   ///< True if the shot was added to the shot log
+    bool newSquare; ///< True if the square was added to the shot set
+    int repeats;    ///< Repeated shots taken after this one
+  };
+  std::pmr::vector<BlowRecord> blowHistory; ///< Undo stack, newest last
+
+  /**
+   * @brief Push the record of a shot, or count a repeated shot on the
+   * newest record.
+   */
+  void recordBlow(int cell, bool newShot, bool newSquare);
+
+  /**
+   * @brief Turn a position into its bit index, or -1 if it is off the grid.
+   */
+  int cellIndex(const GridPosition &position) const;
+
+  /**
+   * @brief Check a single bit of one of our masks.
+   */
+  static bool testBit(const std::pmr::vector<uint64_t> &mask, int index);
+
+  /**
+   * @brief Set a single bit of one of our masks.
+   */
+  static void setBit(std::pmr::vector<uint64_t> &mask, int index);
+
+  /**
+   * @brief Clear a single bit of one of our masks.
+   */
+  static void clearBit(std::pmr::vector<uint64_t> &mask, int index);
+
+  /**
+   * @brief What the placement checks found, in the order they run.
+   */
+  enum PlacementResult {
+    PLACEMENT_OK,  ///< The ship may be placed
+    INVALID_SHIP,  ///< Not straight or a bad length
+    NO_INVENTORY,  ///< No ship of that length left
+    OUT_OF_BOUNDS, ///< Not on the grid
+    TOO_CLOSE      ///< Touches or overlaps a ship
+  };
+
+  /**
+   * @brief The placement checks behind canPlaceShip().
+   * @return PLACEMENT_OK, or the first rule that was broken.
+   */
+  PlacementResult checkPlacement(const Ship &ship) const;
 
 public:
   /**
@@ -39,8 +119,42 @@ public:
 
   /**
    * @brief Create a grid with specific dimensions.
+   * @param resource Where the grid's containers get their memory.
+   */
+  OwnGrid(int rows, int columns,
+          std::pmr::memory_resource *resource =
+              std::pmr::get_default_resource());
+
+  /**
+   * @brief Create a grid with its own fleet inventory.
+   * @param fleet How many ships of each length may be placed. Ship::isValid()
+   * still only allows lengths 2 to 5.
+   * @param resource Where the grid's containers get their memory.
+   */
+  OwnGrid(int rows, int columns, const std::map<int, int> &fleet,
+          std::pmr::memory_resource *resource =
+              std::pmr::get_default_resource());
+
+  /**
+   * @brief Copy a grid, ships, shots, undo history and all, onto the normal
+   * heap.
    */
-  OwnGrid(int rows, int columns);
+  OwnGrid(const OwnGrid &other);
+
+  /**
+   * @brief Copy another grid's state into this one. This grid keeps its own
+   * memory resource.
+   */
+  OwnGrid &operator=(const OwnGrid &other);
+
+  /**
+   * @brief Remove every ship and shot and refill the inventory, keeping the
+   * size and the memory of all containers.
+   *
+   * Afterwards the grid works exactly like a new one, but placing a fleet
+   * and taking shots doesn't allocate anything.
+   */
+  void reset();
 
   /**
    * @brief Get height of the board.
@@ -52,6 +166,12 @@ public:
    */
   int getColumns() const;
 
+  /**
+   * @brief Check if a ship could be placed, without placing it.
+   * @return True if placeShip() would accept the ship.
+   */
+  bool canPlaceShip(const Ship &ship) const;
+
   /**
    * @brief Try to place a ship on the board.
    * @return True if placement was legal and successful.
@@ -60,19 +180,96 @@ public:
 
   /**
    * @brief Get the list of all our placed ships.
+   *
+   * This is a copy; getShipView() gives the same ships without one.
    */
   std::vector<Ship> getShips() const;
 
+  /**
+   * @brief All our placed ships, in the order they were placed.
+   *
+   * A view of the grid's own list, so nothing is copied. It stays valid
+   * until the next placeShip() or reset().
+   */
+  Span<const Ship> getShipView() const;
+
+  /**
+   * @brief Number of ships placed.
+   */
+  int getShipCount() const;
+
   /**
    * @brief Process a shot from the opponent.
+   *
+   * Runs in constant time: one owner lookup and one counter compare. Shooting
+   * the same square twice doesn't count as a second hit.
    * @return NONE, HIT, or SUNKEN.
    */
   Shot::Impact takeBlow(const Shot &shot);
 
+  /**
+   * @brief Take back the most recent takeBlow(), as if it never happened.
+   *
+   * Every takeBlow() leaves a small note on an undo stack (a repeated shot
+   * only adds to the count on the newest note), so a search can try a shot
+   * and roll it back without copying the grid. Runs in constant time and
+   * never allocates memory.
+   * @return False if there was nothing left to undo.
+   */
+  bool undoBlow();
+
+  /**
+   * @brief Process a whole salvo of shots from the opponent.
+   *
+   * Gives exactly the same answers as calling takeBlow() for each shot in
+   * order (so a square that shows up twice is only hit once), and each shot
+   * can be undone with undoBlow() as usual.
+   * @param shots The shots, in the order they are fired.
+   * @param impacts Receives one impact per shot; only the first
+   * min(shots.size(), impacts.size()) shots are processed.
+   * @return Number of shots processed.
+   */
+  std::size_t takeBlows(Span<const Shot> shots, Span<Shot::Impact> impacts);
+
+  /**
+   * @brief How many ships of each length (key) are still left to place.
+   */
+  const std::pmr::map<int, int> &getAvailableShips() const;
+
+  /**
+   * @brief Bitboard of every square a new ship may not cover (placed ships
+   * plus their buffer zones), one bit per square in row-major order.
+   */
+  const std::pmr::vector<uint64_t> &getBlockedMask() const;
+
+  /**
+   * @brief Bitboard of every square covered by a placed ship.
+   */
+  const std::pmr::vector<uint64_t> &getOccupiedMask() const;
+
+  /**
+   * @brief Bitboard of every square on the grid the opponent has shot at
+   * (shots that landed off the grid are only in getShotAt()).
+   */
+  const std::pmr::vector<uint64_t> &getShotMask() const;
+
+  /**
+   * @brief Every square the opponent shot at, in the order the shots
+   * arrived (a repeated square only once, shots off the grid every time).
+   *
+   * A view of the grid's own log: unlike getShotAt(), nothing is sorted or
+   * copied. It stays valid until the next shot, undoBlow() or reset().
+   */
+  Span<const GridPosition> getShotLog() const;
+
   /**
    * @brief Get the set of all coordinates where the opponent shot us.
+   *
+   * Every new square is put into the set as the shot lands, so this only
+   * hands out a reference. New code should prefer getShotMask() or
+   * getShotLog(), which don't need a tree lookup per shot.
    */
-  const std::set<GridPosition> &getShotAt() const;
+  const std::pmr::set<GridPosition> &getShotAt() const;
 };
 
 #endif /* OWNGRID_H_ */
@@ -0,0 +1,210 @@
+/**
+ * @file PlacementTable.h
+ * @brief Header for the PlacementTable class template.
+ *
+ * Every way a ship can lie on a board, worked out once by the compiler.
+ */
+
+#ifndef PLACEMENTTABLE_H_
+#define PLACEMENTTABLE_H_
+
+#include "BitMask.h"
+#include "Ship.h"
+
+/**
+ * @class PlacementTable
+ * @brief All (length, orientation, origin) placements on a Rows x Columns
+ * board, each with a ready-made occupancy mask and halo mask.
+ *
+ * The masks are built from Ship::occupiedCells() and Ship::blockedCells(),
+ * so they follow exactly the same geometry rules as OwnGrid. Bits use the
+ * row-major square index (GridPosition::toIndex). The halo is clipped to the
+ * board and includes the ship's own squares.
+ *
+ * For each length, horizontal placements come first (origins in row-major
+ * order), then vertical ones. The lengths default to the standard 2 to 5;
+ * GameRules passes the lengths of its own fleet.
+ */
+template <int Rows, int Columns, int MinLength = 2, int MaxLength = 5>
+class PlacementTable {
+public:
+  static constexpr int ROWS = Rows;               ///< Board height
+  static constexpr int COLUMNS = Columns;         ///< Board width
+  static constexpr int CELLS = Rows * Columns;    ///< Squares on the board
+  static constexpr int WORDS = (CELLS + 63) / 64; ///< Mask width in words
+  static constexpr int MIN_LENGTH = MinLength;    ///< Shortest legal ship
+  static constexpr int MAX_LENGTH = MaxLength;    ///< Longest legal ship
+
+  typedef BitMask<WORDS> Mask; ///< One bit per square of this board
+
+  /**
+   * @brief One way to put a ship on the board.
+   */
+  struct Placement {
+    Mask occupied;      ///< Squares the ship covers
+    Mask halo;          ///< Squares the ship covers or touches
+    GridPosition bow;   ///< Top/left end
+    GridPosition stern; ///< Bottom/right end
+  };
+
+  /**
+   * @brief Number of horizontal placements for one ship length.
+   */
+  static constexpr int horizontalCount(int length) {
+    return (Columns >= length) ? Rows * (Columns - length + 1) : 0;
+  }
+
+  /**
+   * @brief Number of placements for one ship length.
+   */
+  static constexpr int countFor(int length) {
+    int vertical = (Rows >= length) ? Columns * (Rows - length + 1) : 0;
+    return horizontalCount(length) + vertical;
+  }
+
+  /**
+   * @brief Number of placements for all legal lengths together.
+   */
+  static constexpr int totalCount() {
+    int total = 0;
+    for (int length = MIN_LENGTH; length <= MAX_LENGTH; length++) {
+      total += countFor(length);
+    }
+    return total;
+  }
+
+  static constexpr int SIZE = totalCount(); ///< Placements in the table
+
+private:
+  int offsets[MAX_LENGTH + 2]; ///< Where each length starts in 'placements'
+  Placement placements[SIZE];  ///< The whole table
+
+  /**
+   * @brief Fill in the masks for the ship between 'bow' and 'stern'.
+   */
+  static constexpr Placement makePlacement(const GridPosition &bow,
+                                           const GridPosition &stern) {
+    Placement placement{};
+    placement.bow = bow;
+    placement.stern = stern;
+
+    Ship ship(bow, stern);
+    GridArea occupied = ship.occupiedCells();
+    for (GridArea::Iterator posIt = occupied.begin(); posIt != occupied.end();
+         ++posIt) {
+      placement.occupied.set((*posIt).toIndex(Columns));
+    }
+
+    GridArea blocked = ship.blockedCells();
+    for (GridArea::Iterator posIt = blocked.begin(); posIt != blocked.end();
+         ++posIt) {
+      int rowIdx = (*posIt).getRow() - 'A';
+      int colIdx = (*posIt).getColumn() - 1;
+      if (rowIdx >= 0 && rowIdx < Rows && colIdx >= 0 && colIdx < Columns) {
+        placement.halo.set(rowIdx * Columns + colIdx);
+      }
+    }
+    return placement;
+  }
+
+public:
+  /**
+   * @brief Build the table (meant to be evaluated by the compiler).
+   */
+  constexpr PlacementTable() : offsets(), placements() {
+    int next = 0;
+    for (int length = 0; length <= MAX_LENGTH + 1; length++) {
+      offsets[length] = (length < MIN_LENGTH) ? 0 : next;
+      if (length < MIN_LENGTH || length > MAX_LENGTH) {
+        continue;
+      }
+
+      for (int rowIdx = 0; rowIdx < Rows; rowIdx++) {
+        for (int colIdx = 0; colIdx + length <= Columns; colIdx++) {
+          placements[next++] =
+              makePlacement(GridPosition(char('A' + rowIdx), colIdx + 1),
+                            GridPosition(char('A' + rowIdx), colIdx + length));
+        }
+      }
+      for (int rowIdx = 0; rowIdx + length <= Rows; rowIdx++) {
+        for (int colIdx = 0; colIdx < Columns; colIdx++) {
+          placements[next++] = makePlacement(
+              GridPosition(char('A' + rowIdx), colIdx + 1),
+              GridPosition(char('A' + rowIdx + length - 1), colIdx + 1));
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Number of placements stored for a ship length (0 if the length
+   * isn't legal).
+   */
+  constexpr int count(int length) const {
+    if (length < MIN_LENGTH || length > MAX_LENGTH) {
+      return 0;
+    }
+    return offsets[length + 1] - offsets[length];
+  }
+
+  /**
+   * @brief First placement for a ship length.
+   */
+  constexpr const Placement *begin(int length) const {
+    return placements + offsets[length];
+  }
+
+  /**
+   * @brief One past the last placement for a ship length.
+   */
+  constexpr const Placement *end(int length) const {
+    return placements + offsets[length] + count(length);
+  }
+
+  /**
+   * @brief Get a placement by its position in the whole table.
+   */
+  constexpr const Placement &operator[](int index) const {
+    return placements[index];
+  }
+
+  /**
+   * @brief Find the table entry for a ship in O(1).
+   * @return Index into the table, or -1 if the ship isn't a legal placement
+   * on this board.
+   */
+  constexpr int indexOf(const Ship &ship) const {
+    int length = ship.length();
+    GridArea occupied = ship.occupiedCells();
+    int rowIdx = occupied.getFirstRow() - 'A';
+    int colIdx = occupied.getFirstColumn() - 1;
+    bool horizontal = ship.getBow().getRow() == ship.getStern().getRow();
+    bool vertical = ship.getBow().getColumn() == ship.getStern().getColumn();
+
+    if (length < MIN_LENGTH || length > MAX_LENGTH ||
+        (!horizontal && !vertical) || rowIdx < 0 || colIdx < 0) {
+      return -1;
+    }
+
+    if (horizontal) {
+      if (rowIdx >= Rows || colIdx + length > Columns) {
+        return -1;
+      }
+      return offsets[length] + rowIdx * (Columns - length + 1) + colIdx;
+    }
+
+    if (rowIdx + length > Rows || colIdx >= Columns) {
+      return -1;
+    }
+    return offsets[length] + horizontalCount(length) + rowIdx * Columns +
+           colIdx;
+  }
+};
+
+/**
+ * @brief All placements on the standard 10x10 board, computed at compile
+ * time.
+ */
+inline constexpr PlacementTable<10, 10> STANDARD_PLACEMENTS{};
+
+#endif /* PLACEMENTTABLE_H_ */
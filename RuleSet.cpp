@@ -0,0 +1,38 @@
+/**
+ * @file RuleSet.cpp
+ * @brief Implementation of the RuleSet class.
+ */
+
+#include "RuleSet.h"
+
+namespace {
+
+const RuleSetFor<GermanRules> GERMAN("german");    ///< OwnGrid's default
+const RuleSetFor<ClassicRules> CLASSIC("classic"); ///< Milton Bradley fleet
+const RuleSetFor<SmallRules> SMALL("small");       ///< 8x8
+
+const RuleSet *const ALL_RULES[] = {&GERMAN, &CLASSIC, &SMALL};
+const int RULES_COUNT = sizeof(ALL_RULES) / sizeof(ALL_RULES[0]);
+
+} // namespace
+
+Board RuleSet::makeBoard() const {
+  return Board(getRows(), getColumns(), getFleet());
+}
+
+const RuleSet *RuleSet::find(const std::string &name) {
+  for (int rulesIdx = 0; rulesIdx < RULES_COUNT; rulesIdx++) {
+    if (name == ALL_RULES[rulesIdx]->getName()) {
+      return ALL_RULES[rulesIdx];
+    }
+  }
+  return 0;
+}
+
+std::vector<std::string> RuleSet::getNames() {
+  std::vector<std::string> names;
+  for (int rulesIdx = 0; rulesIdx < RULES_COUNT; rulesIdx++) {
+    names.push_back(ALL_RULES[rulesIdx]->getName());
+  }
+  return names;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file RuleSet.h
+ * @brief Header for the RuleSet class.
+ *
+ * Picks one of the compiled-in GameRules by name while the program runs.
+ */
+
+#ifndef RULESET_H_
+#define RULESET_H_
+
+#include "Board.h"
+#include "FixedOwnGrid.h"
+#include "Span.h"
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @class RuleSet
+ * @brief A set of GameRules chosen at run time.
+ *
+ * The rules are template parameters, so code built on them has to know
+ * them when it is compiled. RuleSet is the bridge for programs that read
+ * the rules from the command line: find() looks up one of the common rule
+ * sets, and every call then goes through one virtual function into code
+ * that was compiled for exactly those rules (RuleSetFor<Rules>). Do the
+ * expensive work in one call (a whole fleet, a whole list of shots), so the
+ * virtual call is paid once and not per shot.
+ */
+class RuleSet {
+public:
+  virtual ~RuleSet() {}
+
+  /**
+   * @brief Short name, as find() takes it ("german", "classic", "small").
+   */
+  virtual const char *getName() const = 0;
+
+  /**
+   * @brief Height of the board.
+   */
+  virtual int getRows() const = 0;
+
+  /**
+   * @brief Width of the board.
+   */
+  virtual int getColumns() const = 0;
+
+  /**
+   * @brief Ships allowed per length.
+   */
+  virtual std::map<int, int> getFleet() const = 0;
+
+  /**
+   * @brief Is this a complete, legal fleet for these rules?
+   */
+  virtual bool checkFleet(Span<const Ship> fleet) const = 0;
+
+  /**
+   * @brief Place a fleet on a FixedOwnGrid and answer a list of shots.
+   * @return Number of answers written, 0 if the fleet isn't legal.
+   */
+  virtual std::size_t takeBlows(Span<const Ship> fleet, Span<const Shot> shots,
+                                Span<Shot::Impact> impacts) const = 0;
+
+  /**
+   * @brief A Board of the right size whose OwnGrid has this fleet.
+   */
+  Board makeBoard() const;
+
+  /**
+   * @brief Look up a rule set by name.
+   * @return The rule set, or 0 if there is none with that name.
+   */
+  static const RuleSet *find(const std::string &name);
+
+  /**
+   * @brief Names of all rule sets find() knows.
+   */
+  static std::vector<std::string> getNames();
+};
+
+/**
+ * @class RuleSetFor
+ * @brief The RuleSet for one GameRules type.
+ */
+template <typename Rules> class RuleSetFor : public RuleSet {
+private:
+  const char *name; ///< Name given to find()
+
+public:
+  /**
+   * @brief Give the rules a name.
+   */
+  explicit RuleSetFor(const char *name) { this->name = name; }
+
+  const char *getName() const override { return name; }
+
+  int getRows() const override { return Rules::ROWS; }
+
+  int getColumns() const override { return Rules::COLUMNS; }
+
+  std::map<int, int> getFleet() const override { return Rules::fleet(); }
+
+  bool checkFleet(Span<const Ship> fleet) const override {
+    FixedOwnGrid<Rules> grid;
+    for (std::size_t shipIdx = 0; shipIdx < fleet.size(); shipIdx++) {
+      if (!grid.placeShip(fleet[shipIdx])) {
+        return false;
+      }
+    }
+    return grid.isFleetComplete();
+  }
+
+  std::size_t takeBlows(Span<const Ship> fleet, Span<const Shot> shots,
+                        Span<Shot::Impact> impacts) const override {
+    FixedOwnGrid<Rules> grid;
+    for (std::size_t shipIdx = 0; shipIdx < fleet.size(); shipIdx++) {
+      if (!grid.placeShip(fleet[shipIdx])) {
+        return 0;
+      }
+    }
+
+    std::size_t count =
+        (shots.size() < impacts.size()) ? shots.size() : impacts.size();
+    for (std::size_t shotIdx = 0; shotIdx < count; shotIdx++) {
+      impacts[shotIdx] = grid.takeBlow(shots[shotIdx]);
+    }
+    return count;
+  }
+};
+
+#endif /* RULESET_H_ */
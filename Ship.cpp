@@ -7,16 +7,6 @@
  */
 
 #include "Ship.h"
-#include <algorithm>
-#include <cstdlib>
-
-/**
- * Creates a ship by defining its two endpoints (the bow and the stern).
- */
-Ship::Ship(const GridPosition &bow, const GridPosition &stern) {
-  this->bow = bow;
-  this->stern = stern;
-}
 
 /**
  * Checks if a ship is built correctly according to the rules:
@@ -46,79 +36,22 @@ bool Ship::isValid() const {
   return true;
 }
 
-GridPosition Ship::getBow() const { return bow; }
-
-GridPosition Ship::getStern() const { return stern; }
-
-/**
- * Calculates how many squares the ship covers.
- * We subtract coordinates and add 1 (since both ends count).
- */
-int Ship::length() const {
-  if (bow.getRow() == stern.getRow()) {
-    // Thinking horizontally: difference between columns
-    int colDiff = stern.getColumn() - bow.getColumn();
-    return std::abs(colDiff) + 1;
-  } else {
-    // Thinking vertically: difference between rows
-    int rowDiff = stern.getRow() - bow.getRow();
-    return std::abs(rowDiff) + 1;
-  }
-}
-
 /**
  * Returns a set of every individual square the ship physically occupies.
  */
 std::set<GridPosition> Ship::occupiedArea() const {
-  std::set<GridPosition> occupied;
-
-  if (bow.getRow() == stern.getRow()) {
-    // Loop through the columns from the smaller to the larger coordinate
-    int startCol = std::min(bow.getColumn(), stern.getColumn());
-    int endCol = std::max(bow.getColumn(), stern.getColumn());
-
-    for (int col = startCol; col <= endCol; col++) {
-      occupied.insert(GridPosition(bow.getRow(), col));
-    }
-  } else {
-    // Loop through the rows from the 'smaller' to the 'larger' letter
-    char startRow = std::min(bow.getRow(), stern.getRow());
-    char endRow = std::max(bow.getRow(), stern.getRow());
-
-    for (char currentRow = startRow; currentRow <= endRow; currentRow++) {
-      occupied.insert(GridPosition(currentRow, bow.getColumn()));
-    }
-  }
-
-  return occupied;
+  GridArea cells = occupiedCells();
+  return std::set<GridPosition>(cells.begin(), cells.end());
 }
 
 /**
  * Returns the ship's occupied area and all the squares right next to it.
  * This is used to make sure ships don't touch each other.
+ *
+ * Here we do not worry about being out of bounds or invalid values, because
+ * the GridPosition constructor handles safe/invalid values.
  */
 std::set<GridPosition> Ship::blockedArea() const {
-  std::set<GridPosition> blocked;
-  std::set<GridPosition> occupied = occupiedArea();
-
-  // For every single square of the ship, we 'look' at all 8 neighbors
-  for (std::set<GridPosition>::const_iterator occupiedIt = occupied.begin();
-       occupiedIt != occupied.end(); ++occupiedIt) {
-    const GridPosition &gridPos = *occupiedIt;
-
-    // Use a nested loop to check offsets of -1, 0, and +1 for both row and col
-    for (int rowOffset = -1; rowOffset <= 1; rowOffset++) {
-      for (int colOffset = -1; colOffset <= 1; colOffset++) {
-        char newRow = gridPos.getRow() + rowOffset;
-        int newCol = gridPos.getColumn() + colOffset;
-
-        // here we do not worry about being out of bounds or invalid values
-        // here, because the GridPosition constructor handles safe/invalid
-        // values.
-        blocked.insert(GridPosition(newRow, newCol));
-      }
-    }
-  }
-
-  return blocked;
+  GridArea cells = blockedCells();
+  return std::set<GridPosition>(cells.begin(), cells.end());
 }
@@ -9,6 +9,7 @@
 #ifndef SHIP_H_
 #define SHIP_H_
 
+#include "GridArea.h"
 #include "GridPosition.h"
 #include <set>
 
@@ -28,7 +29,8 @@ public:
   /**
    * @brief Create a ship from a bow and stern position.
    */
-  Ship(const GridPosition &bow, const GridPosition &stern);
+  constexpr Ship(const GridPosition &bow, const GridPosition &stern)
+      : bow(bow), stern(stern) {}
 
   /**
    * @brief Check if the ship follows the placement rules (straight, valid
@@ -37,19 +39,26 @@ public:
   bool isValid() const;
 
   /**
-   * @brief Get the bow (start) position.
+   * @brief Get the bow (start) position (a reference, nothing is copied).
    */
-  GridPosition getBow() const;
+  constexpr const GridPosition &getBow() const { return bow; }
 
   /**
-   * @brief Get the stern (end) position.
+   * @brief Get the stern (end) position (a reference, nothing is copied).
    */
-  GridPosition getStern() const;
+  constexpr const GridPosition &getStern() const { return stern; }
 
   /**
    * @brief Calculate how many squares the ship is long.
+   *
+   * We subtract coordinates and add 1 (since both ends count).
    */
-  int length() const;
+  constexpr int length() const {
+    int diff = (bow.getRow() == stern.getRow())
+                   ? stern.getColumn() - bow.getColumn() // horizontally
+                   : stern.getRow() - bow.getRow();      // vertically
+    return (diff < 0 ? -diff : diff) + 1;
+  }
 
   /**
    * @brief Get every single coordinate the ship physically covers.
@@ -60,6 +69,46 @@ public:
    * @brief Get the ship's area plus all surrounding neighbor squares.
    */
   std::set<GridPosition> blockedArea() const;
+
+  /**
+   * @brief Same squares as occupiedArea(), but as a range that is walked
+   * without allocating anything.
+   *
+   * A ship on one row covers the columns between bow and stern; any other
+   * ship covers the rows between them in the bow's column. For a straight
+   * ship that is exactly the squares it covers, and a diagonal (invalid)
+   * ship gets the same squares as occupiedArea() always gave it.
+   */
+  constexpr GridArea occupiedCells() const {
+    if (bow.getRow() == stern.getRow()) {
+      return GridArea(bow.getRow(),
+                      bow.getColumn() < stern.getColumn() ? bow.getColumn()
+                                                          : stern.getColumn(),
+                      bow.getRow(),
+                      bow.getColumn() < stern.getColumn() ? stern.getColumn()
+                                                          : bow.getColumn());
+    }
+    return GridArea(bow.getRow() < stern.getRow() ? bow.getRow()
+                                                  : stern.getRow(),
+                    bow.getColumn(),
+                    bow.getRow() < stern.getRow() ? stern.getRow()
+                                                  : bow.getRow(),
+                    bow.getColumn());
+  }
+
+  /**
+   * @brief Same squares as blockedArea(), but as a range that is walked
+   * without allocating anything. Like blockedArea(), it can reach past the
+   * board edge.
+   *
+   * Looking at all 8 neighbors of every ship square gives the same result as
+   * growing the ship's rectangle by one square on every side.
+   */
+  constexpr GridArea blockedCells() const {
+    GridArea occupied = occupiedCells();
+    return GridArea(occupied.getFirstRow() - 1, occupied.getFirstColumn() - 1,
+                    occupied.getLastRow() + 1, occupied.getLastColumn() + 1);
+  }
 };
 
 #endif /* SHIP_H_ */
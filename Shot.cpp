@@ -11,5 +11,3 @@
 Shot::Shot(GridPosition targetPosition) {
   this->targetPosition = targetPosition;
 }
-
-GridPosition Shot::getTargetPosition() const { return targetPosition; }
@@ -36,8 +36,11 @@ public:
 
   /**
    * @brief Get the location being attacked.
+   *
+   * Defined here so the grids' shot loops can inline it, and returned as a
+   * reference, so nothing is copied.
    */
-  GridPosition getTargetPosition() const;
+  const GridPosition &getTargetPosition() const { return targetPosition; }
 };
 
 #endif /* SHOT_H_ */
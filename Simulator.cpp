@@ -0,0 +1,188 @@
+/**
+ * @file Simulator.cpp
+ * @brief Implementation of the Simulator class.
+ */
+
+#include "Simulator.h"
+#include "Board.h"
+#include "FleetGenerator.h"
+#include "GameArena.h"
+#include "GameLog.h"
+#include "TargetingEngine.h"
+#include "Trace.h"
+#include "WorkStealingPool.h"
+#include <chrono>
+#include <memory>
+
+namespace {
+
+const int GAMES_PER_TASK = 16; ///< Games handed out to a worker at once
+
+} // namespace
+
+double SimulationReport::gamesPerSecond() const {
+  return (seconds > 0) ? games / seconds : 0;
+}
+
+double SimulationReport::meanShots() const {
+  long total = 0;
+  long count = 0;
+  for (std::size_t shots = 0; shots < shotsToWin.size(); shots++) {
+    total += long(shots) * shotsToWin[shots];
+    count += shotsToWin[shots];
+  }
+  return (count > 0) ? double(total) / count : 0;
+}
+
+int SimulationReport::shotsPercentile(double fraction) const {
+  long count = 0;
+  for (std::size_t shots = 0; shots < shotsToWin.size(); shots++) {
+    count += shotsToWin[shots];
+  }
+
+  long seen = 0;
+  for (std::size_t shots = 0; shots < shotsToWin.size(); shots++) {
+    seen += shotsToWin[shots];
+    if (seen > 0 && seen >= fraction * count) {
+      return shots;
+    }
+  }
+  return 0;
+}
+
+Simulator::Simulator(int rows, int columns, uint64_t seed) {
+  this->rows = rows;
+  this->columns = columns;
+  this->seed = seed;
+}
+
+/**
+ * Mixes the game number into the seed (the 'splitmix64' recipe), so that
+ * neighbouring games get completely different random sequences.
+ */
+uint64_t Simulator::gameSeed(int game) const {
+  uint64_t mixed = seed + (uint64_t(game) + 1) * 0x9E3779B97F4A7C15ULL;
+  mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBULL;
+  return mixed ^ (mixed >> 31);
+}
+
+GameResult Simulator::playGame(uint64_t gameSeed, GameLogWriter *log) const {
+  return play(gameSeed, std::pmr::get_default_resource(), log);
+}
+
+GameResult Simulator::playGame(uint64_t gameSeed, GameArena &arena,
+                               GameLogWriter *log) const {
+  arena.reset();
+  return play(gameSeed, arena.getResource(), log);
+}
+
+/**
+ * Sets up two boards and lets the players take turns until one of them has
+ * sunk every enemy ship.
+ */
+GameResult Simulator::play(uint64_t gameSeed,
+                           std::pmr::memory_resource *resource,
+                           GameLogWriter *log) const {
+  Trace::Span gameSpan("Simulator::playGame");
+  Board boards[2] = {Board(rows, columns, resource),
+                     Board(rows, columns, resource)};
+  TargetingEngine engines[2] = {TargetingEngine(resource),
+                                TargetingEngine(resource)};
+  int sunk[2] = {0, 0};
+  int fired[2] = {0, 0};
+
+  FleetGenerator generator(gameSeed);
+  for (int player = 0; player < 2; player++) {
+    generator.fill(boards[player].getOwnGrid());
+  }
+  int fleetSize[2] = {boards[0].getOwnGrid().getShipCount(),
+                      boards[1].getOwnGrid().getShipCount()};
+  if (log != 0) {
+    log->beginGame(gameSeed, boards[0].getOwnGrid(), boards[1].getOwnGrid());
+  }
+
+  GameResult result;
+  result.winner = -1;
+  result.shots = 0;
+
+  int player = gameSeed & 1;
+  int maxShots = rows * columns;
+  while (fired[0] < maxShots || fired[1] < maxShots) {
+    int enemy = 1 - player;
+    OpponentGrid &tracker = boards[player].getOpponentGrid();
+    Trace::Span turnSpan("turn", fired[0] + fired[1] + 1);
+
+    Shot shot(engines[player].chooseTarget(tracker));
+    Shot::Impact impact = boards[enemy].getOwnGrid().takeBlow(shot);
+    tracker.shotResult(shot, impact);
+    fired[player]++;
+    if (log != 0) {
+      log->addShot(player, shot, impact);
+    }
+
+    if (impact == Shot::SUNKEN) {
+      sunk[player]++;
+      if (sunk[player] == fleetSize[enemy]) {
+        result.winner = player;
+        result.shots = fired[player];
+        break;
+      }
+    }
+    player = enemy;
+  }
+
+  if (log != 0) {
+    log->endGame();
+  }
+  return result;
+}
+
+/**
+ * Chops the games into tasks of a few games each. Every worker keeps its
+ * own results in the slots of the games it played, and plays them in its
+ * own arena, so nothing is shared while the games run; the report is put
+ * together afterwards.
+ */
+SimulationReport Simulator::run(int games, int threads,
+                                std::vector<GameResult> *results) const {
+  std::vector<GameResult> played(games > 0 ? games : 0);
+
+  WorkStealingPool pool(threads);
+  int taskCount = (games + GAMES_PER_TASK - 1) / GAMES_PER_TASK;
+  std::vector<std::unique_ptr<GameArena>> arenas;
+  for (int worker = 0; worker < pool.getThreadCount(); worker++) {
+    arenas.push_back(std::unique_ptr<GameArena>(new GameArena()));
+  }
+
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  pool.run(taskCount, [this, games, &played, &arenas](int task, int worker) {
+    int first = task * GAMES_PER_TASK;
+    for (int game = first; game < first + GAMES_PER_TASK && game < games;
+         game++) {
+      played[game] = playGame(gameSeed(game), *arenas[worker]);
+    }
+  });
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  SimulationReport report;
+  report.games = played.size();
+  report.threads = pool.getThreadCount();
+  report.seconds = elapsed.count();
+  report.wins[0] = 0;
+  report.wins[1] = 0;
+  report.shotsToWin.assign(rows * columns + 1, 0);
+  for (std::size_t game = 0; game < played.size(); game++) {
+    if (played[game].winner >= 0) {
+      report.wins[played[game].winner]++;
+      report.shotsToWin[played[game].shots]++;
+    }
+  }
+
+  if (results != 0) {
+    results->swap(played);
+  }
+  return report;
+}
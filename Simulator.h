@@ -0,0 +1,123 @@
+/**
+ * @file Simulator.h
+ * @brief Header for the Simulator class.
+ *
+ * Plays many complete games between two computer players.
+ */
+
+#ifndef SIMULATOR_H_
+#define SIMULATOR_H_
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+class GameArena;
+class GameLogWriter;
+
+/**
+ * @brief How one game ended.
+ */
+struct GameResult {
+  int winner; ///< 0 or 1 (-1 if nobody won, which shouldn't happen)
+  int shots;  ///< Shots the winner fired
+};
+
+/**
+ * @brief Summary of a batch of games.
+ */
+struct SimulationReport {
+  int games;       ///< Games played
+  int threads;     ///< Worker threads used
+  double seconds;  ///< Wall clock time for the whole batch
+  int wins[2];     ///< Games won by player 0 and player 1
+  std::vector<int> shotsToWin; ///< shotsToWin[n] = games won with n shots
+
+  /**
+   * @brief Games finished per second.
+   */
+  double gamesPerSecond() const;
+
+  /**
+   * @brief Average number of shots the winner needed.
+   */
+  double meanShots() const;
+
+  /**
+   * @brief Smallest n such that at least 'fraction' of the games were won
+   * with n shots or fewer (0.5 = median).
+   */
+  int shotsPercentile(double fraction) const;
+};
+
+/**
+ * @class Simulator
+ * @brief Runs self-play games on all cores.
+ *
+ * In every game both players get a random fleet (FleetGenerator, FAST mode)
+ * on their own Board and take turns firing at the square their
+ * TargetingEngine picks. A shot is resolved by the other player's
+ * OwnGrid::takeBlow() and the answer goes back into the shooter's
+ * OpponentGrid::shotResult(). The first player to sink the whole enemy fleet
+ * wins. The game's seed decides who starts: player 0 if it is even,
+ * player 1 if it is odd (so replaying a seed with playGame() gives the same
+ * game).
+ *
+ * Each game gets its own seed made from the simulator's seed and the game
+ * number, so the results are the same no matter how many threads are used
+ * or which thread played which game.
+ *
+ * run() gives every worker a GameArena. The boards and targeting engines of
+ * a game live in the worker's arena, which is reset before the next game,
+ * so after the first game a worker doesn't touch the heap any more.
+ */
+class Simulator {
+private:
+  int rows;      ///< Board height
+  int columns;   ///< Board width
+  uint64_t seed; ///< Seed the per-game seeds are made from
+
+  /**
+   * @brief Play one game with every container in 'resource'.
+   */
+  GameResult play(uint64_t gameSeed, std::pmr::memory_resource *resource,
+                  GameLogWriter *log) const;
+
+public:
+  /**
+   * @brief Create a simulator for boards of one size.
+   */
+  Simulator(int rows, int columns, uint64_t seed);
+
+  /**
+   * @brief The seed used for game number 'game'.
+   */
+  uint64_t gameSeed(int game) const;
+
+  /**
+   * @brief Play one game with the given seed.
+   * @param log If not 0, the game (both fleets and every shot) is appended
+   * to this log.
+   */
+  GameResult playGame(uint64_t gameSeed, GameLogWriter *log = 0) const;
+
+  /**
+   * @brief Play one game in an arena.
+   *
+   * Resets the arena first, so nothing built on it may still be in use. Gives
+   * the same result as playGame(gameSeed, log).
+   */
+  GameResult playGame(uint64_t gameSeed, GameArena &arena,
+                      GameLogWriter *log = 0) const;
+
+  /**
+   * @brief Play games 0..games-1 on a work-stealing pool.
+   * @param games Number of games to play.
+   * @param threads Worker threads to use.
+   * @param results If not 0, filled with each game's result, by game number.
+   */
+  SimulationReport run(int games, int threads,
+                       std::vector<GameResult> *results = 0) const;
+};
+
+#endif /* SIMULATOR_H_ */
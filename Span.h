@@ -0,0 +1,80 @@
+/**
+ * @file Span.h
+ * @brief Header for the Span class template.
+ *
+ * A view of a block of elements that lives somewhere else.
+ */
+
+#ifndef SPAN_H_
+#define SPAN_H_
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class Span
+ * @brief A pointer and a count: "these 'size()' elements, starting here".
+ *
+ * A Span doesn't own or copy anything, so handing one to a function is as
+ * cheap as handing over a pointer. It can be made from a plain array, a
+ * pointer and a count, or a vector. Use Span<const T> for read-only views.
+ * (This is a small stand-in for C++20's std::span.)
+ *
+ * Like std::span, it only converts from containers whose elements can be
+ * seen as T, so functions can be overloaded on Spans of different types.
+ */
+template <typename T> class Span {
+private:
+  T *first;          ///< The first element
+  std::size_t count; ///< Number of elements
+
+public:
+  /**
+   * @brief An empty span.
+   */
+  Span() : first(0), count(0) {}
+
+  /**
+   * @brief View 'count' elements starting at 'first'.
+   */
+  Span(T *first, std::size_t count) : first(first), count(count) {}
+
+  /**
+   * @brief View a whole array.
+   */
+  template <std::size_t N> Span(T (&array)[N]) : first(array), count(N) {}
+
+  /**
+   * @brief View all elements of a vector with any allocator, e.g. a
+   * std::pmr::vector (Span<const T> also takes a const vector).
+   */
+  template <typename Element, typename Allocator,
+            typename = typename std::enable_if<
+                std::is_convertible<Element *, T *>::value>::type>
+  Span(std::vector<Element, Allocator> &elements)
+      : first(elements.data()), count(elements.size()) {}
+
+  template <typename Element, typename Allocator,
+            typename = typename std::enable_if<
+                std::is_convertible<const Element *, T *>::value>::type>
+  Span(const std::vector<Element, Allocator> &elements)
+      : first(elements.data()), count(elements.size()) {}
+
+  /**
+   * @brief A writable span can always be read from.
+   */
+  template <typename Element,
+            typename = typename std::enable_if<
+                std::is_convertible<Element *, T *>::value>::type>
+  Span(const Span<Element> &other) : first(other.data()), count(other.size()) {}
+
+  T *data() const { return first; }
+  std::size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  T *begin() const { return first; }
+  T *end() const { return first + count; }
+  T &operator[](std::size_t index) const { return first[index]; }
+};
+
+#endif /* SPAN_H_ */
@@ -0,0 +1,241 @@
+/**
+ * @file TargetingEngine.cpp
+ * @brief Implementation of the TargetingEngine class.
+ *
+ * For every ship the opponent still has, we walk over all the ways it could
+ * lie on the board, throw out the ones that contradict our shots, and add
+ * the rest to the score of each square they cover.
+ */
+
+#include "TargetingEngine.h"
+#include "PlacementTable.h"
+
+namespace {
+
+// Square classes used by the generic scoring
+const unsigned char OPEN = 0;    ///< Not fired at yet
+const unsigned char BLOCKED = 1; ///< Miss, sunk ship or next to a sunk ship
+const unsigned char HIT = 2;     ///< Hit that isn't part of a sunk ship yet
+
+} // namespace
+
+TargetingEngine::TargetingEngine(std::pmr::memory_resource *resource)
+    : fleet(resource), heatmap(resource), cellInfo(resource) {
+  fleet[5] = 1;
+  fleet[4] = 2;
+  fleet[3] = 3;
+  fleet[2] = 4;
+}
+
+TargetingEngine::TargetingEngine(const std::map<int, int> &fleet,
+                                 std::pmr::memory_resource *resource)
+    : fleet(resource), heatmap(resource), cellInfo(resource) {
+  this->fleet.insert(fleet.begin(), fleet.end());
+}
+
+/**
+ * Takes the whole fleet and crosses off every ship we've sunk.
+ */
+void TargetingEngine::remainingShips(const OpponentGrid &grid,
+                                     int remaining[6]) const {
+  for (int length = 0; length < 6; length++) {
+    remaining[length] = 0;
+  }
+  for (std::pmr::map<int, int>::const_iterator countIt = fleet.begin();
+       countIt != fleet.end(); ++countIt) {
+    if (countIt->first >= 2 && countIt->first <= 5) {
+      remaining[countIt->first] = countIt->second;
+    }
+  }
+
+  Span<const Ship> sunken = grid.getSunkenShipView();
+  for (const Ship *shipIt = sunken.begin();
+       shipIt != sunken.end(); ++shipIt) {
+    int length = shipIt->length();
+    if (length >= 2 && length <= 5 && remaining[length] > 0) {
+      remaining[length]--;
+    }
+  }
+}
+
+/**
+ * Scores the grid, then picks the open square with the highest score.
+ */
+GridPosition TargetingEngine::chooseTarget(const OpponentGrid &grid) {
+  int columns = grid.getColumns();
+  const std::pmr::vector<unsigned char> &states = grid.getCellStates();
+  heatmap.assign(states.size(), 0);
+
+  int remaining[6];
+  remainingShips(grid, remaining);
+
+  if (grid.getRows() == STANDARD_PLACEMENTS.ROWS &&
+      columns == STANDARD_PLACEMENTS.COLUMNS) {
+    scoreStandard(grid, remaining);
+  } else {
+    scoreGeneric(grid, remaining);
+  }
+
+  // Known water always scores 0; it is only picked if nothing else is left
+  const std::pmr::vector<uint64_t> &knownEmpty = grid.getKnownEmptyMask();
+  int bestIdx = -1;
+  bool bestEmpty = true;
+  for (int cellIdx = 0; cellIdx < int(states.size()); cellIdx++) {
+    bool empty = (knownEmpty[cellIdx >> 6] >> (cellIdx & 63)) & 1;
+    if (states[cellIdx] == OpponentGrid::UNKNOWN &&
+        (bestIdx < 0 || heatmap[cellIdx] > heatmap[bestIdx] ||
+         (bestEmpty && !empty))) {
+      bestIdx = cellIdx;
+      bestEmpty = empty;
+    }
+  }
+
+  if (bestIdx < 0) {
+    return GridPosition(); // We've fired at every square already
+  }
+  return GridPosition::fromIndex(bestIdx, columns);
+}
+
+/**
+ * On a 10x10 board all the checks are mask operations on the compile-time
+ * placement table: a placement is out if its squares hit 'blocked', or if
+ * the ring around it (halo minus its own squares) hits an open hit.
+ *
+ * The grid's masks have the same layout as a PlacementTable<10, 10> mask,
+ * so the misses, the water around sunk ships and the open hits are copied
+ * over word by word.
+ */
+void TargetingEngine::scoreStandard(const OpponentGrid &grid,
+                                    const int remaining[6]) {
+  typedef PlacementTable<10, 10>::Mask Mask;
+  typedef PlacementTable<10, 10>::Placement Placement;
+
+  Mask open;
+  Mask blocked;
+  Mask hits;
+  const std::pmr::vector<unsigned char> &states = grid.getCellStates();
+  for (int cellIdx = 0; cellIdx < STANDARD_PLACEMENTS.CELLS; cellIdx++) {
+    if (states[cellIdx] == OpponentGrid::UNKNOWN) {
+      open.set(cellIdx);
+    }
+  }
+
+  const std::pmr::vector<uint64_t> &knownEmpty = grid.getKnownEmptyMask();
+  const std::pmr::vector<uint64_t> &unresolved = grid.getUnresolvedHitMask();
+  for (int wordIdx = 0; wordIdx < Mask::WORDS; wordIdx++) {
+    blocked.setWord(wordIdx, knownEmpty[wordIdx]);
+    hits.setWord(wordIdx, unresolved[wordIdx]);
+  }
+  // A square we fired at that is neither water nor an open hit belongs to a
+  // sunk ship (the bits past the last square are never part of a placement)
+  blocked |= ~(open | hits);
+
+  for (int length = STANDARD_PLACEMENTS.MIN_LENGTH;
+       length <= STANDARD_PLACEMENTS.MAX_LENGTH; length++) {
+    if (remaining[length] == 0) {
+      continue;
+    }
+
+    for (const Placement *placement = STANDARD_PLACEMENTS.begin(length);
+         placement != STANDARD_PLACEMENTS.end(length); ++placement) {
+      if (placement->occupied.intersects(blocked) ||
+          (placement->halo & ~placement->occupied).intersects(hits)) {
+        continue; // Contradicts what we know
+      }
+
+      unsigned int covered = (placement->occupied & hits).count();
+      unsigned int weight = remaining[length] * (1 + covered * HIT_WEIGHT);
+
+      Mask targets = placement->occupied & open;
+      for (int wordIdx = 0; wordIdx < Mask::WORDS; wordIdx++) {
+        uint64_t bits = targets.word(wordIdx);
+        while (bits != 0) {
+          heatmap[wordIdx * 64 + __builtin_ctzll(bits)] += weight;
+          bits &= bits - 1; // Clear the lowest set bit
+        }
+      }
+    }
+  }
+}
+
+/**
+ * The same rules for any other board size, checked square by square.
+ */
+void TargetingEngine::scoreGeneric(const OpponentGrid &grid,
+                                   const int remaining[6]) {
+  int rows = grid.getRows();
+  int columns = grid.getColumns();
+  const std::pmr::vector<unsigned char> &states = grid.getCellStates();
+
+  // Open hits and known water come from the grid's masks; any other
+  // square we fired at is part of a sunk ship
+  const std::pmr::vector<uint64_t> &knownEmpty = grid.getKnownEmptyMask();
+  const std::pmr::vector<uint64_t> &unresolved = grid.getUnresolvedHitMask();
+  cellInfo.assign(states.size(), OPEN);
+  for (std::size_t cellIdx = 0; cellIdx < states.size(); cellIdx++) {
+    if ((unresolved[cellIdx >> 6] >> (cellIdx & 63)) & 1) {
+      cellInfo[cellIdx] = HIT;
+    } else if (((knownEmpty[cellIdx >> 6] >> (cellIdx & 63)) & 1) ||
+               states[cellIdx] != OpponentGrid::UNKNOWN) {
+      cellInfo[cellIdx] = BLOCKED;
+    }
+  }
+
+  for (int length = 2; length <= 5; length++) {
+    if (remaining[length] == 0) {
+      continue;
+    }
+
+    for (int rowIdx = 0; rowIdx < rows; rowIdx++) {
+      for (int colIdx = 0; colIdx < columns; colIdx++) {
+        for (int across = 0; across < 2; across++) {
+          int lastRow = across ? rowIdx : rowIdx + length - 1;
+          int lastCol = across ? colIdx + length - 1 : colIdx;
+          if (lastRow >= rows || lastCol >= columns) {
+            continue;
+          }
+
+          // Its own squares: no miss or sunk ship, count the open hits
+          bool possible = true;
+          unsigned int covered = 0;
+          for (int row = rowIdx; row <= lastRow && possible; row++) {
+            for (int col = colIdx; col <= lastCol; col++) {
+              unsigned char info = cellInfo[row * columns + col];
+              possible = possible && info != BLOCKED;
+              covered += (info == HIT) ? 1 : 0;
+            }
+          }
+
+          // The ring around it: no open hit
+          for (int row = rowIdx - 1; row <= lastRow + 1 && possible; row++) {
+            for (int col = colIdx - 1; col <= lastCol + 1; col++) {
+              bool inside = row >= rowIdx && row <= lastRow &&
+                            col >= colIdx && col <= lastCol;
+              if (!inside && row >= 0 && row < rows && col >= 0 &&
+                  col < columns && cellInfo[row * columns + col] == HIT) {
+                possible = false;
+              }
+            }
+          }
+
+          if (!possible) {
+            continue;
+          }
+
+          unsigned int weight = remaining[length] * (1 + covered * HIT_WEIGHT);
+          for (int row = rowIdx; row <= lastRow; row++) {
+            for (int col = colIdx; col <= lastCol; col++) {
+              if (cellInfo[row * columns + col] == OPEN) {
+                heatmap[row * columns + col] += weight;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+const std::pmr::vector<unsigned int> &TargetingEngine::getHeatmap() const {
+  return heatmap;
+}
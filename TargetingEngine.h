@@ -0,0 +1,91 @@
+/**
+ * @file TargetingEngine.h
+ * @brief Header for the TargetingEngine class.
+ *
+ * Picks the next square to fire at from what an OpponentGrid knows.
+ */
+
+#ifndef TARGETINGENGINE_H_
+#define TARGETINGENGINE_H_
+
+#include "OpponentGrid.h"
+#include <map>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * @class TargetingEngine
+ * @brief Scores every square we haven't fired at by how many placements of
+ * the opponent's remaining ships could cover it.
+ *
+ * A placement is still possible if it doesn't cover a miss, doesn't cover or
+ * touch a ship we've sunk, and doesn't touch a hit that it doesn't include
+ * (ships never touch, so that hit belongs to this ship or to no ship at all).
+ * Placements that run through hits which aren't part of a sunk ship yet
+ * count extra, so a damaged ship gets finished off before we go searching
+ * again.
+ */
+class TargetingEngine {
+private:
+  std::pmr::map<int, int> fleet; ///< Ship length -> how many the opponent has
+
+  std::pmr::vector<unsigned int> heatmap; ///< Score per square, row-major
+  std::pmr::vector<unsigned char> cellInfo; ///< Scratch square classes
+
+  /**
+   * @brief How many ships of each length are still afloat (index = length).
+   */
+  void remainingShips(const OpponentGrid &grid, int remaining[6]) const;
+
+  /**
+   * @brief Fill the heatmap on a 10x10 board, using the placement table.
+   */
+  void scoreStandard(const OpponentGrid &grid, const int remaining[6]);
+
+  /**
+   * @brief Fill the heatmap on any other board size.
+   */
+  void scoreGeneric(const OpponentGrid &grid, const int remaining[6]);
+
+public:
+  /**
+   * @brief Extra weight for each unresolved hit a placement runs through.
+   */
+  static constexpr unsigned int HIT_WEIGHT = 100;
+
+  /**
+   * @brief Create an engine for the standard fleet (1x5, 2x4, 3x3, 4x2).
+   * @param resource Where the engine's containers get their memory.
+   */
+  explicit TargetingEngine(std::pmr::memory_resource *resource =
+                               std::pmr::get_default_resource());
+
+  /**
+   * @brief Create an engine for a different fleet.
+   * @param fleet Ship length (2..5) -> number of ships of that length.
+   * @param resource Where the engine's containers get their memory.
+   */
+  TargetingEngine(const std::map<int, int> &fleet,
+                  std::pmr::memory_resource *resource =
+                      std::pmr::get_default_resource());
+
+  /**
+   * @brief Score the grid and return the best square to fire at.
+   *
+   * Ties go to the first square in row-major order. If every score is zero
+   * (nothing fits any more), the first square we haven't fired at is
+   * returned, preferring squares the grid doesn't know to be water. If
+   * there is no such square, the result is not valid
+   * (GridPosition::isValid() is false).
+   */
+  GridPosition chooseTarget(const OpponentGrid &grid);
+
+  /**
+   * @brief Scores from the last chooseTarget() call, one per square in
+   * row-major order (index = rowIdx * columns + colIdx). Squares we already
+   * fired at score 0.
+   */
+  const std::pmr::vector<unsigned int> &getHeatmap() const;
+};
+
+#endif /* TARGETINGENGINE_H_ */
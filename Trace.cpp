@@ -0,0 +1,169 @@
+/**
+ * @file Trace.cpp
+ * @brief Implementation of the trace rings and the JSON output.
+ */
+
+#include "Trace.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+/**
+ * Every ring ever handed out. Rings of finished threads are kept (their
+ * events are still wanted) until clear().
+ */
+struct Registry {
+  std::mutex lock;                                 ///< Guards everything
+  std::vector<std::unique_ptr<Trace::Ring>> rings; ///< One per thread
+  std::vector<bool> finished; ///< Per ring: has its thread ended?
+  int nextThread;             ///< Number for the next thread
+
+  Registry() : nextThread(0) {}
+};
+
+Registry &registry() {
+  static Registry instance;
+  return instance;
+}
+
+/**
+ * When the trace clock started (the first time anyone asked).
+ */
+std::chrono::steady_clock::time_point epoch() {
+  static const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  return start;
+}
+
+/**
+ * One per thread: gets a ring from the registry when the thread first
+ * traces something, and marks it finished when the thread ends.
+ */
+struct ThreadHandle {
+  Trace::Ring *ring; ///< This thread's ring
+
+  ThreadHandle() {
+    Registry &shared = registry();
+    std::lock_guard<std::mutex> guard(shared.lock);
+    ring = new Trace::Ring();
+    ring->thread = shared.nextThread++;
+    shared.rings.push_back(std::unique_ptr<Trace::Ring>(ring));
+    shared.finished.push_back(false);
+  }
+
+  ~ThreadHandle() {
+    Registry &shared = registry();
+    std::lock_guard<std::mutex> guard(shared.lock);
+    for (std::size_t ringIdx = 0; ringIdx < shared.rings.size(); ringIdx++) {
+      if (shared.rings[ringIdx].get() == ring) {
+        shared.finished[ringIdx] = true;
+      }
+    }
+  }
+};
+
+/**
+ * A plain copy of one event, taken by writeJson().
+ */
+struct EventCopy {
+  const char *name;  ///< What was timed
+  int64_t number;    ///< Extra number, -1 = none
+  uint64_t start;    ///< Start in ns
+  uint64_t duration; ///< Length in ns
+};
+
+/**
+ * Write one event as a complete ("X") event; times are in microseconds.
+ */
+void writeEvent(std::ostream &out, const EventCopy &event, int thread) {
+  char times[64];
+  std::snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f",
+                event.start / 1000.0, event.duration / 1000.0);
+  out << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+      << thread << ',' << times;
+  if (event.number >= 0) {
+    out << ",\"args\":{\"n\":" << event.number << '}';
+  }
+  out << '}';
+}
+
+} // namespace
+
+uint64_t Trace::now() {
+  std::chrono::steady_clock::time_point start = epoch();
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count());
+}
+
+Trace::Ring &Trace::localRing() {
+  thread_local ThreadHandle handle;
+  return *handle.ring;
+}
+
+/**
+ * The rings are read while their threads may still be writing. So each
+ * ring's events are copied first, and afterwards the head is read again:
+ * any event the thread may have overwritten in the meantime is dropped
+ * instead of being written half old, half new.
+ */
+std::size_t Trace::writeJson(std::ostream &out) {
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  std::size_t written = 0;
+
+  Registry &shared = registry();
+  std::lock_guard<std::mutex> guard(shared.lock);
+  std::vector<EventCopy> copy(RING_SIZE);
+  for (std::size_t ringIdx = 0; ringIdx < shared.rings.size(); ringIdx++) {
+    const Ring &ring = *shared.rings[ringIdx];
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    uint64_t first = (head > uint64_t(RING_SIZE)) ? head - RING_SIZE : 0;
+    for (uint64_t eventIdx = first; eventIdx < head; eventIdx++) {
+      int slot = int(eventIdx & (RING_SIZE - 1));
+      const Event &event = ring.events[slot];
+      copy[slot].name = event.name.load(std::memory_order_relaxed);
+      copy[slot].number = event.number.load(std::memory_order_relaxed);
+      copy[slot].start = event.start.load(std::memory_order_relaxed);
+      copy[slot].duration = event.duration.load(std::memory_order_relaxed);
+    }
+
+    // The thread may be writing event 'headAfter' right now, which uses the
+    // slot of event 'headAfter - RING_SIZE'. If we read a field of a newer
+    // event than that, the fence makes sure we see its head as well.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t headAfter = ring.head.load(std::memory_order_relaxed);
+    if (headAfter + 1 > first + RING_SIZE) {
+      first = headAfter + 1 - RING_SIZE;
+    }
+    for (uint64_t eventIdx = first; eventIdx < head; eventIdx++) {
+      out << (written == 0 ? "\n" : ",\n");
+      writeEvent(out, copy[eventIdx & (RING_SIZE - 1)], ring.thread);
+      written++;
+    }
+  }
+  out << "\n]}\n";
+  return written;
+}
+
+/**
+ * Rings of threads that have ended are dropped; the others start over.
+ */
+void Trace::clear() {
+  Registry &shared = registry();
+  std::lock_guard<std::mutex> guard(shared.lock);
+  std::size_t kept = 0;
+  for (std::size_t ringIdx = 0; ringIdx < shared.rings.size(); ringIdx++) {
+    if (!shared.finished[ringIdx]) {
+      shared.rings[ringIdx]->head.store(0, std::memory_order_relaxed);
+      shared.rings[kept].swap(shared.rings[ringIdx]);
+      shared.finished[kept] = false;
+      kept++;
+    }
+  }
+  shared.rings.resize(kept);
+  shared.finished.resize(kept);
+}
@@ -0,0 +1,154 @@
+/**
+ * @file Trace.h
+ * @brief Timed spans that can be opened as a timeline in a trace viewer.
+ *
+ * Switched off unless the program is built with -DBATTLESHIP_TRACE.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief Scoped trace spans, kept in per-thread ring buffers.
+ *
+ * A Span notes the time when it is created and, when it goes out of scope,
+ * writes one event (name, start, duration, optional number) into the ring
+ * of the calling thread. Only that thread writes its ring, so there is no
+ * lock: the event is written and then the ring's head is moved with a
+ * release store. When a ring is full, the oldest events are overwritten, so
+ * memory stays fixed no matter how long the program runs.
+ *
+ * writeJson() may run while other threads are still tracing. The event
+ * fields are relaxed atomics and the ring works like a seqlock: the reader
+ * copies the fields, then checks the head again and drops any event the
+ * thread may have overwritten in the meantime.
+ *
+ * writeJson() writes every ring as Chrome trace-event JSON ("X" events with
+ * one tid per thread). Open the file in chrome://tracing or Perfetto to see
+ * the spans of every thread on a timeline.
+ *
+ * Without BATTLESHIP_TRACE, ENABLED is false and Span is an empty class, so
+ * the spans vanish from the code. writeJson() then writes an empty trace.
+ */
+namespace Trace {
+
+#ifdef BATTLESHIP_TRACE
+constexpr bool ENABLED = true; ///< Built with tracing
+#else
+constexpr bool ENABLED = false; ///< Built without tracing
+#endif
+
+constexpr int RING_SIZE = 1 << 14; ///< Events kept per thread (a power of 2)
+
+/**
+ * @brief One finished span. The fields are atomic (always used relaxed),
+ * so writeJson() can read them while the owning thread writes.
+ */
+struct Event {
+  std::atomic<const char *> name;  ///< What was timed (a string literal)
+  std::atomic<int64_t> number;     ///< Extra number shown, -1 = none
+  std::atomic<uint64_t> start;     ///< Start in ns since the trace clock
+  std::atomic<uint64_t> duration;  ///< Length in ns
+};
+
+/**
+ * @brief One thread's events.
+ */
+struct Ring {
+  Event events[RING_SIZE];    ///< Written round and round
+  std::atomic<uint64_t> head; ///< Events written so far (ever)
+  int thread;                 ///< Thread number shown as "tid"
+};
+
+/**
+ * @brief Nanoseconds since the trace clock started.
+ */
+uint64_t now();
+
+/**
+ * @brief The calling thread's ring (registered on first use).
+ */
+Ring &localRing();
+
+/**
+ * @brief Append an event to the calling thread's ring.
+ */
+inline void addEvent(const char *name, int64_t number, uint64_t start,
+                     uint64_t duration) {
+#ifdef BATTLESHIP_TRACE
+  Ring &ring = localRing();
+  uint64_t head = ring.head.load(std::memory_order_relaxed);
+  // A reader that sees any of the new fields also sees the head that was
+  // stored before them (pairs with the acquire fence in writeJson())
+  std::atomic_thread_fence(std::memory_order_release);
+  Event &event = ring.events[head & (RING_SIZE - 1)];
+  event.name.store(name, std::memory_order_relaxed);
+  event.number.store(number, std::memory_order_relaxed);
+  event.start.store(start, std::memory_order_relaxed);
+  event.duration.store(duration, std::memory_order_relaxed);
+  ring.head.store(head + 1, std::memory_order_release);
+#else
+  (void)name;
+  (void)number;
+  (void)start;
+  (void)duration;
+#endif
+}
+
+/**
+ * @class Span
+ * @brief Times its own lifetime as one trace event.
+ */
+class Span {
+#ifdef BATTLESHIP_TRACE
+private:
+  const char *name; ///< What is being timed
+  int64_t number;   ///< Extra number, -1 = none
+  uint64_t start;   ///< When the span began
+
+public:
+  /**
+   * @brief Start the span.
+   * @param name A string literal (only the pointer is kept).
+   * @param number Shown as "n" in the viewer, e.g. the turn (-1 = none).
+   */
+  explicit Span(const char *name, int64_t number = -1) {
+    this->name = name;
+    this->number = number;
+    this->start = now();
+  }
+
+  /**
+   * @brief End the span and write it to the ring.
+   */
+  ~Span() { addEvent(name, number, start, now() - start); }
+#else
+public:
+  /**
+   * @brief Does nothing without tracing.
+   */
+  explicit Span(const char *, int64_t = -1) {}
+#endif
+
+  Span(const Span &) = delete;
+  Span &operator=(const Span &) = delete;
+};
+
+/**
+ * @brief Write every thread's events as Chrome trace-event JSON.
+ * @return Number of events written.
+ */
+std::size_t writeJson(std::ostream &out);
+
+/**
+ * @brief Forget all events (only exact while no thread is tracing).
+ */
+void clear();
+
+} // namespace Trace
+
+#endif /* TRACE_H_ */
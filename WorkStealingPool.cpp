@@ -0,0 +1,122 @@
+/**
+ * @file WorkStealingPool.cpp
+ * @brief Implementation of the WorkStealingPool class.
+ */
+
+#include "WorkStealingPool.h"
+
+WorkStealingPool::WorkStealingPool(int threadCount) {
+  this->current = 0;
+  this->batch = 0;
+  this->busyWorkers = 0;
+  this->stopping = false;
+
+  if (threadCount < 1) {
+    threadCount = 1;
+  }
+  for (int worker = 0; worker < threadCount; worker++) {
+    queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+  }
+  for (int worker = 0; worker < threadCount; worker++) {
+    threads.push_back(std::thread(&WorkStealingPool::workerLoop, this, worker));
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> guard(stateLock);
+    stopping = true;
+  }
+  wakeUp.notify_all();
+  for (std::size_t worker = 0; worker < threads.size(); worker++) {
+    threads[worker].join();
+  }
+}
+
+int WorkStealingPool::getThreadCount() const { return threads.size(); }
+
+/**
+ * Deals the task numbers out to the queues, wakes the workers up and waits
+ * until the last one has run out of work.
+ */
+void WorkStealingPool::run(int taskCount, const Task &task) {
+  int threadCount = threads.size();
+  for (int taskIdx = 0; taskIdx < taskCount; taskIdx++) {
+    WorkerQueue &queue = *queues[taskIdx % threadCount];
+    std::lock_guard<std::mutex> guard(queue.lock);
+    queue.tasks.push_back(taskIdx);
+  }
+
+  std::unique_lock<std::mutex> guard(stateLock);
+  current = &task;
+  busyWorkers = threadCount;
+  batch++;
+  wakeUp.notify_all();
+
+  while (busyWorkers > 0) {
+    batchDone.wait(guard);
+  }
+  current = 0;
+}
+
+/**
+ * Own queue first (newest task, which is still warm in the cache), then the
+ * oldest task of any other worker.
+ */
+bool WorkStealingPool::nextTask(int worker, int &task) {
+  {
+    WorkerQueue &own = *queues[worker];
+    std::lock_guard<std::mutex> guard(own.lock);
+    if (!own.tasks.empty()) {
+      task = own.tasks.back();
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+
+  int threadCount = queues.size();
+  for (int offset = 1; offset < threadCount; offset++) {
+    WorkerQueue &victim = *queues[(worker + offset) % threadCount];
+    std::lock_guard<std::mutex> guard(victim.lock);
+    if (!victim.tasks.empty()) {
+      task = victim.tasks.front();
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Sleeps until a new batch arrives, works until there is nothing left to
+ * take, reports back, and goes to sleep again.
+ */
+void WorkStealingPool::workerLoop(int worker) {
+  unsigned long seenBatch = 0;
+
+  while (true) {
+    const Task *work;
+    {
+      std::unique_lock<std::mutex> guard(stateLock);
+      while (!stopping && batch == seenBatch) {
+        wakeUp.wait(guard);
+      }
+      if (stopping) {
+        return;
+      }
+      seenBatch = batch;
+      work = current;
+    }
+
+    int task;
+    while (nextTask(worker, task)) {
+      (*work)(task, worker);
+    }
+
+    std::lock_guard<std::mutex> guard(stateLock);
+    busyWorkers--;
+    if (busyWorkers == 0) {
+      batchDone.notify_one();
+    }
+  }
+}
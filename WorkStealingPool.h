@@ -0,0 +1,98 @@
+/**
+ * @file WorkStealingPool.h
+ * @brief Header for the WorkStealingPool class.
+ *
+ * A small set of worker threads that share out numbered tasks.
+ */
+
+#ifndef WORKSTEALINGPOOL_H_
+#define WORKSTEALINGPOOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class WorkStealingPool
+ * @brief Runs tasks 0..count-1 on a fixed number of threads.
+ *
+ * Every worker has its own queue. The tasks are dealt out round-robin; a
+ * worker takes work from the back of its own queue, and once that is empty
+ * it steals from the front of the other workers' queues. So a worker that
+ * got quick tasks helps out the ones that got slow tasks.
+ *
+ * The threads are started once and wait between calls to run().
+ */
+class WorkStealingPool {
+public:
+  /**
+   * @brief The work to do: called once per task with the task number and
+   * the number of the worker (0..threads-1) running it.
+   */
+  typedef std::function<void(int task, int worker)> Task;
+
+private:
+  /**
+   * @brief One worker's queue of task numbers.
+   */
+  struct WorkerQueue {
+    std::mutex lock;       ///< Guards 'tasks'
+    std::deque<int> tasks; ///< Task numbers waiting to be run
+  };
+
+  std::vector<std::thread> threads; ///< The workers
+  std::vector<std::unique_ptr<WorkerQueue>> queues; ///< One per worker
+
+  std::mutex stateLock;              ///< Guards everything below
+  std::condition_variable wakeUp;    ///< Workers wait here for a new batch
+  std::condition_variable batchDone; ///< run() waits here for the workers
+  const Task *current;  ///< Work of the running batch (0 if none)
+  unsigned long batch;  ///< Number of the latest batch
+  int busyWorkers;      ///< Workers still working on the batch
+  bool stopping;        ///< True once the pool is being destroyed
+
+  /**
+   * @brief Main loop of one worker thread.
+   */
+  void workerLoop(int worker);
+
+  /**
+   * @brief Take the next task for 'worker', stealing if needed.
+   * @return False if every queue is empty.
+   */
+  bool nextTask(int worker, int &task);
+
+public:
+  /**
+   * @brief Start the worker threads.
+   * @param threadCount Number of workers (at least 1).
+   */
+  WorkStealingPool(int threadCount);
+
+  /**
+   * @brief Stop and join the worker threads.
+   */
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  /**
+   * @brief Number of worker threads.
+   */
+  int getThreadCount() const;
+
+  /**
+   * @brief Run tasks 0..taskCount-1 and wait until all of them are done.
+   *
+   * Tasks may run in any order and on any worker, so they must not depend
+   * on each other.
+   */
+  void run(int taskCount, const Task &task);
+};
+
+#endif /* WORKSTEALINGPOOL_H_ */
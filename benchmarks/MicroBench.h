@@ -0,0 +1,148 @@
+/**
+ * @file MicroBench.h
+ * @brief A tiny timing harness for the benchmark programs.
+ *
+ * No libraries needed: it runs a piece of code a few times to warm up, then
+ * times a number of runs and reports the median and 99th percentile in
+ * nanoseconds per operation, as a table, JSON or CSV.
+ */
+
+#ifndef MICROBENCH_H_
+#define MICROBENCH_H_
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Stop the compiler from optimizing a value (and the work that
+ * produced it) away.
+ */
+template <typename T> inline void doNotOptimize(const T &value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ * @brief Timing summary for one benchmark.
+ */
+struct BenchResult {
+  std::string name; ///< What was measured
+  long opsPerRun;   ///< Operations done by one run
+  int runs;         ///< Timed runs
+  double medianNs;  ///< Median time per operation
+  double p99Ns;     ///< 99th percentile time per operation
+  double minNs;     ///< Fastest run, per operation
+  double meanNs;    ///< Average over all runs, per operation
+};
+
+/**
+ * @class MicroBench
+ * @brief Collects BenchResults, one per call to run().
+ */
+class MicroBench {
+private:
+  int warmupRuns; ///< Untimed runs before measuring
+  int timedRuns;  ///< Timed runs per benchmark
+  std::vector<BenchResult> results; ///< Everything measured so far
+
+public:
+  MicroBench(int warmupRuns, int timedRuns)
+      : warmupRuns(warmupRuns), timedRuns(timedRuns < 1 ? 1 : timedRuns) {}
+
+  /**
+   * @brief Measure 'body', which does 'opsPerRun' operations per call.
+   */
+  template <typename Body>
+  const BenchResult &run(const std::string &name, long opsPerRun, Body body) {
+    for (int runIdx = 0; runIdx < warmupRuns; runIdx++) {
+      body();
+    }
+
+    std::vector<double> perOp(timedRuns);
+    for (int runIdx = 0; runIdx < timedRuns; runIdx++) {
+      std::chrono::steady_clock::time_point start =
+          std::chrono::steady_clock::now();
+      body();
+      std::chrono::duration<double, std::nano> elapsed =
+          std::chrono::steady_clock::now() - start;
+      perOp[runIdx] = elapsed.count() / opsPerRun;
+    }
+
+    std::sort(perOp.begin(), perOp.end());
+    double total = 0;
+    for (int runIdx = 0; runIdx < timedRuns; runIdx++) {
+      total += perOp[runIdx];
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.opsPerRun = opsPerRun;
+    result.runs = timedRuns;
+    result.medianNs = perOp[timedRuns / 2];
+    result.p99Ns = perOp[std::min(timedRuns - 1, (timedRuns * 99) / 100)];
+    result.minNs = perOp[0];
+    result.meanNs = total / timedRuns;
+    results.push_back(result);
+    return results.back();
+  }
+
+  const std::vector<BenchResult> &getResults() const { return results; }
+
+  /**
+   * @brief A table for people to read.
+   */
+  void writeTable(std::ostream &out) const {
+    std::ios::fmtflags oldFlags = out.flags();
+    std::streamsize oldPrecision = out.precision();
+
+    out << std::left << std::setw(32) << "benchmark" << std::right
+        << std::setw(14) << "median ns/op" << std::setw(12) << "p99 ns/op"
+        << std::endl;
+    out << std::fixed << std::setprecision(2);
+    for (std::size_t idx = 0; idx < results.size(); idx++) {
+      out << std::left << std::setw(32) << results[idx].name << std::right
+          << std::setw(14) << results[idx].medianNs << std::setw(12)
+          << results[idx].p99Ns << std::endl;
+    }
+
+    out.flags(oldFlags);
+    out.precision(oldPrecision);
+  }
+
+  /**
+   * @brief One JSON object with a "benchmarks" array.
+   */
+  void writeJson(std::ostream &out) const {
+    out << "{\"benchmarks\": [";
+    for (std::size_t idx = 0; idx < results.size(); idx++) {
+      const BenchResult &result = results[idx];
+      out << (idx == 0 ? "\n" : ",\n") << "  {\"name\": \"" << result.name
+          << "\", \"ops_per_run\": " << result.opsPerRun
+          << ", \"runs\": " << result.runs
+          << ", \"median_ns\": " << result.medianNs
+          << ", \"p99_ns\": " << result.p99Ns
+          << ", \"min_ns\": " << result.minNs
+          << ", \"mean_ns\": " << result.meanNs << "}";
+    }
+    out << "\n]}" << std::endl;
+  }
+
+  /**
+   * @brief CSV with a header line.
+   */
+  void writeCsv(std::ostream &out) const {
+    out << "name,ops_per_run,runs,median_ns,p99_ns,min_ns,mean_ns"
+        << std::endl;
+    for (std::size_t idx = 0; idx < results.size(); idx++) {
+      const BenchResult &result = results[idx];
+      out << result.name << "," << result.opsPerRun << "," << result.runs
+          << "," << result.medianNs << "," << result.p99Ns << ","
+          << result.minNs << "," << result.meanNs << std::endl;
+    }
+  }
+};
+
+#endif /* MICROBENCH_H_ */
@@ -0,0 +1,160 @@
+/**
+ * @file batchbench.cpp
+ * @brief Compares one shot per board on many Boards with a BoardBatch.
+ *
+ * Every board gets its own random fleet and its own random shot order, and
+ * a "game" is 100 rounds of one shot per board (own grid and tracker). Each
+ * run starts from a fresh copy of the boards; the copy alone is timed too,
+ * so it can be taken off. The batch plays every game twice: once with Shots
+ * and once with the shots packed into square indices up front.
+ *
+ * Build from the project folder:
+ *   g++ -std=c++17 -O2 -I. benchmarks/batchbench.cpp BoardBatch.cpp \
+ *       CompactBoard.cpp Board.cpp FleetGenerator.cpp OwnGrid.cpp \
+ *       NodePool.cpp OpponentGrid.cpp Ship.cpp Shot.cpp GridPosition.cpp \
+ *       -o batchbench
+ *
+ * Usage: batchbench [boards] [runs]
+ */
+
+#include "BoardBatch.h"
+#include "FleetGenerator.h"
+#include "MicroBench.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+  int boards = (argc > 1) ? atoi(argv[1]) : 4096;
+  int runs = (argc > 2) ? atoi(argv[2]) : 15;
+  if (boards < 1) {
+    boards = 1;
+  }
+  const int ROUNDS = 100;
+
+  // Fleets, and shots[round * boards + board]
+  FleetGenerator generator(1);
+  mt19937_64 random(2);
+  vector<Board> pristine;
+  vector<Shot> shots;
+  vector<vector<GridPosition>> orders(boards);
+  for (int boardIdx = 0; boardIdx < boards; boardIdx++) {
+    pristine.push_back(Board(10, 10));
+    generator.fill(pristine.back().getOwnGrid());
+    for (int idx = 0; idx < 100; idx++) {
+      orders[boardIdx].push_back(GridPosition::fromIndex(idx, 10));
+    }
+    shuffle(orders[boardIdx].begin(), orders[boardIdx].end(), random);
+  }
+  for (int roundIdx = 0; roundIdx < ROUNDS; roundIdx++) {
+    for (int boardIdx = 0; boardIdx < boards; boardIdx++) {
+      shots.push_back(Shot(orders[boardIdx][roundIdx]));
+    }
+  }
+
+  BoardBatch pristineBatch(boards, 10, 10);
+  for (int boardIdx = 0; boardIdx < boards; boardIdx++) {
+    pristineBatch.load(boardIdx, pristine[boardIdx]);
+  }
+  vector<uint16_t> cells;
+  for (size_t shotIdx = 0; shotIdx < shots.size(); shotIdx++) {
+    cells.push_back(pristineBatch.toCell(shots[shotIdx].getTargetPosition()));
+  }
+
+  MicroBench bench(2, runs);
+  long shotCount = long(boards) * ROUNDS;
+
+  // run() hands back a reference into the result list, so the medians are
+  // copied out right away
+  double boardsCopy = bench.run("boards_copy", shotCount, [&pristine]() {
+                             vector<Board> copy = pristine;
+                             doNotOptimize(copy);
+                           }).medianNs;
+
+  double boardsGame =
+      bench.run("boards_game", shotCount, [&pristine, &shots, boards]() {
+             vector<Board> copy = pristine;
+             for (int roundIdx = 0; roundIdx < ROUNDS; roundIdx++) {
+               for (int boardIdx = 0; boardIdx < boards; boardIdx++) {
+                 const Shot &shot =
+                     shots[std::size_t(roundIdx) * boards + boardIdx];
+                 Shot::Impact impact =
+                     copy[boardIdx].getOwnGrid().takeBlow(shot);
+                 copy[boardIdx].getOpponentGrid().shotResult(shot, impact);
+               }
+             }
+             doNotOptimize(copy);
+           }).medianNs -
+      boardsCopy;
+
+  double batchCopy = bench.run("batch_copy", shotCount, [&pristineBatch]() {
+                            BoardBatch copy = pristineBatch;
+                            doNotOptimize(copy);
+                          }).medianNs;
+
+  BoardBatch::Kernel kernels[3] = {BoardBatch::SCALAR, BoardBatch::SSE2,
+                                   BoardBatch::AVX2};
+  vector<Shot::Impact> impacts(boards);
+  vector<string> speedups;
+  for (int kernelIdx = 0; kernelIdx < 3; kernelIdx++) {
+    BoardBatch::Kernel kernel = kernels[kernelIdx];
+    if (!BoardBatch::isSupported(kernel)) {
+      continue;
+    }
+    string name = string("batch_game_") + BoardBatch::kernelName(kernel);
+    double batchGame =
+        bench.run(name, shotCount,
+                  [&pristineBatch, &shots, &impacts, boards, kernel]() {
+                    BoardBatch copy = pristineBatch;
+                    copy.setKernel(kernel);
+                    for (int roundIdx = 0; roundIdx < ROUNDS; roundIdx++) {
+                      Span<const Shot> round(
+                          &shots[std::size_t(roundIdx) * boards], boards);
+                      copy.takeBlows(round, impacts);
+                      copy.shotResults(round, impacts);
+                    }
+                    doNotOptimize(copy);
+                  })
+            .medianNs -
+        batchCopy;
+
+    string packedName =
+        string("batch_packed_") + BoardBatch::kernelName(kernel);
+    double packedGame =
+        bench.run(packedName, shotCount,
+                  [&pristineBatch, &cells, &impacts, boards, kernel]() {
+                    BoardBatch copy = pristineBatch;
+                    copy.setKernel(kernel);
+                    for (int roundIdx = 0; roundIdx < ROUNDS; roundIdx++) {
+                      Span<const uint16_t> round(
+                          &cells[std::size_t(roundIdx) * boards], boards);
+                      copy.takeBlows(round, impacts);
+                      copy.shotResults(round, impacts);
+                    }
+                    doNotOptimize(copy);
+                  })
+            .medianNs -
+        batchCopy;
+
+    ostringstream line;
+    line << fixed << setprecision(1) << "  " << BoardBatch::kernelName(kernel)
+         << ": " << boardsGame << " ns -> " << batchGame << " ns per shot, "
+         << boardsGame / batchGame << "x (packed: " << packedGame << " ns, "
+         << boardsGame / packedGame << "x)";
+    speedups.push_back(line.str());
+  }
+
+  cout << boards << " boards x " << ROUNDS
+       << " rounds, time per shot (own grid + tracker)" << endl;
+  bench.writeTable(cout);
+  cout << "Speedup over the Board loop (copies taken off):" << endl;
+  for (size_t idx = 0; idx < speedups.size(); idx++) {
+    cout << speedups[idx] << endl;
+  }
+  return 0;
+}
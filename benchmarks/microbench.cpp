@@ -0,0 +1,306 @@
+/**
+ * @file microbench.cpp
+ * @brief Microbenchmarks for the core grid operations.
+ *
+ * Build from the project folder:
+ *   g++ -std=c++17 -O2 -I. benchmarks/microbench.cpp ConsoleView.cpp \
+ *       CompactBoard.cpp LargePosition.cpp LargeShip.cpp LargeOwnGrid.cpp \
+ *       Board.cpp FleetGenerator.cpp OwnGrid.cpp NodePool.cpp \
+ *       OpponentGrid.cpp Ship.cpp Shot.cpp GridPosition.cpp -o microbench
+ *
+ * Usage: microbench [--runs N] [--warmup N] [--json FILE] [--csv FILE]
+ *
+ * A table always goes to the console; --json / --csv also write the
+ * results to a file, so runs before and after a change can be compared.
+ */
+
+#include "Board.h"
+#include "CompactBoard.h"
+#include "ConsoleView.h"
+#include "FleetGenerator.h"
+#include "LargeOwnGrid.h"
+#include "MicroBench.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+
+using namespace std;
+
+/**
+ * @brief A stream buffer that throws everything away.
+ */
+class NullBuffer : public streambuf {
+protected:
+  int overflow(int character) override { return character; }
+  streamsize xsputn(const char *, streamsize count) override { return count; }
+};
+
+/**
+ * @brief Every square of a 10x10 board, in a scrambled but fixed order.
+ */
+vector<GridPosition> firingOrder(uint64_t seed) {
+  vector<GridPosition> order;
+  for (int cellIdx = 0; cellIdx < 100; cellIdx++) {
+    order.push_back(GridPosition::fromIndex(cellIdx, 10));
+  }
+  mt19937_64 random(seed);
+  shuffle(order.begin(), order.end(), random);
+  return order;
+}
+
+int main(int argc, char *argv[]) {
+  int runs = 200;
+  int warmup = 20;
+  const char *jsonFile = 0;
+  const char *csvFile = 0;
+  for (int argIdx = 1; argIdx + 1 < argc; argIdx += 2) {
+    if (strcmp(argv[argIdx], "--runs") == 0) {
+      runs = atoi(argv[argIdx + 1]);
+    } else if (strcmp(argv[argIdx], "--warmup") == 0) {
+      warmup = atoi(argv[argIdx + 1]);
+    } else if (strcmp(argv[argIdx], "--json") == 0) {
+      jsonFile = argv[argIdx + 1];
+    } else if (strcmp(argv[argIdx], "--csv") == 0) {
+      csvFile = argv[argIdx + 1];
+    }
+  }
+
+  MicroBench bench(warmup, runs);
+
+  // --- Test data, prepared before any timing ---
+  const int FLEETS = 100;
+  FleetGenerator generator(12345);
+  vector<vector<Ship>> fleets;
+  for (int fleetIdx = 0; fleetIdx < FLEETS; fleetIdx++) {
+    OwnGrid grid(10, 10);
+    generator.fill(grid);
+    Span<const Ship> ships = grid.getShipView();
+    fleets.push_back(vector<Ship>(ships.begin(), ships.end()));
+  }
+
+  vector<string> labels;
+  for (int cellIdx = 0; cellIdx < 100; cellIdx++) {
+    labels.push_back(GridPosition::fromIndex(cellIdx, 10));
+  }
+
+  vector<GridPosition> order = firingOrder(7);
+
+  // What a full game of shots at fleet 0 answers, for the tracker benchmark
+  vector<Shot::Impact> answers;
+  {
+    OwnGrid target(10, 10);
+    for (size_t shipIdx = 0; shipIdx < fleets[0].size(); shipIdx++) {
+      target.placeShip(fleets[0][shipIdx]);
+    }
+    for (size_t shotIdx = 0; shotIdx < order.size(); shotIdx++) {
+      answers.push_back(target.takeBlow(Shot(order[shotIdx])));
+    }
+  }
+
+  // --- GridPosition ---
+  bench.run("gridposition_parse_string", labels.size(), [&labels]() {
+    for (size_t labelIdx = 0; labelIdx < labels.size(); labelIdx++) {
+      GridPosition position(labels[labelIdx]);
+      doNotOptimize(position);
+    }
+  });
+
+  bench.run("gridposition_parse_cstring", labels.size(), [&labels]() {
+    for (size_t labelIdx = 0; labelIdx < labels.size(); labelIdx++) {
+      GridPosition position(labels[labelIdx].c_str());
+      doNotOptimize(position);
+    }
+  });
+
+  // --- Ship areas ---
+  bench.run("ship_occupied_area", 10 * FLEETS, [&fleets]() {
+    for (size_t fleetIdx = 0; fleetIdx < fleets.size(); fleetIdx++) {
+      for (size_t shipIdx = 0; shipIdx < fleets[fleetIdx].size(); shipIdx++) {
+        set<GridPosition> area = fleets[fleetIdx][shipIdx].occupiedArea();
+        doNotOptimize(area);
+      }
+    }
+  });
+
+  bench.run("ship_blocked_area", 10 * FLEETS, [&fleets]() {
+    for (size_t fleetIdx = 0; fleetIdx < fleets.size(); fleetIdx++) {
+      for (size_t shipIdx = 0; shipIdx < fleets[fleetIdx].size(); shipIdx++) {
+        set<GridPosition> area = fleets[fleetIdx][shipIdx].blockedArea();
+        doNotOptimize(area);
+      }
+    }
+  });
+
+  // --- OwnGrid ---
+  bench.run("owngrid_place_full_fleet", FLEETS, [&fleets]() {
+    for (size_t fleetIdx = 0; fleetIdx < fleets.size(); fleetIdx++) {
+      OwnGrid grid(10, 10);
+      for (size_t shipIdx = 0; shipIdx < fleets[fleetIdx].size(); shipIdx++) {
+        grid.placeShip(fleets[fleetIdx][shipIdx]);
+      }
+      doNotOptimize(grid);
+    }
+  });
+
+  vector<OwnGrid> readyGrids;
+  for (int fleetIdx = 0; fleetIdx < 10; fleetIdx++) {
+    readyGrids.push_back(OwnGrid(10, 10));
+    for (size_t shipIdx = 0; shipIdx < fleets[fleetIdx].size(); shipIdx++) {
+      readyGrids.back().placeShip(fleets[fleetIdx][shipIdx]);
+    }
+  }
+  bench.run("owngrid_take_blow_game", 10 * order.size(),
+            [&readyGrids, &order]() {
+              for (size_t gridIdx = 0; gridIdx < readyGrids.size(); gridIdx++) {
+                OwnGrid grid = readyGrids[gridIdx];
+                for (size_t shotIdx = 0; shotIdx < order.size(); shotIdx++) {
+                  Shot::Impact impact = grid.takeBlow(Shot(order[shotIdx]));
+                  doNotOptimize(impact);
+                }
+              }
+            });
+
+  vector<Shot> salvo;
+  for (size_t shotIdx = 0; shotIdx < order.size(); shotIdx++) {
+    salvo.push_back(Shot(order[shotIdx]));
+  }
+  vector<Shot::Impact> salvoImpacts(salvo.size());
+  bench.run("owngrid_take_blows_salvo", 10 * order.size(),
+            [&readyGrids, &salvo, &salvoImpacts]() {
+              for (size_t gridIdx = 0; gridIdx < readyGrids.size(); gridIdx++) {
+                OwnGrid grid = readyGrids[gridIdx];
+                grid.takeBlows(salvo, salvoImpacts);
+                doNotOptimize(salvoImpacts);
+              }
+            });
+
+  bench.run("owngrid_take_undo_blow", order.size(), [&readyGrids, &order]() {
+    OwnGrid &grid = readyGrids[0];
+    for (size_t shotIdx = 0; shotIdx < order.size(); shotIdx++) {
+      doNotOptimize(grid.takeBlow(Shot(order[shotIdx])));
+      grid.undoBlow();
+    }
+  });
+
+  // --- OpponentGrid ---
+  bench.run("opponentgrid_shot_result_game", 10 * order.size(),
+            [&order, &answers]() {
+              for (int gameIdx = 0; gameIdx < 10; gameIdx++) {
+                OpponentGrid tracker(10, 10);
+                for (size_t shotIdx = 0; shotIdx < order.size(); shotIdx++) {
+                  tracker.shotResult(Shot(order[shotIdx]), answers[shotIdx]);
+                }
+                doNotOptimize(tracker);
+              }
+            });
+
+  bench.run("opponentgrid_shot_results_salvo", 10 * order.size(),
+            [&salvo, &answers]() {
+              for (int gameIdx = 0; gameIdx < 10; gameIdx++) {
+                OpponentGrid tracker(10, 10);
+                tracker.shotResults(salvo, answers);
+                doNotOptimize(tracker);
+              }
+            });
+
+  OpponentGrid undoTracker(10, 10);
+  bench.run("opponentgrid_result_undo", order.size(),
+            [&undoTracker, &order, &answers]() {
+              for (size_t shotIdx = 0; shotIdx < order.size(); shotIdx++) {
+                undoTracker.shotResult(Shot(order[shotIdx]), answers[shotIdx]);
+                undoTracker.undoShotResult();
+              }
+              doNotOptimize(undoTracker);
+            });
+
+  // --- Large board (a million rows and columns) ---
+  bench.run("largegrid_place_fleet", 10, []() {
+    LargeOwnGrid grid(1000000, 1000000);
+    int lengths[10] = {5, 4, 4, 3, 3, 3, 2, 2, 2, 2};
+    for (int shipIdx = 0; shipIdx < 10; shipIdx++) {
+      int row = 1 + shipIdx * 99991;
+      int lastColumn = 500000 + lengths[shipIdx] - 1;
+      grid.placeShip(LargeShip(LargePosition(row, 500000),
+                               LargePosition(row, lastColumn)));
+    }
+    doNotOptimize(grid);
+  });
+
+  LargeOwnGrid largeGrid(1000000, 1000000);
+  largeGrid.placeShip(LargeShip(LargePosition(500000, 500000),
+                                LargePosition(500000, 500004)));
+  bench.run("largegrid_take_blow", 1000, [&largeGrid]() {
+    uint64_t random = 12345;
+    for (int shotIdx = 0; shotIdx < 1000; shotIdx++) {
+      random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+      int row = 1 + int((random >> 33) % 1000000);
+      int col = 1 + int((random >> 13) % 1000000);
+      doNotOptimize(largeGrid.takeBlow(LargePosition(row, col)));
+    }
+  });
+
+  // --- ConsoleView ---
+  Board board(10, 10);
+  for (size_t shipIdx = 0; shipIdx < fleets[0].size(); shipIdx++) {
+    board.getOwnGrid().placeShip(fleets[0][shipIdx]);
+  }
+  for (size_t shotIdx = 0; shotIdx < order.size() / 2; shotIdx++) {
+    board.getOwnGrid().takeBlow(Shot(order[shotIdx]));
+    board.getOpponentGrid().shotResult(Shot(order[shotIdx]),
+                                       answers[shotIdx]);
+  }
+  ConsoleView view(&board);
+  NullBuffer nullBuffer;
+  streambuf *console = cout.rdbuf(&nullBuffer);
+  bench.run("consoleview_print", 10, [&view]() {
+    for (int printIdx = 0; printIdx < 10; printIdx++) {
+      view.print();
+    }
+  });
+  cout.rdbuf(console);
+
+  bench.run("consoleview_live_update", order.size(),
+            [&order, &answers]() {
+              Board liveBoard(10, 10);
+              ConsoleView liveView(&liveBoard);
+              string codes;
+              liveView.renderLiveTo(codes);
+              for (size_t shotIdx = 0; shotIdx < order.size(); shotIdx++) {
+                liveBoard.getOpponentGrid().shotResult(Shot(order[shotIdx]),
+                                                       answers[shotIdx]);
+                liveView.renderLiveTo(codes);
+                doNotOptimize(codes);
+              }
+            });
+
+  // --- Cloning ---
+  bench.run("board_copy", 10, [&board]() {
+    for (int copyIdx = 0; copyIdx < 10; copyIdx++) {
+      Board copy = board;
+      doNotOptimize(copy);
+    }
+  });
+
+  CompactBoard compact;
+  compact.load(board);
+  bench.run("compactboard_copy", 10, [&compact]() {
+    for (int copyIdx = 0; copyIdx < 10; copyIdx++) {
+      CompactBoard copy = compact;
+      doNotOptimize(copy);
+    }
+  });
+
+  // --- Output ---
+  bench.writeTable(cout);
+  if (jsonFile != 0) {
+    ofstream json(jsonFile);
+    bench.writeJson(json);
+  }
+  if (csvFile != 0) {
+    ofstream csv(csvFile);
+    bench.writeCsv(csv);
+  }
+  return 0;
+}
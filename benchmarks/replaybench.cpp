@@ -0,0 +1,109 @@
+/**
+ * @file replaybench.cpp
+ * @brief Measures how fast games come back out of a binary game log.
+ *
+ * First records self-play games into a log file (unless told to use an
+ * existing one), then reads the whole log twice: once only decoding every
+ * shot, and once replaying every game on two Boards. Prints games, shots
+ * and megabytes per second for both.
+ *
+ * Build from the project folder:
+ *   g++ -std=c++17 -O2 -pthread -I. benchmarks/replaybench.cpp GameLog.cpp \
+ *       Simulator.cpp GameArena.cpp WorkStealingPool.cpp Board.cpp \
+ *       TargetingEngine.cpp FleetGenerator.cpp OwnGrid.cpp NodePool.cpp \
+ *       OpponentGrid.cpp Ship.cpp Shot.cpp GridPosition.cpp -o replaybench
+ *
+ * Usage: replaybench [games] [log file] [seed]
+ *   games = 0 replays the log file that is already there (e.g. a big
+ *   archive) without writing anything.
+ */
+
+#include "GameLog.h"
+#include "Simulator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+/**
+ * Prints one line of rates.
+ */
+void printRates(const char *name, long games, long shots, size_t bytes,
+                double seconds) {
+  cout << left << setw(8) << name << right << fixed << setprecision(0)
+       << setw(12) << games / seconds << " games/s" << setw(14)
+       << shots / seconds << " shots/s" << setprecision(1) << setw(10)
+       << bytes / seconds / 1e6 << " MB/s" << endl;
+}
+
+int main(int argc, char *argv[]) {
+  int games = (argc > 1) ? atoi(argv[1]) : 20000;
+  const char *path = (argc > 2) ? argv[2] : "replaybench.log";
+  uint64_t seed = (argc > 3) ? strtoull(argv[3], 0, 10) : 1;
+
+  if (games > 0) {
+    remove(path);
+    Simulator simulator(10, 10, seed);
+    GameLogWriter writer;
+    if (!writer.open(path)) {
+      cout << "Can't write " << path << endl;
+      return 1;
+    }
+    for (int game = 0; game < games; game++) {
+      simulator.playGame(simulator.gameSeed(game), &writer);
+    }
+    writer.close();
+  }
+
+  GameLogReader reader;
+  if (!reader.open(path)) {
+    cout << "Can't read " << path << endl;
+    return 1;
+  }
+  cout << path << ": " << reader.getFileSize() << " bytes" << endl;
+
+  // Pass 1: walk every record and decode every shot
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  GameRecord record;
+  long gameCount = 0;
+  long shotCount = 0;
+  long checksum = 0; // Keeps the compiler from skipping the decoding
+  while (reader.next(record)) {
+    uint32_t shots = record.getShotCount();
+    for (uint32_t shotIdx = 0; shotIdx < shots; shotIdx++) {
+      checksum += record.getShot(shotIdx).getTargetPosition().getPacked() +
+                  record.getImpact(shotIdx);
+    }
+    gameCount++;
+    shotCount += shots;
+  }
+  chrono::duration<double> decoded = chrono::steady_clock::now() - start;
+  if (reader.hasError()) {
+    cout << "The log is damaged after game " << gameCount << endl;
+  }
+
+  // Pass 2: play every game again on real boards
+  reader.rewind();
+  start = chrono::steady_clock::now();
+  long replayed = 0;
+  while (reader.next(record)) {
+    Board first(record.getRows(), record.getColumns());
+    Board second(record.getRows(), record.getColumns());
+    replayed += record.replay(first, second) ? 1 : 0;
+  }
+  chrono::duration<double> played = chrono::steady_clock::now() - start;
+
+  cout << gameCount << " games, " << shotCount << " shots (checksum "
+       << checksum << ")" << endl;
+  printRates("decode", gameCount, shotCount, reader.getFileSize(),
+             decoded.count());
+  printRates("replay", gameCount, shotCount, reader.getFileSize(),
+             played.count());
+  if (replayed != gameCount) {
+    cout << gameCount - replayed << " games did not replay cleanly" << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file simbench.cpp
+ * @brief Runs the self-play Simulator with more and more threads.
+ *
+ * Prints games per second and scaling efficiency for each thread count, and
+ * the shots-to-win distribution of the last run.
+ *
+ * Build from the project folder:
+ *   g++ -std=c++17 -O2 -pthread -I. benchmarks/simbench.cpp Simulator.cpp \
+ *       GameArena.cpp GameLog.cpp WorkStealingPool.cpp Board.cpp \
+ *       TargetingEngine.cpp FleetGenerator.cpp OwnGrid.cpp NodePool.cpp \
+ *       OpponentGrid.cpp Ship.cpp Shot.cpp GridPosition.cpp -o simbench
+ *
+ * Usage: simbench [games] [max threads] [seed]
+ */
+
+#include "Simulator.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+  int games = (argc > 1) ? atoi(argv[1]) : 20000;
+  int maxThreads = (argc > 2) ? atoi(argv[2])
+                              : int(thread::hardware_concurrency());
+  uint64_t seed = (argc > 3) ? strtoull(argv[3], 0, 10) : 1;
+  if (maxThreads < 1) {
+    maxThreads = 1;
+  }
+
+  Simulator simulator(10, 10, seed);
+  SimulationReport report;
+  double singleRate = 0;
+
+  cout << "threads  games/s  speedup  efficiency" << endl;
+  // 1, 2, 4, ... threads, and finally maxThreads itself
+  for (int threads = 1;; threads *= 2) {
+    if (threads > maxThreads) {
+      threads = maxThreads;
+    }
+    report = simulator.run(games, threads);
+    if (threads == 1) {
+      singleRate = report.gamesPerSecond();
+    }
+    double speedup = report.gamesPerSecond() / singleRate;
+    cout << setw(7) << threads << setw(9) << fixed << setprecision(0)
+         << report.gamesPerSecond() << setw(9) << setprecision(2) << speedup
+         << setw(11) << setprecision(0) << 100 * speedup / threads << "%"
+         << endl;
+    if (threads == maxThreads) {
+      break;
+    }
+  }
+
+  cout << endl
+       << "Wins: player 0 " << report.wins[0] << ", player 1 "
+       << report.wins[1] << endl;
+  cout << "Shots to win: mean " << setprecision(2) << report.meanShots()
+       << ", p50 " << report.shotsPercentile(0.5) << ", p90 "
+       << report.shotsPercentile(0.9) << ", p99 "
+       << report.shotsPercentile(0.99) << endl;
+  for (size_t shots = 0; shots < report.shotsToWin.size(); shots++) {
+    if (report.shotsToWin[shots] > 0) {
+      cout << setw(4) << shots << " " << setw(7) << report.shotsToWin[shots]
+           << " " << string(60 * report.shotsToWin[shots] / report.games, '#')
+           << endl;
+    }
+  }
+  return 0;
+}
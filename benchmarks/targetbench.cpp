@@ -0,0 +1,66 @@
+/**
+ * @file targetbench.cpp
+ * @brief Measures how long TargetingEngine takes to pick a shot.
+ *
+ * Plays whole games against random fleets and times every decision.
+ *
+ * Build from the project folder:
+ *   g++ -std=c++17 -O2 -I. benchmarks/targetbench.cpp TargetingEngine.cpp \
+ *       FleetGenerator.cpp OwnGrid.cpp NodePool.cpp OpponentGrid.cpp Ship.cpp \
+ *       Shot.cpp GridPosition.cpp -o targetbench
+ *
+ * Usage: targetbench [games] [rows] [columns] [seed]
+ */
+
+#include "FleetGenerator.h"
+#include "TargetingEngine.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+  int games = (argc > 1) ? atoi(argv[1]) : 10000;
+  int rows = (argc > 2) ? atoi(argv[2]) : 10;
+  int columns = (argc > 3) ? atoi(argv[3]) : 10;
+  uint64_t seed = (argc > 4) ? strtoull(argv[4], 0, 10) : 1;
+
+  FleetGenerator generator(seed);
+  TargetingEngine engine;
+  long decisions = 0;
+  long shotsTotal = 0;
+  int wins = 0;
+  chrono::duration<double> thinking(0);
+
+  for (int game = 0; game < games; game++) {
+    OwnGrid enemy(rows, columns);
+    if (!generator.fill(enemy)) {
+      cout << "No fleet fits on a " << rows << "x" << columns << " board"
+           << endl;
+      return 1;
+    }
+    OpponentGrid view(rows, columns);
+    int fleetSize = enemy.getShipCount();
+
+    int sunk = 0;
+    for (int shot = 0; shot < rows * columns && sunk < fleetSize; shot++) {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      GridPosition target = engine.chooseTarget(view);
+      thinking += chrono::steady_clock::now() - start;
+      decisions++;
+
+      Shot::Impact impact = enemy.takeBlow(Shot(target));
+      view.shotResult(Shot(target), impact);
+      shotsTotal++;
+      sunk += (impact == Shot::SUNKEN) ? 1 : 0;
+    }
+    wins += (sunk == fleetSize) ? 1 : 0;
+  }
+
+  cout << games << " games on " << rows << "x" << columns << ", " << wins
+       << " won, " << double(shotsTotal) / games << " shots per game" << endl;
+  cout << decisions << " decisions, "
+       << thinking.count() * 1e6 / decisions << " us per decision" << endl;
+  return 0;
+}
@@ -12,6 +12,7 @@
 void part1tests(); // Basic GridPosition and Ship tests
 void part2tests(); // Ship placement and arrangement rules
 void part3tests(); // Shot mechanics and sinking ships
+void part4tests(); // Fast engine: placement tables and friends
 
 void runDemo(); // A demo of the game with possible scenarios
 
@@ -34,6 +35,11 @@ int main() {
   std::cout << "Part 3 tests completed." << std::endl;
   std::cout << std::endl;
 
+  std::cout << "=== Running Part 4 Tests ===" << std::endl;
+  part4tests();
+  std::cout << "Part 4 tests completed." << std::endl;
+  std::cout << std::endl;
+
   std::cout << "=== Running Demo ===" << std::endl;
   runDemo();
 
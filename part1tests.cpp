@@ -5,6 +5,7 @@
  *      Author: mnl
  */
 
+#include <functional>
 #include <iostream>
 
 using namespace std;
@@ -54,6 +55,23 @@ void part1tests() {
   assertTrue(GridPosition{"C21"} == GridPosition{"C21"},
              "Equal positions not considered equal.");
 
+  // Test the packed representation
+  static_assert(sizeof(GridPosition) == 2, "GridPosition should be 2 bytes");
+  constexpr GridPosition literal{"B7"};
+  static_assert(literal.getRow() == 'B' && literal.getColumn() == 7,
+                "Literal not parsed at compile time");
+  static_assert(GridPosition{"J10"}.isValid() && !GridPosition{"A"}.isValid(),
+                "isValid not usable at compile time");
+  assertTrue(GridPosition{string("C 21")} == GridPosition{'C', 21},
+             "Parsing should skip whitespace like a stream does");
+  assertTrue(!GridPosition{"Ax"}.isValid(), "Ax considered valid");
+  assertTrue(GridPosition{"E4"}.toIndex(10) == 43 &&
+                 GridPosition::fromIndex(43, 10) == GridPosition{"E4"},
+             "Linear index conversion fails");
+  assertTrue(hash<GridPosition>()(GridPosition{"A1"}) !=
+                 hash<GridPosition>()(GridPosition{"A2"}),
+             "Different positions share a hash");
+
   // Test Ship Constructor
   assertTrue(!Ship{GridPosition{"B2"}, GridPosition{"C3"}}.isValid(),
              "Can create non-aligned ship.");
@@ -73,4 +91,25 @@ void part1tests() {
                  set<GridPosition>{GridPosition{"B2"}, GridPosition{"C2"},
                                    GridPosition{"D2"}, GridPosition{"E2"}},
              "Occupied area not correct");
+
+  // Allocation-free areas must cover exactly the same squares as the sets
+  Ship areaShip{GridPosition{"C4"}, GridPosition{"C2"}};
+  GridArea occupiedCells = areaShip.occupiedCells();
+  GridArea blockedCells = areaShip.blockedCells();
+  assertTrue(set<GridPosition>(occupiedCells.begin(), occupiedCells.end()) ==
+                 areaShip.occupiedArea(),
+             "occupiedCells() differs from occupiedArea()");
+  assertTrue(blockedCells.size() == 15 &&
+                 set<GridPosition>(blockedCells.begin(), blockedCells.end()) ==
+                     areaShip.blockedArea(),
+             "blockedCells() differs from blockedArea()");
+
+  // A diagonal ship is invalid, but its area is still the bow's column
+  Ship diagonalShip{GridPosition{"B2"}, GridPosition{"D4"}};
+  assertTrue(diagonalShip.occupiedArea() ==
+                 set<GridPosition>{GridPosition{"B2"}, GridPosition{"C2"},
+                                   GridPosition{"D2"}},
+             "Occupied area of a diagonal ship not correct");
+  assertTrue(diagonalShip.blockedArea().size() == 15,
+             "Blocked area of a diagonal ship not correct");
 }
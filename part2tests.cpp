@@ -76,4 +76,17 @@ void part2tests() {
               "Blocked area should include F8 (diagonal)");
   assertTrue2(blocked.count(GridPosition{"D5"}) > 0,
               "Blocked area should include D5 (adjacent)");
+
+  // 7. Buffer zones must not 'wrap around' from one row end to the next row
+  std::unique_ptr<Board> board4(new Board(10, 10));
+  OwnGrid &grid4 = board4->getOwnGrid();
+
+  assertTrue2(grid4.placeShip(Ship{GridPosition{"A8"}, GridPosition{"A10"}}),
+              "Should allow a ship ending on the right edge");
+  assertTrue2(grid4.placeShip(Ship{GridPosition{"B1"}, GridPosition{"B2"}}),
+              "Should allow a ship on the left edge of the next row");
+  assertTrue2(!grid4.placeShip(Ship{GridPosition{"B7"}, GridPosition{"E7"}}),
+              "Should block ships that touch only diagonally");
+  assertTrue2(grid4.placeShip(Ship{GridPosition{"J10"}, GridPosition{"G10"}}),
+              "Should allow a reversed ship in the bottom right corner");
 }
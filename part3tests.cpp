@@ -48,6 +48,22 @@ void part3tests() {
   assertTrue3(ownGrid.takeBlow(Shot{GridPosition{"B4"}}) == Shot::SUNKEN,
               "B4 should be SUNKEN");
 
+  // 4. Shooting the same square twice must not count as a second hit
+  Ship ship2(GridPosition{"E5"}, GridPosition{"G5"}); // Length 3, vertical
+  ownGrid.placeShip(ship2);
+  assertTrue3(ownGrid.takeBlow(Shot{GridPosition{"E5"}}) == Shot::HIT,
+              "E5 should be a HIT");
+  assertTrue3(ownGrid.takeBlow(Shot{GridPosition{"E5"}}) == Shot::HIT,
+              "Repeated shot at E5 should still be a HIT");
+  assertTrue3(ownGrid.takeBlow(Shot{GridPosition{"F5"}}) == Shot::HIT,
+              "F5 should be a HIT, not SUNKEN, after a repeated shot");
+  assertTrue3(ownGrid.takeBlow(Shot{GridPosition{"G5"}}) == Shot::SUNKEN,
+              "G5 should be SUNKEN");
+  assertTrue3(ownGrid.takeBlow(Shot{GridPosition{"G5"}}) == Shot::SUNKEN,
+              "Shooting a sunken ship again should still report SUNKEN");
+  assertTrue3(ownGrid.getShotAt().size() == 7,
+              "Repeated shots should be recorded only once");
+
   // --- OpponentGrid Tracker Tests ---
   std::unique_ptr<Board> board2(new Board(10, 10));
   OpponentGrid &opponentGrid = board2->getOpponentGrid();
@@ -66,4 +82,18 @@ void part3tests() {
   if (!sunken.empty()) {
     assertTrue3(sunken[0].length() == 3, "Deducted ship should have length 3");
   }
+
+  // The dense square states and the map view must agree
+  assertTrue3(opponentGrid.getCellState(GridPosition{"C2"}) ==
+                  OpponentGrid::MISS,
+              "C2 should be recorded as a MISS");
+  assertTrue3(opponentGrid.getCellState(GridPosition{"C5"}) ==
+                  OpponentGrid::SUNK,
+              "C5 should be recorded as SUNK");
+  assertTrue3(opponentGrid.getCellState(GridPosition{"D4"}) ==
+                  OpponentGrid::UNKNOWN,
+              "D4 should still be UNKNOWN");
+  assertTrue3(opponentGrid.getShotsAt().size() == 4 &&
+                  opponentGrid.getShotsAt().at(GridPosition{"C3"}) == Shot::HIT,
+              "Map view of the shots should match the recorded shots");
 }
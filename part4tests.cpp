@@ -0,0 +1,1411 @@
+/**
+ * @file part4tests.cpp
+ * @brief Tests for the fast game engine.
+ *
+ * Checks that every fast path (placement tables, bitboards, batches, undo,
+ * logs, statistics, memory arenas, ...) gives the same answers as the plain
+ * Ship, OwnGrid and OpponentGrid rules.
+ */
+
+#include "Board.h"
+#include "BoardBatch.h"
+#include "CompactBoard.h"
+#include "ConsoleView.h"
+#include "FleetGenerator.h"
+#include "GameArena.h"
+#include "GameAnalyzer.h"
+#include "GameLog.h"
+#include "LargeOpponentGrid.h"
+#include "LargeOwnGrid.h"
+#include "Metrics.h"
+#include "PlacementTable.h"
+#include "RuleSet.h"
+#include "Simulator.h"
+#include "TargetingEngine.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+/**
+ * Calls of the global operator new made by this thread, so a test can check
+ * that a piece of code doesn't touch the heap.
+ *
+ * Counting means replacing operator new for the whole program, so it is
+ * only built in with -DBATTLESHIP_COUNT_ALLOCATIONS. Without it the count
+ * stays 0 and the allocation checks are skipped.
+ */
+thread_local size_t heapAllocations = 0;
+
+#ifdef BATTLESHIP_COUNT_ALLOCATIONS
+const bool COUNTS_ALLOCATIONS = true; ///< Built with the counting operator new
+
+// Not inlined, so the compiler never sees a malloc() paired with a delete.
+// The aligned versions are needed too: std::pmr's default resource
+// allocates through them.
+__attribute__((noinline)) void *operator new(size_t size) {
+  heapAllocations++;
+  void *memory = malloc(size > 0 ? size : 1);
+  if (memory == 0) {
+    throw bad_alloc();
+  }
+  return memory;
+}
+
+__attribute__((noinline)) void *operator new(size_t size,
+                                             align_val_t alignment) {
+  heapAllocations++;
+  size_t align = size_t(alignment);
+  size_t rounded = (size > 0) ? (size + align - 1) / align * align : align;
+  void *memory = aligned_alloc(align, rounded);
+  if (memory == 0) {
+    throw bad_alloc();
+  }
+  return memory;
+}
+
+__attribute__((noinline)) void operator delete(void *memory) noexcept {
+  free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, size_t) noexcept {
+  free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory,
+                                               align_val_t) noexcept {
+  free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, size_t,
+                                               align_val_t) noexcept {
+  free(memory);
+}
+#else
+const bool COUNTS_ALLOCATIONS = false; ///< Built with the normal operator new
+#endif
+
+/**
+ * Assertion helper to keep the output clean.
+ */
+void assertTrue4(bool condition, string failedMessage) {
+  if (!condition) {
+    cout << "  [FAIL] " << failedMessage << endl;
+  }
+}
+
+/**
+ * Tests for the fast game engine, one "// --- ... Tests ---" section per
+ * feature: from the placement tables and the fleet generator to salvos,
+ * BoardBatch, game logs, metrics, tracing, the memory arenas and known
+ * water.
+ */
+void part4tests() {
+  // --- Placement Table Tests ---
+  static_assert(STANDARD_PLACEMENTS.SIZE == 600,
+                "A 10x10 board has 600 placements for lengths 2 to 5");
+  static_assert(STANDARD_PLACEMENTS.count(5) == 120,
+                "A 10x10 board has 120 placements for a carrier");
+
+  // Every table entry must match what Ship itself says about the placement
+  bool tableMatchesShip = true;
+  for (int idx = 0; idx < STANDARD_PLACEMENTS.SIZE; idx++) {
+    const PlacementTable<10, 10>::Placement &placement =
+        STANDARD_PLACEMENTS[idx];
+    Ship ship(placement.bow, placement.stern);
+
+    if (STANDARD_PLACEMENTS.indexOf(ship) != idx ||
+        STANDARD_PLACEMENTS.indexOf(Ship(placement.stern, placement.bow)) !=
+            idx ||
+        placement.occupied.count() != ship.length()) {
+      tableMatchesShip = false;
+    }
+
+    int haloOnBoard = 0;
+    set<GridPosition> blocked = ship.blockedArea();
+    for (set<GridPosition>::const_iterator posIt = blocked.begin();
+         posIt != blocked.end(); ++posIt) {
+      if (posIt->getRow() >= 'A' && posIt->getRow() <= 'J' &&
+          posIt->getColumn() >= 1 && posIt->getColumn() <= 10) {
+        haloOnBoard++;
+        if (!placement.halo.test(posIt->toIndex(10))) {
+          tableMatchesShip = false;
+        }
+      }
+    }
+    if (haloOnBoard != placement.halo.count()) {
+      tableMatchesShip = false;
+    }
+  }
+  assertTrue4(tableMatchesShip,
+              "Placement table should match Ship's occupied/blocked areas");
+
+  assertTrue4(STANDARD_PLACEMENTS.indexOf(
+                  Ship{GridPosition{"J9"}, GridPosition{"J12"}}) == -1,
+              "Off-grid ship should not be found in the table");
+  assertTrue4(STANDARD_PLACEMENTS.indexOf(
+                  Ship{GridPosition{"A1"}, GridPosition{"C3"}}) == -1,
+              "Diagonal ship should not be found in the table");
+
+  // A corner carrier touches 2 rows x 6 columns of the board
+  const PlacementTable<10, 10>::Placement &corner =
+      STANDARD_PLACEMENTS[STANDARD_PLACEMENTS.indexOf(
+          Ship{GridPosition{"A1"}, GridPosition{"A5"}})];
+  assertTrue4(corner.halo.count() == 12 && corner.halo.test(10 + 5) &&
+                  !corner.halo.test(6),
+              "Halo of a corner carrier is clipped to the board");
+
+  // --- Fleet Generator Tests ---
+  FleetGenerator generator(2024);
+  OwnGrid fastGrid(10, 10);
+  assertTrue4(generator.fill(fastGrid), "FAST mode should fill a 10x10 grid");
+  assertTrue4(fastGrid.getShipView().size() == 10,
+              "FAST mode should place the whole inventory");
+
+  // Re-checking the generated fleet ship by ship must give the same grid
+  Span<const Ship> fastShips = fastGrid.getShipView();
+  OwnGrid replayed(10, 10);
+  bool allLegal = true;
+  for (const Ship *shipIt = fastShips.begin(); shipIt != fastShips.end();
+       ++shipIt) {
+    allLegal = allLegal && replayed.placeShip(*shipIt);
+  }
+  assertTrue4(allLegal, "Generated fleet should follow the placement rules");
+
+  // The same seed gives the same fleet
+  FleetGenerator sameSeed(2024);
+  OwnGrid sameGrid(10, 10);
+  sameSeed.fill(sameGrid);
+  Span<const Ship> sameShips = sameGrid.getShipView();
+  bool sameLayout = sameShips.size() == fastShips.size();
+  for (size_t shipIdx = 0; sameLayout && shipIdx < sameShips.size();
+       shipIdx++) {
+    sameLayout = sameShips[shipIdx].getBow() == fastShips[shipIdx].getBow() &&
+                 sameShips[shipIdx].getStern() == fastShips[shipIdx].getStern();
+  }
+  assertTrue4(sameLayout, "Same seed should give the same fleet");
+
+  // Ships that are already placed stay, only the rest is filled in
+  OwnGrid partGrid(10, 10);
+  partGrid.placeShip(Ship(GridPosition("A1"), GridPosition("A5")));
+  assertTrue4(generator.fill(partGrid, FleetGenerator::UNIFORM) &&
+                  partGrid.getShipView().size() == 10 &&
+                  partGrid.getShipView()[0].getBow() == GridPosition("A1"),
+              "UNIFORM mode should complete a partly filled grid");
+
+  OwnGrid wideGrid(8, 14);
+  assertTrue4(generator.fill(wideGrid, FleetGenerator::UNIFORM) &&
+                  wideGrid.getShipView().size() == 10,
+              "UNIFORM mode should work on other board sizes");
+
+  OwnGrid tinyGrid(4, 4);
+  assertTrue4(!generator.fill(tinyGrid) && tinyGrid.getShipView().empty(),
+              "A fleet that can't fit should leave the grid unchanged");
+  OwnGrid crampedGrid(7, 7); // Every length fits, the whole fleet doesn't
+  assertTrue4(!generator.fill(crampedGrid, FleetGenerator::UNIFORM) &&
+                  crampedGrid.getShipView().empty(),
+              "UNIFORM mode should give up as soon as FAST finds no room");
+  map<int, int> bigFleet;
+  bigFleet[2] = 40; // Would fit on 20x20, but is more than fill() handles
+  OwnGrid bigGrid(20, 20, bigFleet);
+  assertTrue4(!generator.fill(bigGrid) && bigGrid.getShipView().empty(),
+              "A fleet of more than 32 ships should be refused, not cut");
+
+  // --- Targeting Engine Tests ---
+  TargetingEngine engine;
+  OpponentGrid tracker(10, 10);
+  assertTrue4(engine.chooseTarget(tracker) == GridPosition("E5"),
+              "On an empty board the middle is the best target");
+  const pmr::vector<unsigned int> &heat = engine.getHeatmap();
+  assertTrue4(heat.size() == 100 && heat[0] == heat[9] && heat[0] == heat[90] &&
+                  heat[0] == heat[99] && heat[0] < heat[44],
+              "Empty board heatmap should be symmetric, corners lowest");
+
+  tracker.shotResult(Shot(GridPosition("E5")), Shot::HIT);
+  GridPosition followUp = engine.chooseTarget(tracker);
+  assertTrue4(followUp == GridPosition("D5") || followUp == GridPosition("F5") ||
+                  followUp == GridPosition("E4") ||
+                  followUp == GridPosition("E6"),
+              "After a hit the engine should fire next to it");
+
+  tracker.shotResult(Shot(GridPosition("A1")), Shot::HIT);
+  tracker.shotResult(Shot(GridPosition("A2")), Shot::SUNKEN);
+  engine.chooseTarget(tracker);
+  assertTrue4(engine.getHeatmap()[GridPosition("A3").toIndex(10)] == 0 &&
+                  engine.getHeatmap()[GridPosition("B2").toIndex(10)] == 0,
+              "Squares next to a sunk ship should score 0");
+
+  // Playing whole games: never the same square twice, always a win
+  bool gamesOk = true;
+  for (int game = 0; game < 20 && gamesOk; game++) {
+    int gameRows = (game % 2 == 0) ? 10 : 8;
+    int gameColumns = (game % 2 == 0) ? 10 : 13;
+    OwnGrid enemy(gameRows, gameColumns);
+    generator.fill(enemy);
+    OpponentGrid view(gameRows, gameColumns);
+
+    int sunk = 0;
+    for (int shot = 0; shot < gameRows * gameColumns && sunk < 10; shot++) {
+      GridPosition target = engine.chooseTarget(view);
+      if (!target.isValid() ||
+          view.getCellState(target) != OpponentGrid::UNKNOWN) {
+        gamesOk = false;
+        break;
+      }
+      Shot::Impact impact = enemy.takeBlow(Shot(target));
+      view.shotResult(Shot(target), impact);
+      sunk += (impact == Shot::SUNKEN) ? 1 : 0;
+    }
+    gamesOk = gamesOk && sunk == 10;
+  }
+  assertTrue4(gamesOk, "Engine should sink every fleet without repeat shots");
+
+  // --- Simulator Tests ---
+  Simulator simulator(10, 10, 99);
+  vector<GameResult> oneThread;
+  vector<GameResult> threeThreads;
+  SimulationReport report = simulator.run(40, 1, &oneThread);
+  simulator.run(40, 3, &threeThreads);
+
+  bool sameGames = oneThread.size() == 40 && threeThreads.size() == 40;
+  for (size_t game = 0; sameGames && game < oneThread.size(); game++) {
+    sameGames = oneThread[game].winner == threeThreads[game].winner &&
+                oneThread[game].shots == threeThreads[game].shots &&
+                oneThread[game].winner >= 0;
+  }
+  assertTrue4(sameGames,
+              "Every game should have a winner, whatever the thread count");
+  assertTrue4(report.wins[0] + report.wins[1] == 40 &&
+                  report.shotsPercentile(0) >= 30 &&
+                  report.shotsPercentile(1) <= 100,
+              "Report should count every game with a sensible shot count");
+
+  // --- ConsoleView Tests ---
+  Board viewBoard(3, 4);
+  viewBoard.getOwnGrid().placeShip(
+      Ship(GridPosition("A1"), GridPosition("A2")));
+  viewBoard.getOwnGrid().takeBlow(Shot(GridPosition("A2")));
+  viewBoard.getOwnGrid().takeBlow(Shot(GridPosition("C4")));
+  viewBoard.getOpponentGrid().shotResult(Shot(GridPosition("B3")),
+                                         Shot::NONE);
+  viewBoard.getOpponentGrid().shotResult(Shot(GridPosition("C1")),
+                                         Shot::HIT);
+  ConsoleView view(&viewBoard);
+
+  string rendered = "some old text that is longer than the frame";
+  view.renderTo(rendered);
+  ostringstream streamed;
+  view.renderTo(streamed);
+  assertTrue4(rendered == "  1 2 3 4     1 2 3 4 \n"
+                          "A # O ~ ~   A ~ ~ ~ ~ \n"
+                          "B ~ ~ ~ ~   B ~ ~ ^ ~ \n"
+                          "C ~ ~ ~ ^   C O ~ ~ ~ \n",
+              "renderTo should draw both grids with the usual symbols");
+  assertTrue4(streamed.str() == rendered,
+              "renderTo should give the same text for strings and streams");
+
+  string live;
+  view.renderLiveTo(live);
+  assertTrue4(live == "\x1b[H\x1b[2J" + rendered,
+              "The first live update should clear and draw everything");
+  view.renderLiveTo(live);
+  assertTrue4(live.empty(), "A live update without changes should be empty");
+  viewBoard.getOpponentGrid().shotResult(Shot(GridPosition("A1")),
+                                         Shot::NONE);
+  view.renderLiveTo(live);
+  assertTrue4(live == "\x1b[2;15H^\x1b[5;1H",
+              "A live update should only redraw the changed square");
+  view.restartLive();
+  view.renderLiveTo(live);
+  assertTrue4(live.size() > rendered.size(),
+              "After restartLive the whole frame should be drawn again");
+
+  // --- CompactBoard Tests ---
+  FleetGenerator compactGenerator(5);
+  Board original(10, 10);
+  OwnGrid enemyFleet(10, 10);
+  compactGenerator.fill(original.getOwnGrid());
+  compactGenerator.fill(enemyFleet);
+  TargetingEngine compactEngine;
+  for (int shot = 0; shot < 50; shot++) {
+    GridPosition target =
+        compactEngine.chooseTarget(original.getOpponentGrid());
+    original.getOpponentGrid().shotResult(Shot(target),
+                                          enemyFleet.takeBlow(Shot(target)));
+    original.getOwnGrid().takeBlow(
+        Shot(GridPosition::fromIndex((shot * 37) % 100, 10)));
+  }
+
+  CompactBoard compact;
+  assertTrue4(compact.load(original), "A 10x10 board should fit");
+  CompactBoard clone;
+  memcpy(&clone, &compact, sizeof(CompactBoard));
+  Board roundTrip = clone.toBoard();
+
+  string originalText;
+  string roundTripText;
+  ConsoleView(&original).renderTo(originalText);
+  ConsoleView(&roundTrip).renderTo(roundTripText);
+  assertTrue4(originalText == roundTripText &&
+                  roundTrip.getOpponentGrid().getSunkenShipView().size() ==
+                      original.getOpponentGrid().getSunkenShipView().size(),
+              "A memcpy'd CompactBoard should convert back to the same Board");
+
+  bool sameAnswers = clone.getSunkenShipCount() ==
+                     int(original.getOpponentGrid().getSunkenShipView().size());
+  for (int shot = 0; shot < 100; shot++) {
+    GridPosition target = GridPosition::fromIndex((shot * 13) % 100, 10);
+    Shot::Impact enemyAnswer = enemyFleet.takeBlow(Shot(target));
+    original.getOpponentGrid().shotResult(Shot(target), enemyAnswer);
+    clone.shotResult(Shot(target), enemyAnswer);
+    sameAnswers = sameAnswers &&
+                  original.getOwnGrid().takeBlow(Shot(target)) ==
+                      clone.takeBlow(Shot(target)) &&
+                  original.getOpponentGrid().getCellState(target) ==
+                      clone.getCellState(target);
+  }
+  sameAnswers = sameAnswers && clone.getShipsAfloat() == 0 &&
+                clone.getSunkenShipCount() == 10;
+  for (int shipIdx = 0; sameAnswers && shipIdx < 10; shipIdx++) {
+    Ship cloneShip = clone.getSunkenShip(shipIdx);
+    Ship boardShip = original.getOpponentGrid().getSunkenShipView()[shipIdx];
+    sameAnswers = cloneShip.getBow() == boardShip.getBow() &&
+                  cloneShip.getStern() == boardShip.getStern();
+  }
+  assertTrue4(sameAnswers,
+              "CompactBoard should answer shots exactly like Board");
+
+  Board bigBoard(12, 12);
+  assertTrue4(!compact.load(bigBoard) && compact.getRows() == 10,
+              "A 12x12 board shouldn't fit and should leave the copy alone");
+
+  // A board with its own fleet comes back with the same inventory
+  Board fleetBoard = RuleSet::find("small")->makeBoard();
+  fleetBoard.getOwnGrid().placeShip(Ship(GridPosition("A1"),
+                                         GridPosition("A4")));
+  fleetBoard.getOwnGrid().placeShip(Ship(GridPosition("C1"),
+                                         GridPosition("C3")));
+  CompactBoard compactSmall;
+  bool smallLoaded = compactSmall.load(fleetBoard);
+  Board smallTrip = compactSmall.toBoard();
+  assertTrue4(smallLoaded && smallTrip.getOwnGrid().getShipCount() == 2 &&
+                  smallTrip.getOwnGrid().getAvailableShips() ==
+                      fleetBoard.getOwnGrid().getAvailableShips() &&
+                  !smallTrip.getOwnGrid().placeShip(
+                      Ship(GridPosition("E1"), GridPosition("E4"))),
+              "A CompactBoard should keep the board's fleet inventory");
+
+  // Sinks after the first MAX_SHIPS are marked, but reported as not kept
+  CompactBoard sinkList;
+  Board emptyBoard(10, 10);
+  sinkList.load(emptyBoard);
+  int keptSinks = 0;
+  for (int sink = 0; sink < CompactBoard::MAX_SHIPS + 1; sink++) {
+    GridPosition lone = GridPosition::fromIndex(sink * 2 + (sink / 5) * 10, 10);
+    keptSinks += sinkList.shotResult(Shot(lone), Shot::SUNKEN) ? 1 : 0;
+  }
+  assertTrue4(keptSinks == CompactBoard::MAX_SHIPS &&
+                  sinkList.getSunkenShipCount() == CompactBoard::MAX_SHIPS &&
+                  sinkList.getCellState(GridPosition("E1")) ==
+                      OpponentGrid::SUNK,
+              "A CompactBoard should report the sink that doesn't fit");
+
+  // --- Undo Tests ---
+  FleetGenerator undoGenerator(8);
+  OwnGrid undoFleet(10, 10);
+  undoGenerator.fill(undoFleet);
+  OpponentGrid undoView(10, 10);
+  TargetingEngine undoEngine;
+
+  vector<GridPosition> undoTargets;
+  vector<Shot::Impact> undoImpacts;
+  pmr::vector<unsigned char> statesAt30;
+  pmr::set<GridPosition> shotsAt30;
+  size_t sunkAt30 = 0;
+  undoFleet.takeBlow(Shot(GridPosition("K1"))); // Off the grid
+  while (undoView.getSunkenShipView().size() < 10) {
+    if (undoTargets.size() == 30) {
+      statesAt30 = undoView.getCellStates();
+      shotsAt30 = undoFleet.getShotAt();
+      sunkAt30 = undoView.getSunkenShipView().size();
+      undoFleet.takeBlow(Shot(undoTargets[0])); // Repeated shot
+    }
+    GridPosition target = undoEngine.chooseTarget(undoView);
+    Shot::Impact impact = undoFleet.takeBlow(Shot(target));
+    undoView.shotResult(Shot(target), impact);
+    undoTargets.push_back(target);
+    undoImpacts.push_back(impact);
+  }
+
+  for (size_t shot = undoTargets.size(); shot > 30; shot--) {
+    undoFleet.undoBlow();
+    undoView.undoShotResult();
+  }
+  undoFleet.undoBlow(); // The repeated shot
+  bool undoneTo30 = undoView.getCellStates() == statesAt30 &&
+                    undoView.getSunkenShipView().size() == sunkAt30 &&
+                    undoFleet.getShotAt() == shotsAt30;
+  for (size_t shot = 30; shot < undoTargets.size(); shot++) {
+    undoneTo30 = undoneTo30 &&
+                 undoFleet.takeBlow(Shot(undoTargets[shot])) ==
+                     undoImpacts[shot];
+  }
+  assertTrue4(undoneTo30,
+              "Undoing shots should restore both grids exactly");
+
+  while (undoFleet.undoBlow()) {
+  }
+  while (undoView.undoShotResult()) {
+  }
+  bool allUndone = undoFleet.getShotAt().empty() &&
+                   undoView.getShotsAt().empty() &&
+                   undoView.getSunkenShipView().empty();
+  for (size_t wordIdx = 0; wordIdx < undoFleet.getShotMask().size();
+       wordIdx++) {
+    allUndone = allUndone && undoFleet.getShotMask()[wordIdx] == 0;
+  }
+  assertTrue4(allUndone, "Undoing every shot should give empty grids");
+
+  // A square off the grid stays in the shot set until its first shot is
+  // undone
+  OwnGrid strayGrid(10, 10);
+  strayGrid.takeBlow(Shot(GridPosition("K1")));
+  strayGrid.takeBlow(Shot(GridPosition("A1")));
+  strayGrid.takeBlow(Shot(GridPosition("K1")));
+  strayGrid.undoBlow();
+  bool strayKept = strayGrid.getShotAt().size() == 2 &&
+                   strayGrid.getShotAt().count(GridPosition("K1")) == 1;
+  strayGrid.undoBlow();
+  strayGrid.undoBlow();
+  assertTrue4(strayKept && strayGrid.getShotAt().empty(),
+              "Undoing a repeated shot off the grid should keep its square");
+
+  // --- Large Board Tests ---
+  assertTrue4(LargePosition("AA12") == LargePosition(27, 12) &&
+                  LargePosition("ZZ1").getRow() == 702 &&
+                  LargePosition("AAA1").getRow() == 703 &&
+                  string(LargePosition(703, 5)) == "AAA5" &&
+                  string(LargePosition(26, 1)) == "Z1",
+              "Row labels should go A..Z, AA..ZZ, AAA..");
+  assertTrue4(!LargePosition("12").isValid() &&
+                  !LargePosition("AA").isValid() &&
+                  !LargePosition("a1").isValid() &&
+                  !LargePosition("B1x").isValid() &&
+                  !LargePosition("B0").isValid() &&
+                  !LargePosition("ZZZZZZZ1").isValid() &&
+                  !LargePosition("A99999999999").isValid(),
+              "Malformed labels should give invalid positions");
+
+  LargeOwnGrid largeGrid(1000, 1000);
+  bool largePlaced =
+      largeGrid.placeShip(LargeShip(LargePosition("Y500"),
+                                    LargePosition("AC500"))) && // Rows 25-29
+      largeGrid.placeShip(LargeShip(LargePosition("ALL997"),
+                                    LargePosition("ALL1000"))) && // Row 1000
+      largeGrid.placeShip(LargeShip(LargePosition(400, 1),
+                                    LargePosition(402, 1)));
+  assertTrue4(largePlaced, "Ships should fit anywhere on a 1000x1000 board");
+  assertTrue4(!largeGrid.placeShip(LargeShip(LargePosition("AD501"),
+                                             LargePosition("AD502"))) &&
+                  !largeGrid.placeShip(LargeShip(LargePosition(1000, 1000),
+                                                 LargePosition(1001, 1000))) &&
+                  !largeGrid.placeShip(LargeShip(LargePosition(10, 10),
+                                                 LargePosition(10, 15))),
+              "Touching, off-board and too long ships should be refused");
+
+  LargeOpponentGrid largeTracker(1000, 1000);
+  Shot::Impact largeImpacts[5];
+  for (int row = 25; row <= 29; row++) {
+    largeImpacts[row - 25] = largeGrid.takeBlow(LargePosition(row, 500));
+    largeTracker.shotResult(LargePosition(row, 500), largeImpacts[row - 25]);
+  }
+  largeTracker.shotResult(LargePosition(24, 500),
+                          largeGrid.takeBlow(LargePosition(24, 500)));
+  assertTrue4(largeImpacts[0] == Shot::HIT && largeImpacts[3] == Shot::HIT &&
+                  largeImpacts[4] == Shot::SUNKEN &&
+                  largeGrid.takeBlow(LargePosition(29, 500)) == Shot::SUNKEN &&
+                  largeGrid.getShotCount() == 6,
+              "A ship across rows Z/AA should take hits and sink");
+  assertTrue4(largeTracker.getSunkenShips().size() == 1 &&
+                  largeTracker.getSunkenShips()[0].getBow() ==
+                      LargePosition("Y500") &&
+                  largeTracker.getSunkenShips()[0].getStern() ==
+                      LargePosition("AC500") &&
+                  largeTracker.getCellState(LargePosition(24, 500)) ==
+                      OpponentGrid::MISS &&
+                  largeTracker.getCellState(LargePosition(1, 1)) ==
+                      OpponentGrid::UNKNOWN &&
+                  largeTracker.getShotCount() == 6,
+              "The large tracker should piece together the sunk ship");
+
+  // Squares shot before a ship is placed count as hits on it, as on OwnGrid
+  LargeOwnGrid earlyGrid(1000, 1000);
+  OwnGrid earlySmallGrid(10, 10);
+  for (int col = 1; col <= 2; col++) {
+    earlyGrid.takeBlow(LargePosition(700, col));
+    earlySmallGrid.takeBlow(Shot(GridPosition('A', col)));
+  }
+  bool earlyPlaced =
+      earlyGrid.placeShip(LargeShip(LargePosition(700, 1),
+                                    LargePosition(700, 3))) &&
+      earlySmallGrid.placeShip(Ship(GridPosition("A1"), GridPosition("A3")));
+  assertTrue4(earlyPlaced &&
+                  earlyGrid.takeBlow(LargePosition(700, 3)) == Shot::SUNKEN &&
+                  earlySmallGrid.takeBlow(Shot(GridPosition("A3"))) ==
+                      Shot::SUNKEN,
+              "Shots fired before a ship was placed should count as hits");
+
+  // --- Salvo Tests ---
+  FleetGenerator salvoGenerator(21);
+  OwnGrid salvoGrid(10, 10);
+  salvoGenerator.fill(salvoGrid);
+  OwnGrid stepGrid = salvoGrid;
+
+  vector<Shot> salvo;
+  for (int shot = 0; shot < 300; shot++) {
+    // Lots of repeats, and now and then a shot off the grid (row K, column 11)
+    int square = (shot * 37 + shot / 3) % 121;
+    salvo.push_back(Shot(GridPosition(char('A' + square / 11), 1 + square % 11)));
+  }
+  vector<Shot::Impact> salvoImpacts(salvo.size());
+  size_t processed = salvoGrid.takeBlows(salvo, salvoImpacts);
+
+  bool salvoMatches = processed == salvo.size();
+  for (size_t shot = 0; shot < salvo.size(); shot++) {
+    salvoMatches =
+        salvoMatches && stepGrid.takeBlow(salvo[shot]) == salvoImpacts[shot];
+  }
+  salvoMatches = salvoMatches && stepGrid.getShotAt() == salvoGrid.getShotAt() &&
+                 stepGrid.getShotMask() == salvoGrid.getShotMask();
+  assertTrue4(salvoMatches,
+              "A salvo should give the same answers as single shots");
+
+  OpponentGrid salvoTracker(10, 10);
+  OpponentGrid stepTracker(10, 10);
+  salvoTracker.shotResults(salvo, salvoImpacts);
+  for (size_t shot = 0; shot < salvo.size(); shot++) {
+    stepTracker.shotResult(salvo[shot], salvoImpacts[shot]);
+  }
+  bool sameSunk = salvoTracker.getSunkenShipView().size() ==
+                  stepTracker.getSunkenShipView().size();
+  for (size_t shipIdx = 0;
+       sameSunk && shipIdx < salvoTracker.getSunkenShipView().size();
+       shipIdx++) {
+    sameSunk = salvoTracker.getSunkenShipView()[shipIdx].getBow() ==
+                   stepTracker.getSunkenShipView()[shipIdx].getBow() &&
+               salvoTracker.getSunkenShipView()[shipIdx].getStern() ==
+                   stepTracker.getSunkenShipView()[shipIdx].getStern();
+  }
+  assertTrue4(sameSunk &&
+                  salvoTracker.getCellStates() == stepTracker.getCellStates() &&
+                  salvoTracker.getShotsAt() == stepTracker.getShotsAt(),
+              "Recording a salvo should match recording single results");
+
+  int undone = 0;
+  while (salvoGrid.undoBlow() && salvoTracker.undoShotResult()) {
+    undone++;
+  }
+  assertTrue4(undone == 300 && salvoGrid.getShotAt().empty() &&
+                  salvoTracker.getShotsAt().empty(),
+              "Every shot of a salvo should be undoable");
+
+  // Five times as many shots as squares, all on 20 of them: the repeats
+  // fit in the room reserved for one record per square
+  OwnGrid repeatGrid(10, 10);
+  salvoGenerator.fill(repeatGrid);
+  vector<Shot> repeatSalvo;
+  for (int shot = 0; shot < 500; shot++) {
+    repeatSalvo.push_back(Shot(GridPosition::fromIndex((shot * 7) % 20, 10)));
+  }
+  vector<Shot::Impact> repeatImpacts(repeatSalvo.size());
+  size_t beforeRepeats = heapAllocations;
+  repeatGrid.takeBlows(repeatSalvo, repeatImpacts);
+  size_t repeatAllocations = heapAllocations - beforeRepeats;
+  int repeatUndone = 0;
+  while (repeatGrid.undoBlow()) {
+    repeatUndone++;
+  }
+  assertTrue4(repeatUndone == 500 && repeatGrid.getShotLog().size() == 0 &&
+                  repeatGrid.getShotAt().empty(),
+              "Every repeated shot of a salvo should be undoable");
+  if (COUNTS_ALLOCATIONS) {
+    assertTrue4(repeatAllocations == 0,
+                "A salvo with repeated shots should not call operator new");
+  }
+
+  // --- BoardBatch Tests ---
+  const int BATCH_SIZE = 37; // Not a multiple of 4, so the tails get used
+  BoardBatch::Kernel kernels[3] = {BoardBatch::SCALAR, BoardBatch::SSE2,
+                                   BoardBatch::AVX2};
+  for (int kernelIdx = 0; kernelIdx < 3; kernelIdx++) {
+    BoardBatch batch(BATCH_SIZE, 10, 10);
+    if (!batch.setKernel(kernels[kernelIdx])) {
+      continue; // This CPU can't run it
+    }
+
+    // A second batch gets the same shots packed into square indices
+    BoardBatch packedBatch(BATCH_SIZE, 10, 10);
+    packedBatch.setKernel(kernels[kernelIdx]);
+
+    FleetGenerator batchGenerator(77);
+    vector<Board> references;
+    bool loaded = true;
+    for (int boardIdx = 0; boardIdx < BATCH_SIZE; boardIdx++) {
+      references.push_back(Board(10, 10));
+      batchGenerator.fill(references.back().getOwnGrid());
+      references.back().getOwnGrid().takeBlow(
+          Shot(GridPosition::fromIndex(boardIdx, 10)));
+      loaded = batch.load(boardIdx, references.back()) &&
+               packedBatch.load(boardIdx, references.back()) && loaded;
+    }
+
+    bool batchMatches = loaded;
+    bool packedMatches = loaded;
+    uint64_t random = 2024;
+    vector<Shot> round;
+    vector<uint16_t> packedRound;
+    vector<Shot::Impact> batchImpacts(BATCH_SIZE);
+    vector<Shot::Impact> packedImpacts(BATCH_SIZE);
+    for (int roundIdx = 0; roundIdx < 150; roundIdx++) {
+      round.clear();
+      packedRound.clear();
+      for (int boardIdx = 0; boardIdx < BATCH_SIZE; boardIdx++) {
+        random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+        int square = int((random >> 33) % 111); // 100-110: off the grid
+        round.push_back(Shot(GridPosition(char('A' + square / 10),
+                                          square % 10 + 1)));
+        packedRound.push_back(
+            packedBatch.toCell(round.back().getTargetPosition()));
+      }
+      batch.takeBlows(round, batchImpacts);
+      batch.shotResults(round, batchImpacts);
+      packedBatch.takeBlows(packedRound, packedImpacts);
+      packedBatch.shotResults(packedRound, packedImpacts);
+      packedMatches = packedMatches && packedImpacts == batchImpacts;
+
+      for (int boardIdx = 0; boardIdx < BATCH_SIZE; boardIdx++) {
+        Board &reference = references[boardIdx];
+        Shot::Impact impact = reference.getOwnGrid().takeBlow(round[boardIdx]);
+        reference.getOpponentGrid().shotResult(round[boardIdx], impact);
+        batchMatches = batchMatches && impact == batchImpacts[boardIdx];
+      }
+    }
+
+    for (int boardIdx = 0; boardIdx < BATCH_SIZE; boardIdx++) {
+      OpponentGrid &tracker = references[boardIdx].getOpponentGrid();
+      for (int idx = 0; idx < 100; idx++) {
+        GridPosition position = GridPosition::fromIndex(idx, 10);
+        packedMatches = packedMatches &&
+                        packedBatch.getCellState(boardIdx, position) ==
+                            batch.getCellState(boardIdx, position) &&
+                        packedBatch.isShotAt(boardIdx, position) ==
+                            batch.isShotAt(boardIdx, position);
+        batchMatches = batchMatches &&
+                       batch.getCellState(boardIdx, position) ==
+                           tracker.getCellState(position) &&
+                       batch.isShotAt(boardIdx, position) ==
+                           (references[boardIdx].getOwnGrid().getShotAt().count(
+                                position) > 0);
+      }
+      packedMatches = packedMatches &&
+                      packedBatch.getSunkenShipCount(boardIdx) ==
+                          batch.getSunkenShipCount(boardIdx);
+      for (int shipIdx = 0;
+           packedMatches && shipIdx < batch.getSunkenShipCount(boardIdx);
+           shipIdx++) {
+        packedMatches =
+            packedBatch.getSunkenShip(boardIdx, shipIdx).getBow() ==
+                batch.getSunkenShip(boardIdx, shipIdx).getBow() &&
+            packedBatch.getSunkenShip(boardIdx, shipIdx).getStern() ==
+                batch.getSunkenShip(boardIdx, shipIdx).getStern();
+      }
+      size_t sunkCount = tracker.getSunkenShipView().size();
+      batchMatches = batchMatches &&
+                     batch.getSunkenShipCount(boardIdx) ==
+                         int(sunkCount < 10 ? sunkCount : 10);
+      for (int shipIdx = 0;
+           batchMatches && shipIdx < batch.getSunkenShipCount(boardIdx);
+           shipIdx++) {
+        batchMatches = batch.getSunkenShip(boardIdx, shipIdx).getBow() ==
+                           tracker.getSunkenShipView()[shipIdx].getBow() &&
+                       batch.getSunkenShip(boardIdx, shipIdx).getStern() ==
+                           tracker.getSunkenShipView()[shipIdx].getStern();
+      }
+    }
+    assertTrue4(batchMatches, string("BoardBatch (") +
+                                  BoardBatch::kernelName(kernels[kernelIdx]) +
+                                  ") should match Board shot for shot");
+    assertTrue4(packedMatches, string("BoardBatch (") +
+                                   BoardBatch::kernelName(kernels[kernelIdx]) +
+                                   ") should take packed shots like Shots");
+  }
+  assertTrue4(BoardBatch::isSupported(BoardBatch::SCALAR) &&
+                  BoardBatch(4, 12, 12).getSize() == 0,
+              "The scalar kernel is always there; big boards don't fit");
+  BoardBatch packingBatch(1, 10, 10);
+  assertTrue4(packingBatch.toCell(GridPosition("A1")) == 0 &&
+                  packingBatch.toCell(GridPosition("J10")) == 99 &&
+                  packingBatch.toCell(GridPosition("K1")) ==
+                      BoardBatch::OFF_GRID &&
+                  packingBatch.toCell(GridPosition("A11")) ==
+                      BoardBatch::OFF_GRID,
+              "toCell() should pack squares row by row, off grid to OFF_GRID");
+
+  // --- GameLog Tests ---
+  const char *logPath = "part4tests_gamelog.bin";
+  remove(logPath);
+  Simulator logSimulator(10, 10, 5);
+  vector<GameResult> loggedResults;
+  GameLogWriter logWriter;
+  bool logWritten = logWriter.open(logPath);
+  for (int game = 0; game < 6; game++) {
+    if (game == 3) { // Open it again: the rest must be appended
+      logWriter.close();
+      logWritten = logWriter.open(logPath) && logWritten;
+    }
+    loggedResults.push_back(
+        logSimulator.playGame(logSimulator.gameSeed(game), &logWriter));
+  }
+  logWriter.close();
+
+  GameLogReader logReader;
+  GameRecord record;
+  bool replayMatches = logWritten && logReader.open(logPath);
+  int logGames = 0;
+  while (replayMatches && logReader.next(record)) {
+    Board first(10, 10);
+    Board second(10, 10);
+    Board *replayBoards[2] = {&first, &second};
+    GameResult &expected = loggedResults[logGames];
+    replayMatches = record.getSeed() == logSimulator.gameSeed(logGames) &&
+                    record.replay(first, second) &&
+                    record.getShipCount(0) == 10 &&
+                    record.getShipCount(1) == 10;
+
+    // The winner fired the last shot and has sunk the whole enemy fleet
+    int winner = record.getShooter(record.getShotCount() - 1);
+    OpponentGrid &winnerTracker = replayBoards[winner]->getOpponentGrid();
+    OwnGrid &loserGrid = replayBoards[1 - winner]->getOwnGrid();
+    replayMatches = replayMatches && winner == expected.winner &&
+                    winnerTracker.getSunkenShipView().size() == 10 &&
+                    loserGrid.getShotAt().size() == size_t(expected.shots);
+    logGames++;
+  }
+  assertTrue4(replayMatches && logGames == 6 && !logReader.hasError(),
+              "Logged games should replay to the same winners");
+
+  // Cut the last game short: the reader has to notice
+  size_t fullSize = logReader.getFileSize();
+  logReader.close();
+  FILE *logFile = fopen(logPath, "r+b");
+  vector<char> logBytes(fullSize);
+  bool truncated = logFile != 0 &&
+                   fread(logBytes.data(), 1, fullSize, logFile) == fullSize;
+  if (logFile != 0) {
+    fclose(logFile);
+  }
+  logFile = fopen(logPath, "wb");
+  truncated = truncated && logFile != 0 &&
+              fwrite(logBytes.data(), 1, fullSize - 3, logFile) ==
+                  fullSize - 3;
+  if (logFile != 0) {
+    fclose(logFile);
+  }
+  int readBeforeError = 0;
+  truncated = truncated && logReader.open(logPath);
+  while (truncated && logReader.next(record)) {
+    readBeforeError++;
+  }
+  assertTrue4(truncated && readBeforeError == 5 && logReader.hasError(),
+              "A cut-off game log should be reported as damaged");
+  logReader.close();
+  remove(logPath);
+
+  // --- GameStats Tests ---
+  GameStats handStats(10, 10);
+  bool handCounted = handStats.addTextGame("A1 A2 ; C1 C3 ; C1 J10 C2 J9 C3");
+  bool brokenSkipped = !handStats.addTextGame("A1 ; C1 C3 ; C1") &&
+                       !handStats.addTextGame("A1 A2 A2 B2 ; C1 C3 ; C1") &&
+                       !handStats.addTextGame("A1 A2 ; C1 C3");
+  assertTrue4(handCounted && brokenSkipped && handStats.getGames() == 1 &&
+                  handStats.getSkipped() == 3,
+              "Broken text games should be left out");
+  assertTrue4(handStats.getSunkShips(3) == 1 &&
+                  handStats.getSunkShips(2) == 0 &&
+                  handStats.getMeanShotsToSink(3) == 3,
+              "Sinking C1-C3 with three shots should count 3 shots to sink");
+  assertTrue4(handStats.getPlacementCount(2, GridPosition("A1")) == 1 &&
+                  handStats.getPlacementCount(3, GridPosition("C2")) == 1 &&
+                  handStats.getPlacementCount(2, GridPosition("C2")) == 0,
+              "Placement should count every square of a ship");
+  assertTrue4(handStats.getBandShots(0, GridPosition("C1")) == 1 &&
+                  handStats.getBandHits(0, GridPosition("C1")) == 1 &&
+                  handStats.getBandShots(0, GridPosition("J10")) == 1 &&
+                  handStats.getBandHits(0, GridPosition("J10")) == 0,
+              "Hit rate should count hits and misses per square");
+
+  // The same games as a log and as text must give the same CSV files
+  const char *statsPath = "part4tests_gamestats.bin";
+  remove(statsPath);
+  Simulator statsSimulator(10, 10, 21);
+  GameLogWriter statsWriter;
+  bool statsWritten = statsWriter.open(statsPath);
+  for (int game = 0; game < 40; game++) {
+    statsSimulator.playGame(statsSimulator.gameSeed(game), &statsWriter);
+  }
+  statsWriter.close();
+
+  GameStats logStats(10, 10);
+  stringstream textGames;
+  textGames << "# 40 self-play games" << endl;
+  statsWritten = statsWritten && logReader.open(statsPath);
+  while (statsWritten && logReader.next(record)) {
+    logStats.addGame(record);
+    // Text games start with player 0, so the fleets swap places if
+    // player 1 fired first
+    int starter = record.getShooter(0);
+    for (int side = 0; side < 2; side++) {
+      int player = (side == 0) ? starter : 1 - starter;
+      for (int shipIdx = 0; shipIdx < record.getShipCount(player);
+           shipIdx++) {
+        Ship ship = record.getShip(player, shipIdx);
+        textGames << string(ship.getBow()) << ' '
+                  << string(ship.getStern()) << ' ';
+      }
+      textGames << "; ";
+    }
+    for (uint32_t shotIdx = 0; shotIdx < record.getShotCount(); shotIdx++) {
+      textGames << string(record.getShot(shotIdx).getTargetPosition())
+                << ' ';
+    }
+    textGames << endl;
+  }
+  logReader.close();
+
+  GameAnalyzer textAnalyzer(10, 10, 2);
+  textAnalyzer.addText(textGames);
+  GameStats textStats = textAnalyzer.getStats();
+  stringstream logCsv;
+  stringstream textCsv;
+  logStats.writePlacementCsv(logCsv);
+  logStats.writeSinkCsv(logCsv);
+  logStats.writeHitRateCsv(logCsv);
+  textStats.writePlacementCsv(textCsv);
+  textStats.writeSinkCsv(textCsv);
+  textStats.writeHitRateCsv(textCsv);
+  assertTrue4(statsWritten && logStats.getGames() == 40 &&
+                  textStats.getGames() == 40 &&
+                  logStats.getSunkShips(2) >= 40 * 4 &&
+                  logCsv.str() == textCsv.str(),
+              "Log and text versions of the same games should give the "
+              "same CSV files");
+
+  // Threads must only change the speed, never the counts
+  string threadCsv[2];
+  int threadCounts[2] = {1, 3};
+  for (int run = 0; run < 2; run++) {
+    GameAnalyzer logAnalyzer(10, 10, threadCounts[run]);
+    bool read = logAnalyzer.addLog(statsPath);
+    GameStats merged = logAnalyzer.getStats();
+    stringstream csv;
+    merged.writePlacementCsv(csv);
+    merged.writeSinkCsv(csv);
+    merged.writeHitRateCsv(csv);
+    threadCsv[run] = read ? csv.str() : "";
+  }
+  assertTrue4(!threadCsv[0].empty() && threadCsv[0] == threadCsv[1] &&
+                  threadCsv[0] == logCsv.str(),
+              "GameAnalyzer should count the same with 1 and 3 threads");
+  remove(statsPath);
+
+  // --- Metrics Tests ---
+  Metrics::reset();
+  OwnGrid metricsGrid(10, 10);
+  const char *metricsShips[5][2] = {{"A1", "A3"},  // placed
+                                    {"B1", "B3"},  // touches A1-A3
+                                    {"A1", "B2"},  // diagonal
+                                    {"J8", "J11"}, // off the grid
+                                    {"F1", "F3"}}; // placed
+  for (int shipIdx = 0; shipIdx < 5; shipIdx++) {
+    metricsGrid.placeShip(Ship(GridPosition(metricsShips[shipIdx][0]),
+                               GridPosition(metricsShips[shipIdx][1])));
+  }
+  const char *metricsShots[6] = {"A1", "A1", "K1", "C5", "A2", "A3"};
+  OpponentGrid metricsTracker(10, 10);
+  for (int shotIdx = 0; shotIdx < 6; shotIdx++) {
+    Shot shot{GridPosition(metricsShots[shotIdx])};
+    metricsTracker.shotResult(shot, metricsGrid.takeBlow(shot));
+  }
+  std::thread metricsThread([]() { // Its counts must outlive the thread
+    OwnGrid otherGrid(10, 10);
+    otherGrid.takeBlow(Shot(GridPosition("B2")));
+  });
+  metricsThread.join();
+
+  Metrics::Snapshot metrics = Metrics::snapshot();
+  stringstream metricsText;
+  Metrics::dump(metricsText, metrics);
+  if (Metrics::ENABLED) {
+    assertTrue4(metrics.counters[Metrics::PLACE_OK] == 2 &&
+                    metrics.counters[Metrics::PLACE_TOO_CLOSE] == 1 &&
+                    metrics.counters[Metrics::PLACE_INVALID_SHIP] == 1 &&
+                    metrics.counters[Metrics::PLACE_OUT_OF_BOUNDS] == 1 &&
+                    metrics.getSamples(Metrics::PLACE_SHIP_NS) == 5,
+                "Metrics should count every placeShip() refusal by reason");
+    assertTrue4(metrics.counters[Metrics::BLOW_HIT] == 3 &&
+                    metrics.counters[Metrics::BLOW_REPEAT] == 1 &&
+                    metrics.counters[Metrics::BLOW_OFF_GRID] == 1 &&
+                    metrics.counters[Metrics::BLOW_SUNKEN] == 1 &&
+                    metrics.counters[Metrics::BLOW_MISS] == 2,
+                "Metrics should count takeBlow() answers of all threads");
+    assertTrue4(metrics.counters[Metrics::RESULT_SHOTS] == 6 &&
+                    metrics.counters[Metrics::RESULT_SINKS] == 1 &&
+                    metrics.getSamples(Metrics::SINK_DEDUCTION_NS) == 1 &&
+                    metricsText.str().find("blow_repeat: 1") !=
+                        string::npos,
+                "Metrics should time the sunk ship deduction");
+  } else {
+    assertTrue4(metrics.counters[Metrics::PLACE_OK] == 0 &&
+                    metrics.getSamples(Metrics::PLACE_SHIP_NS) == 0 &&
+                    metricsText.str().find("not built in") != string::npos,
+                "Metrics that are compiled out should report nothing");
+  }
+
+  // A salvo has to count the same answers as the same shots one by one
+  Metrics::reset();
+  OwnGrid salvoMetricsGrid(10, 10);
+  salvoMetricsGrid.placeShip(Ship(GridPosition("A1"), GridPosition("A3")));
+  vector<Shot> metricsSalvo;
+  for (int shotIdx = 0; shotIdx < 6; shotIdx++) {
+    metricsSalvo.push_back(Shot(GridPosition(metricsShots[shotIdx])));
+  }
+  vector<Shot::Impact> metricsImpacts(metricsSalvo.size());
+  salvoMetricsGrid.takeBlows(metricsSalvo, metricsImpacts);
+  Metrics::Snapshot salvoMetrics = Metrics::snapshot();
+  if (Metrics::ENABLED) {
+    assertTrue4(salvoMetrics.counters[Metrics::SALVO_SHOTS] == 6 &&
+                    salvoMetrics.counters[Metrics::BLOW_HIT] == 3 &&
+                    salvoMetrics.counters[Metrics::BLOW_REPEAT] == 1 &&
+                    salvoMetrics.counters[Metrics::BLOW_OFF_GRID] == 1 &&
+                    salvoMetrics.counters[Metrics::BLOW_SUNKEN] == 1 &&
+                    salvoMetrics.counters[Metrics::BLOW_MISS] == 1,
+                "Metrics should count the answers of a salvo");
+  }
+
+  // --- Trace Tests ---
+  Trace::clear();
+  Simulator traceSimulator(10, 10, 9);
+  traceSimulator.run(8, 2); // Events of the pool's threads must be kept
+  stringstream traceJson;
+  size_t traceEvents = Trace::writeJson(traceJson);
+  string traceText = traceJson.str();
+  bool traceWellFormed =
+      traceText.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[") == 0 &&
+      traceText.rfind("]}\n") == traceText.size() - 3;
+  if (Trace::ENABLED) {
+    assertTrue4(traceWellFormed && traceEvents > 8 * 50 &&
+                    traceText.find("\"name\":\"Simulator::playGame\"") !=
+                        string::npos &&
+                    traceText.find("\"name\":\"OwnGrid::takeBlow\"") !=
+                        string::npos &&
+                    traceText.find("\"args\":{\"n\":1}") != string::npos,
+                "Trace should hold the spans of games played by a pool");
+
+    // Far more spans than a ring holds: only the newest ones are kept
+    Trace::clear();
+    OwnGrid traceGrid(10, 10);
+    for (int blow = 0; blow < 3 * Trace::RING_SIZE; blow++) {
+      traceGrid.takeBlow(Shot(GridPosition("A1")));
+    }
+    stringstream fullJson;
+    size_t fullEvents = Trace::writeJson(fullJson);
+    assertTrue4(fullEvents <= size_t(Trace::RING_SIZE) &&
+                    fullEvents + 1 >= size_t(Trace::RING_SIZE),
+                "A full trace ring should keep only the newest spans");
+    Trace::clear();
+  } else {
+    assertTrue4(traceWellFormed && traceEvents == 0,
+                "A trace that is compiled out should be empty");
+  }
+
+  // --- GameRules Tests ---
+  assertTrue4(GermanRules::FLEET_SIZE == 10 &&
+                  GermanRules::FLEET_CELLS == 30 && GermanRules::WORDS == 2 &&
+                  GermanRules::MIN_LENGTH == 2 &&
+                  GermanRules::MAX_LENGTH == 5 &&
+                  GermanRules::countOf(3) == 3 &&
+                  GermanRules::countOf(6) == 0 && SmallRules::WORDS == 1 &&
+                  SmallRules::MAX_LENGTH == 4 && ClassicRules::FLEET_SIZE == 5,
+              "GameRules should work out its constants from the fleet");
+  const RuleSet *german = RuleSet::find("german");
+  const RuleSet *small = RuleSet::find("small");
+  assertTrue4(german != 0 && small != 0 && RuleSet::find("chess") == 0 &&
+                  RuleSet::getNames().size() == 3 &&
+                  german->getFleet() == GermanRules::fleet(),
+              "RuleSet::find() should know the compiled-in rules");
+
+  // Same fleets, same shots: FixedOwnGrid must answer like OwnGrid
+  bool fixedMatches = german != 0;
+  FleetGenerator rulesGenerator(77);
+  for (int game = 0; game < 20 && fixedMatches; game++) {
+    OwnGrid rulesGrid(10, 10, GermanRules::fleet());
+    rulesGenerator.fill(rulesGrid);
+    Span<const Ship> rulesFleet = rulesGrid.getShipView();
+    FixedOwnGrid<GermanRules> fixedGrid;
+    for (size_t shipIdx = 0; shipIdx < rulesFleet.size(); shipIdx++) {
+      fixedMatches = fixedGrid.placeShip(rulesFleet[shipIdx]) && fixedMatches;
+    }
+    fixedMatches = fixedMatches && fixedGrid.isFleetComplete() &&
+                   german->checkFleet(rulesFleet) &&
+                   !fixedGrid.canPlaceShip(Ship(GridPosition("A1"),
+                                                GridPosition("A2")));
+
+    vector<Shot> rulesShots;
+    for (int shotIdx = 0; shotIdx < 160; shotIdx++) { // Repeats, off-grid
+      int cell = (shotIdx * 37 + game * 11) % 120;
+      rulesShots.push_back(Shot(GridPosition::fromIndex(cell, 10)));
+    }
+    vector<Shot::Impact> rulesImpacts(rulesShots.size());
+    fixedMatches = fixedMatches &&
+                   german->takeBlows(rulesFleet, rulesShots, rulesImpacts) ==
+                       rulesShots.size();
+    for (size_t shotIdx = 0; shotIdx < rulesShots.size(); shotIdx++) {
+      Shot::Impact expected = rulesGrid.takeBlow(rulesShots[shotIdx]);
+      fixedMatches = fixedMatches &&
+                     fixedGrid.takeBlow(rulesShots[shotIdx]) == expected &&
+                     rulesImpacts[shotIdx] == expected;
+    }
+    fixedMatches = fixedMatches && fixedGrid.allSunk();
+  }
+  assertTrue4(fixedMatches,
+              "FixedOwnGrid<GermanRules> should answer every shot like "
+              "OwnGrid");
+
+  // Smaller rules: the inventory decides which ships fit
+  Board smallBoard = small->makeBoard();
+  OwnGrid &smallGrid = smallBoard.getOwnGrid();
+  FixedOwnGrid<SmallRules> fixedSmall;
+  Ship smallShips[4] = {Ship(GridPosition("A1"), GridPosition("A4")),
+                        Ship(GridPosition("C1"), GridPosition("C4")),
+                        Ship(GridPosition("E1"), GridPosition("E5")),
+                        Ship(GridPosition("H7"), GridPosition("H9"))};
+  bool smallAnswers[4] = {true, false, false, false}; // 2nd 4, 5, off grid
+  bool smallMatches = smallBoard.getRows() == 8 &&
+                      smallBoard.getColumns() == 8;
+  for (int shipIdx = 0; shipIdx < 4; shipIdx++) {
+    smallMatches = smallMatches &&
+                   smallGrid.placeShip(smallShips[shipIdx]) ==
+                       smallAnswers[shipIdx] &&
+                   fixedSmall.placeShip(smallShips[shipIdx]) ==
+                       smallAnswers[shipIdx];
+  }
+  assertTrue4(smallMatches && !small->checkFleet(vector<Ship>()),
+              "SmallRules should allow one ship of 4 and none of 5 on 8x8");
+
+  // --- Arena and Reset Tests ---
+  // Games in an arena give the same results as games on the heap, and
+  // after the first game they don't call the global operator new any more
+  Simulator arenaSimulator(10, 10, 2024);
+  GameArena arena;
+  bool arenaMatches = true;
+  for (int game = 0; game < 2; game++) { // Warm-up
+    arenaSimulator.playGame(arenaSimulator.gameSeed(game), arena);
+  }
+  size_t arenaAllocations = 0;
+  for (int game = 2; game < 40; game++) {
+    GameResult onHeap = arenaSimulator.playGame(arenaSimulator.gameSeed(game));
+    size_t before = heapAllocations;
+    GameResult inArena =
+        arenaSimulator.playGame(arenaSimulator.gameSeed(game), arena);
+    arenaAllocations += heapAllocations - before;
+    arenaMatches = arenaMatches && inArena.winner == onHeap.winner &&
+                   inArena.shots == onHeap.shots;
+  }
+  assertTrue4(arenaMatches,
+              "Games played in a GameArena should end like games on the heap");
+  if (COUNTS_ALLOCATIONS) {
+    assertTrue4(arenaAllocations == 0,
+                "Games played in a GameArena should not call operator new");
+  }
+
+  // A reset board is as good as new, and reusing it doesn't allocate
+  Board reusedBoard(10, 10);
+  FleetGenerator resetGenerator(31);
+  TargetingEngine resetEngine;
+  bool resetLikeNew = true;
+  size_t resetAllocations = 0;
+  for (int game = 0; game < 12; game++) {
+    size_t before = heapAllocations;
+    OwnGrid &resetGrid = reusedBoard.getOwnGrid();
+    OpponentGrid &resetTracker = reusedBoard.getOpponentGrid();
+    resetGenerator.fill(resetGrid);
+    resetGrid.takeBlow(Shot(GridPosition("K1"))); // Off the grid
+    while (resetTracker.getSunkenShipView().size() < 10) {
+      Shot shot(resetEngine.chooseTarget(resetTracker));
+      resetTracker.shotResult(shot, resetGrid.takeBlow(shot));
+    }
+    reusedBoard.reset();
+    if (game >= 2) {
+      resetAllocations += heapAllocations - before;
+    }
+
+    Board freshBoard(10, 10);
+    resetLikeNew =
+        resetLikeNew && resetGrid.getShipCount() == 0 &&
+        resetGrid.getAvailableShips() ==
+            freshBoard.getOwnGrid().getAvailableShips() &&
+        resetGrid.getOccupiedMask() ==
+            freshBoard.getOwnGrid().getOccupiedMask() &&
+        resetGrid.getBlockedMask() ==
+            freshBoard.getOwnGrid().getBlockedMask() &&
+        resetGrid.getShotMask() == freshBoard.getOwnGrid().getShotMask() &&
+        resetGrid.getShotAt().empty() && !resetGrid.undoBlow() &&
+        resetTracker.getCellStates() ==
+            freshBoard.getOpponentGrid().getCellStates() &&
+        resetTracker.getSunkenShipView().empty() &&
+        resetTracker.getShotsAt().empty() && !resetTracker.undoShotResult();
+  }
+  assertTrue4(resetLikeNew, "Board::reset() should give an empty board");
+  if (COUNTS_ALLOCATIONS) {
+    assertTrue4(resetAllocations == 0,
+                "Games on a reset Board should not call operator new");
+  }
+
+  // The scripted game of fullgametest.cpp, drawn into a string instead of
+  // printed. Its 40 allocations, all of them known in advance:
+  //   19 per Board (two of them, the second one for the touching ships):
+  //      OwnGrid: 4 inventory entries, 3 masks, the cell owners, the 4
+  //      reserved lists (ships, hit counts, shot log, undo history) and
+  //      the node pool of the shot set;
+  //      OpponentGrid: the cell states, the known empty and unresolved
+  //      hit masks, the result history, the sink undo stack and the node
+  //      pool of the shot map
+  //    1 for the first ship the tracker deduces (the list starts empty)
+  //    1 for the first frame; the later frames reuse its string
+  // Placing, shooting and the getShipView()/getShotLog()/getSunkenShipView()
+  // spans cost nothing.
+  const size_t SCRIPTED_GAME_ALLOCATIONS = 40;
+  bool scriptOk = true;
+  size_t beforeScript = heapAllocations;
+  {
+    Board scriptBoard(10, 10);
+    ConsoleView scriptView(&scriptBoard);
+    OwnGrid &scriptGrid = scriptBoard.getOwnGrid();
+    OpponentGrid &scriptTracker = scriptBoard.getOpponentGrid();
+    string frame;
+    const char *const FLEET[10][2] = {
+        {"A1", "A5"}, {"C1", "C4"}, {"E6", "E9"}, {"C6", "C8"},
+        {"G1", "G3"}, {"G5", "I5"}, {"I1", "I2"}, {"G7", "G8"},
+        {"I7", "I8"}, {"I10", "J10"}};
+    for (int shipIdx = 0; shipIdx < 10; shipIdx++) {
+      scriptOk = scriptOk &&
+                 scriptGrid.placeShip(Ship(GridPosition(FLEET[shipIdx][0]),
+                                           GridPosition(FLEET[shipIdx][1])));
+    }
+    scriptView.renderTo(frame);
+    scriptOk = scriptOk &&
+               !scriptGrid.placeShip(Ship(GridPosition("J3"),
+                                          GridPosition("J4"))) &&
+               !scriptGrid.placeShip(Ship(GridPosition("J9"),
+                                          GridPosition("J12")));
+
+    Board touchBoard(10, 10);
+    touchBoard.getOwnGrid().placeShip(
+        Ship(GridPosition("E5"), GridPosition("E7")));
+    scriptOk = scriptOk && !touchBoard.getOwnGrid().placeShip(
+                               Ship(GridPosition("D5"), GridPosition("D7")));
+
+    scriptOk = scriptOk &&
+               scriptGrid.takeBlow(Shot(GridPosition("B1"))) == Shot::NONE;
+    int sunkShips = 0;
+    for (int col = 1; col <= 5; col++) {
+      Shot::Impact impact = scriptGrid.takeBlow(Shot(GridPosition('A', col)));
+      sunkShips += (impact == Shot::SUNKEN) ? 1 : 0;
+    }
+    scriptView.renderTo(frame);
+
+    scriptTracker.shotResult(Shot(GridPosition("A1")), Shot::NONE);
+    for (int col = 2; col <= 4; col++) {
+      scriptTracker.shotResult(Shot(GridPosition('C', col)), Shot::HIT);
+    }
+    scriptTracker.shotResult(Shot(GridPosition("C5")), Shot::SUNKEN);
+    scriptOk = scriptOk && scriptTracker.getSunkenShipView().size() == 1;
+
+    for (int shipIdx = 1; shipIdx < 10; shipIdx++) {
+      Ship ship(GridPosition(FLEET[shipIdx][0]),
+                GridPosition(FLEET[shipIdx][1]));
+      const GridPosition &bow = ship.getBow();
+      const GridPosition &stern = ship.getStern();
+      for (char row = bow.getRow(); row <= stern.getRow(); row++) {
+        for (int col = bow.getColumn(); col <= stern.getColumn(); col++) {
+          Shot::Impact impact =
+              scriptGrid.takeBlow(Shot(GridPosition(row, col)));
+          sunkShips += (impact == Shot::SUNKEN) ? 1 : 0;
+        }
+      }
+    }
+    scriptView.renderTo(frame);
+    scriptOk = scriptOk && sunkShips == 10 &&
+               scriptGrid.getShotLog().size() == 31 &&
+               count(frame.begin(), frame.end(), 'O') == 30 &&
+               count(frame.begin(), frame.end(), '#') == 4;
+  }
+  size_t scriptAllocations = heapAllocations - beforeScript;
+  assertTrue4(scriptOk, "The scripted game should play as in fullgametest");
+  if (COUNTS_ALLOCATIONS) {
+    assertTrue4(scriptAllocations == SCRIPTED_GAME_ALLOCATIONS,
+                "The scripted game should make a fixed number of allocations");
+  }
+
+  // --- Known Water Tests ---
+  // Sinking C2-C4 makes its ring known water; the hits before it are open
+  OpponentGrid waterTracker(10, 10);
+  waterTracker.shotResult(Shot(GridPosition("A1")), Shot::NONE);
+  waterTracker.shotResult(Shot(GridPosition("C2")), Shot::HIT);
+  waterTracker.shotResult(Shot(GridPosition("C3")), Shot::HIT);
+  bool openBefore = waterTracker.isUnresolvedHit(GridPosition("C2")) &&
+                    waterTracker.isUnresolvedHit(GridPosition("C3")) &&
+                    waterTracker.isKnownEmpty(GridPosition("A1")) &&
+                    !waterTracker.isKnownEmpty(GridPosition("B2"));
+  waterTracker.shotResult(Shot(GridPosition("C4")), Shot::SUNKEN);
+  int waterCount = 0;
+  int openCount = 0;
+  for (int cellIdx = 0; cellIdx < 100; cellIdx++) {
+    GridPosition position = GridPosition::fromIndex(cellIdx, 10);
+    waterCount += waterTracker.isKnownEmpty(position) ? 1 : 0;
+    openCount += waterTracker.isUnresolvedHit(position) ? 1 : 0;
+  }
+  assertTrue4(openBefore && waterCount == 13 && openCount == 0 &&
+                  waterTracker.isKnownEmpty(GridPosition("B1")) &&
+                  waterTracker.isKnownEmpty(GridPosition("C5")) &&
+                  waterTracker.isKnownEmpty(GridPosition("D5")) &&
+                  !waterTracker.isKnownEmpty(GridPosition("C3")) &&
+                  !waterTracker.isKnownEmpty(GridPosition("E3")) &&
+                  !waterTracker.isKnownEmpty(GridPosition("K1")),
+              "A sunk ship's ring should be known water");
+
+  // With the only ship sunk nothing scores; A3 is the first square left,
+  // but it is next to the ship, so A4 is the better guess
+  map<int, int> oneShip;
+  oneShip[2] = 1;
+  TargetingEngine oneShipEngine(oneShip);
+  OpponentGrid oneShipTracker(10, 10);
+  oneShipTracker.shotResult(Shot(GridPosition("A1")), Shot::HIT);
+  oneShipTracker.shotResult(Shot(GridPosition("A2")), Shot::SUNKEN);
+  assertTrue4(oneShipEngine.chooseTarget(oneShipTracker) == GridPosition("A4"),
+              "With nothing left to score, known water should be skipped");
+
+  waterTracker.undoShotResult();
+  assertTrue4(waterTracker.isUnresolvedHit(GridPosition("C2")) &&
+                  !waterTracker.isKnownEmpty(GridPosition("B2")) &&
+                  waterTracker.isKnownEmpty(GridPosition("A1")),
+              "Undoing a sink should give the ring back");
+
+  // In whole games the masks must agree with the real fleet: known water is
+  // never a ship, the ring of every sunk ship is known water, and the open
+  // hits are exactly the hits on ships still afloat. The engine never wastes
+  // a shot on known water.
+  FleetGenerator waterGenerator(77);
+  TargetingEngine waterEngine;
+  bool waterSound = true;
+  bool masksMatch = true;
+  bool skipsWater = true;
+  size_t undoAllocations = 0;
+  for (int game = 0; game < 5; game++) {
+    Board waterBoard(10, 10);
+    waterGenerator.fill(waterBoard.getOwnGrid());
+    OwnGrid &fleetGrid = waterBoard.getOwnGrid();
+    OpponentGrid &gameTracker = waterBoard.getOpponentGrid();
+    vector<Shot> gameShots;
+    vector<Shot::Impact> gameImpacts;
+    vector<pmr::vector<uint64_t>> waterSteps;
+    vector<pmr::vector<uint64_t>> hitSteps;
+    while (gameTracker.getSunkenShipView().size() < 10) {
+      waterSteps.push_back(gameTracker.getKnownEmptyMask());
+      hitSteps.push_back(gameTracker.getUnresolvedHitMask());
+      GridPosition target = waterEngine.chooseTarget(gameTracker);
+      skipsWater = skipsWater && !gameTracker.isKnownEmpty(target);
+      Shot shot(target);
+      Shot::Impact impact = fleetGrid.takeBlow(shot);
+      gameTracker.shotResult(shot, impact);
+      gameShots.push_back(shot);
+      gameImpacts.push_back(impact);
+
+      vector<bool> ring(100, false);
+      vector<bool> onSunk(100, false);
+      Span<const Ship> sunk = gameTracker.getSunkenShipView();
+      for (const Ship *shipIt = sunk.begin(); shipIt != sunk.end(); ++shipIt) {
+        GridArea halo = shipIt->blockedCells();
+        for (GridArea::Iterator posIt = halo.begin(); posIt != halo.end();
+             ++posIt) {
+          if ((*posIt).getRow() >= 'A' && (*posIt).getRow() <= 'J' &&
+              (*posIt).getColumn() >= 1 && (*posIt).getColumn() <= 10) {
+            ring[(*posIt).toIndex(10)] = true;
+          }
+        }
+        GridArea cells = shipIt->occupiedCells();
+        for (GridArea::Iterator posIt = cells.begin(); posIt != cells.end();
+             ++posIt) {
+          onSunk[(*posIt).toIndex(10)] = true;
+          ring[(*posIt).toIndex(10)] = false;
+        }
+      }
+
+      const pmr::vector<uint64_t> &occupied = fleetGrid.getOccupiedMask();
+      for (int cellIdx = 0; cellIdx < 100; cellIdx++) {
+        GridPosition position = GridPosition::fromIndex(cellIdx, 10);
+        OpponentGrid::CellState state = gameTracker.getCellState(position);
+        bool isShip = (occupied[cellIdx >> 6] >> (cellIdx & 63)) & 1;
+        waterSound = waterSound && !(gameTracker.isKnownEmpty(position) &&
+                                     isShip);
+        masksMatch =
+            masksMatch &&
+            gameTracker.isKnownEmpty(position) ==
+                (state == OpponentGrid::MISS || ring[cellIdx]) &&
+            gameTracker.isUnresolvedHit(position) ==
+                (state == OpponentGrid::HIT && !onSunk[cellIdx]);
+      }
+    }
+
+    OpponentGrid salvoWater(10, 10);
+    salvoWater.shotResults(gameShots, gameImpacts);
+    masksMatch = masksMatch &&
+                 salvoWater.getKnownEmptyMask() ==
+                     gameTracker.getKnownEmptyMask() &&
+                 salvoWater.getUnresolvedHitMask() ==
+                     gameTracker.getUnresolvedHitMask();
+    // Each undo, sinks included, must give back the masks from before
+    // that shot without touching the heap
+    size_t beforeUndo = heapAllocations;
+    for (size_t step = waterSteps.size(); step > 0; step--) {
+      gameTracker.undoShotResult();
+      masksMatch = masksMatch &&
+                   gameTracker.getKnownEmptyMask() == waterSteps[step - 1] &&
+                   gameTracker.getUnresolvedHitMask() == hitSteps[step - 1];
+    }
+    undoAllocations += heapAllocations - beforeUndo;
+    OpponentGrid emptyTracker(10, 10);
+    masksMatch = masksMatch &&
+                 gameTracker.getKnownEmptyMask() ==
+                     emptyTracker.getKnownEmptyMask() &&
+                 gameTracker.getUnresolvedHitMask() ==
+                     emptyTracker.getUnresolvedHitMask();
+  }
+  assertTrue4(waterSound, "Known water should never hold a ship");
+  assertTrue4(masksMatch,
+              "The water and open hit masks should follow every shot and undo");
+  if (COUNTS_ALLOCATIONS) {
+    assertTrue4(undoAllocations == 0,
+                "Undoing sinks should not call operator new");
+  }
+  assertTrue4(skipsWater, "The engine should never fire at known water");
+}
@@ -0,0 +1,101 @@
+/**
+ * @file gamestats.cpp
+ * @brief Turns recorded games into CSV heatmaps.
+ *
+ * Reads binary game logs (or text games, one per line, see GameStats) and
+ * writes three CSV files:
+ *   - <prefix>placement.csv: how often each square held a ship, per length
+ *   - <prefix>sinks.csv: ships sunk and mean shots to sink, per length
+ *   - <prefix>hitrate.csv: hit rate of every square, per band of turns
+ *
+ * Build from the project folder:
+ *   g++ -std=c++17 -O2 -pthread -I. tools/gamestats.cpp GameAnalyzer.cpp \
+ *       GameStats.cpp GameLog.cpp WorkStealingPool.cpp Board.cpp \
+ *       TargetingEngine.cpp OwnGrid.cpp NodePool.cpp OpponentGrid.cpp \
+ *       Ship.cpp Shot.cpp GridPosition.cpp -o gamestats
+ *
+ * Usage: gamestats [--text] [--threads N] [--size ROWS COLUMNS]
+ *                  [--out PREFIX] FILE...
+ *   FILE "-" reads text games from standard input.
+ */
+
+#include "GameAnalyzer.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+/**
+ * Writes one CSV file, returns false if it can't be created.
+ */
+bool writeCsv(const GameStats &stats, const string &path,
+              void (GameStats::*write)(ostream &) const) {
+  ofstream out(path.c_str());
+  if (!out) {
+    cerr << "Can't write " << path << endl;
+    return false;
+  }
+  (stats.*write)(out);
+  cout << "Wrote " << path << endl;
+  return bool(out);
+}
+
+int main(int argc, char *argv[]) {
+  bool text = false;
+  int threads = thread::hardware_concurrency();
+  int rows = 10;
+  int columns = 10;
+  string prefix = "";
+  vector<string> inputs;
+
+  for (int argIdx = 1; argIdx < argc; argIdx++) {
+    if (strcmp(argv[argIdx], "--text") == 0) {
+      text = true;
+    } else if (strcmp(argv[argIdx], "--threads") == 0 && argIdx + 1 < argc) {
+      threads = atoi(argv[++argIdx]);
+    } else if (strcmp(argv[argIdx], "--size") == 0 && argIdx + 2 < argc) {
+      rows = atoi(argv[++argIdx]);
+      columns = atoi(argv[++argIdx]);
+    } else if (strcmp(argv[argIdx], "--out") == 0 && argIdx + 1 < argc) {
+      prefix = argv[++argIdx];
+    } else {
+      inputs.push_back(argv[argIdx]);
+    }
+  }
+  if (inputs.empty() || rows < 1 || rows > 26 || columns < 1) {
+    cerr << "Usage: gamestats [--text] [--threads N] [--size ROWS COLUMNS]"
+         << " [--out PREFIX] FILE..." << endl;
+    return 1;
+  }
+
+  GameAnalyzer analyzer(rows, columns, (threads > 0) ? threads : 1);
+  for (vector<string>::const_iterator inputIt = inputs.begin();
+       inputIt != inputs.end(); ++inputIt) {
+    if (*inputIt == "-") {
+      analyzer.addText(cin);
+    } else if (text) {
+      ifstream in(inputIt->c_str());
+      if (!in) {
+        cerr << "Can't read " << *inputIt << endl;
+        return 1;
+      }
+      analyzer.addText(in);
+    } else if (!analyzer.addLog(*inputIt)) {
+      cerr << "Can't read all of " << *inputIt << endl;
+    }
+  }
+
+  GameStats stats = analyzer.getStats();
+  cout << stats.getGames() << " games counted, " << stats.getSkipped()
+       << " left out (" << analyzer.getThreadCount() << " threads)" << endl;
+
+  bool written =
+      writeCsv(stats, prefix + "placement.csv",
+               &GameStats::writePlacementCsv) &&
+      writeCsv(stats, prefix + "sinks.csv", &GameStats::writeSinkCsv) &&
+      writeCsv(stats, prefix + "hitrate.csv", &GameStats::writeHitRateCsv);
+  return written ? 0 : 1;
+}